@@ -66,17 +66,6 @@ float3 MHCDemosaic(Texture2D tex, int2 pos, int2 texSize, int channel)
     float w2 = p[2][0];
     float e2 = p[2][4];
 
-    // Extended diagonal (for some kernels)
-    float nw2_h = p[1][0];  // 2 west of north
-    float ne2_h = p[1][4];  // 2 east of north
-    float sw2_h = p[3][0];  // 2 west of south
-    float se2_h = p[3][4];  // 2 east of south
-
-    float nw2_v = p[0][1];  // 2 north of west
-    float ne2_v = p[0][3];  // 2 north of east
-    float sw2_v = p[4][1];  // 2 south of west
-    float se2_v = p[4][3];  // 2 south of east
-
     if (evenRow && evenCol)
     {
         // Position is R (native red)
@@ -98,10 +87,10 @@ float3 MHCDemosaic(Texture2D tex, int2 pos, int2 texSize, int channel)
         G = c;
 
         // R at G (on R row): horizontal neighbors with vertical gradient correction
-        R = (5.0 * c + 4.0 * (w + e) - (n + s + w2 + e2 + nw2_h + ne2_h + sw2_h + se2_h) * 0.5) / 8.0;
+        R = (5.0 * c + 4.0 * (w + e) - (w2 + e2) - (nw + ne + sw + se) + 0.5 * (n2 + s2)) / 8.0;
 
         // B at G (on R row): vertical neighbors with horizontal gradient correction
-        B = (5.0 * c + 4.0 * (n + s) - (w + e + n2 + s2 + nw2_v + ne2_v + sw2_v + se2_v) * 0.5) / 8.0;
+        B = (5.0 * c + 4.0 * (n + s) - (n2 + s2) - (nw + ne + sw + se) + 0.5 * (w2 + e2)) / 8.0;
     }
     else if (!evenRow && evenCol)
     {
@@ -110,10 +99,10 @@ float3 MHCDemosaic(Texture2D tex, int2 pos, int2 texSize, int channel)
         G = c;
 
         // R at G (on B row): vertical neighbors with horizontal gradient correction
-        R = (5.0 * c + 4.0 * (n + s) - (w + e + n2 + s2 + nw2_v + ne2_v + sw2_v + se2_v) * 0.5) / 8.0;
+        R = (5.0 * c + 4.0 * (n + s) - (n2 + s2) - (nw + ne + sw + se) + 0.5 * (w2 + e2)) / 8.0;
 
         // B at G (on B row): horizontal neighbors with vertical gradient correction
-        B = (5.0 * c + 4.0 * (w + e) - (n + s + w2 + e2 + nw2_h + ne2_h + sw2_h + se2_h) * 0.5) / 8.0;
+        B = (5.0 * c + 4.0 * (w + e) - (w2 + e2) - (nw + ne + sw + se) + 0.5 * (n2 + s2)) / 8.0;
     }
     else
     {
@@ -1,5 +1,6 @@
 // Copyright Minra. All Rights Reserved.
 
+using System.IO;
 using UnrealBuildTool;
 
 public class MinraMosaique : ModuleRules
@@ -35,15 +36,45 @@ public class MinraMosaique : ModuleRules
             new string[]
             {
                 "Slate",
-                "SlateCore"
+                "SlateCore",
+                "Projects"
             }
         );
 
+        if (Target.bBuildEditor)
+        {
+            // Cook-time bake, cook report and bake cache
+            PrivateDependencyModuleNames.AddRange(new string[] { "TargetPlatform", "DerivedDataCache", "AssetRegistry" });
+        }
+
         DynamicallyLoadedModuleNames.AddRange(
             new string[]
             {
                 // ... add any modules that your module loads dynamically here ...
             }
         );
+
+        // Optional libwebp for MSQ3 channel encoding/decoding.
+        // Expected layout: Source/ThirdParty/libwebp/include/webp/*.h and lib/<Platform>/
+        string LibWebPPath = Path.Combine(PluginDirectory, "Source", "ThirdParty", "libwebp");
+        string LibWebPLibPath = Path.Combine(LibWebPPath, "lib", Target.Platform.ToString());
+        bool bWithWebP = Directory.Exists(Path.Combine(LibWebPPath, "include")) && Directory.Exists(LibWebPLibPath);
+
+        if (bWithWebP)
+        {
+            PublicSystemIncludePaths.Add(Path.Combine(LibWebPPath, "include"));
+
+            string LibExtension = Target.Platform == UnrealTargetPlatform.Win64 ? ".lib" : ".a";
+            foreach (string LibName in new string[] { "libwebp", "libsharpyuv" })
+            {
+                string LibFile = Path.Combine(LibWebPLibPath, LibName + LibExtension);
+                if (File.Exists(LibFile))
+                {
+                    PublicAdditionalLibraries.Add(LibFile);
+                }
+            }
+        }
+
+        PublicDefinitions.Add("WITH_MINRA_WEBP=" + (bWithWebP ? "1" : "0"));
     }
 }
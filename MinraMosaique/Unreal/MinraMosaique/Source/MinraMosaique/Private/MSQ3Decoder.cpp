@@ -1,153 +1,294 @@
 // Copyright Minra. All Rights Reserved.
 
 #include "MSQ3Asset.h"
+#include "MSQ3Decoder.h"
+#include "MinraMSQ3DecodeCache.h"
+#include "MinraCookReport.h"
+#include "MinraCookBake.h"
+#include "MinraDemosaicCPU.h"
+#include "MinraSIMD.h"
+#include "MinraWebP.h"
+#include "Async/ParallelFor.h"
+#include "Misc/FileHelper.h"
+#include "Engine/Texture2DArray.h"
+#include "UObject/ObjectSaveContext.h"
+#include "EditorFramework/AssetImportData.h"
 
-// MSQ3 Format Constants
 namespace MSQ3
 {
-    const char MAGIC[5] = "MSQ3";
-    const uint8 CURRENT_VERSION = 1;
-    const int32 HEADER_SIZE = 14;
-    const int32 MAX_DIMENSION = 16384;
+    static uint32 ReadUInt32LE(const uint8* Data)
+    {
+        return Data[0] | (Data[1] << 8) | (Data[2] << 16) | (Data[3] << 24);
+    }
 }
 
-/**
- * MSQ3 Decoder implementation
- * Decodes MSQ3 binary format files containing 3 Bayer CFA patterns.
- */
-class FMinraMSQ3Decoder
+// FMinraMSQ3Decoder implementation
+
+bool FMinraMSQ3Decoder::IsMSQ3Data(const TArray<uint8>& Data)
 {
-public:
-    struct FMQ3Data
+    if (Data.Num() < MSQ3::HEADER_SIZE)
     {
-        int32 Width = 0;
-        int32 Height = 0;
-        uint8 Quality = 0;
-        TArray<uint8> ChannelR;
-        TArray<uint8> ChannelG;
-        TArray<uint8> ChannelB;
+        return false;
+    }
 
-        bool IsValid() const
-        {
-            return Width > 0 && Height > 0 &&
-                   ChannelR.Num() > 0 &&
-                   ChannelG.Num() > 0 &&
-                   ChannelB.Num() > 0;
-        }
-    };
+    return Data[0] == 'M' && Data[1] == 'S' && Data[2] == 'Q' && Data[3] == '3';
+}
 
-    /**
-     * Validates if data contains valid MSQ3 magic bytes.
-     */
-    static bool IsMSQ3Data(const TArray<uint8>& Data)
+TSharedPtr<FMinraMSQ3Decoder::FMQ3Data> FMinraMSQ3Decoder::Decode(const TArray<uint8>& Data)
+{
+    if (!IsMSQ3Data(Data))
     {
-        if (Data.Num() < MSQ3::HEADER_SIZE)
-        {
-            return false;
-        }
+        UE_LOG(LogTemp, Warning, TEXT("Minra Mosaique: Invalid MSQ3 file - magic bytes not found."));
+        return nullptr;
+    }
+
+    TSharedPtr<FMQ3Data> Result = MakeShared<FMQ3Data>();
+
+    int32 Offset = 4; // Skip magic bytes
 
-        return Data[0] == 'M' && Data[1] == 'S' && Data[2] == 'Q' && Data[3] == '3';
+    // Read version; the top bit only says whether channel qualities follow the header
+    const bool bChannelQuality = (Data[Offset] & MSQ3::CHANNEL_QUALITY_FLAG) != 0;
+    uint8 Version = static_cast<uint8>(Data[Offset++] & ~MSQ3::CHANNEL_QUALITY_FLAG);
+    if (!IsSupportedVersion(Version))
+    {
+        UE_LOG(LogTemp, Warning, TEXT("Minra Mosaique: Unsupported MSQ3 version %d. Expected %d or %d."), Version, MSQ3::VERSION_INTERLEAVED, MSQ3::VERSION_PLANE_PACKED);
+        return nullptr;
     }
 
-    /**
-     * Decodes MSQ3 data from raw bytes.
-     */
-    static TSharedPtr<FMQ3Data> Decode(const TArray<uint8>& Data)
+    Result->Version = Version;
+
+    // Read dimensions (little-endian)
+    auto ReadUInt32 = [&Data, &Offset]() -> uint32
     {
-        if (!IsMSQ3Data(Data))
-        {
-            UE_LOG(LogTemp, Warning, TEXT("Minra Mosaique: Invalid MSQ3 file - magic bytes not found."));
-            return nullptr;
-        }
+        uint32 Value = Data[Offset] |
+                      (Data[Offset + 1] << 8) |
+                      (Data[Offset + 2] << 16) |
+                      (Data[Offset + 3] << 24);
+        Offset += 4;
+        return Value;
+    };
 
-        TSharedPtr<FMQ3Data> Result = MakeShared<FMQ3Data>();
+    Result->Width = static_cast<int32>(ReadUInt32());
+    Result->Height = static_cast<int32>(ReadUInt32());
+    Result->Quality = Data[Offset++];
 
-        int32 Offset = 4; // Skip magic bytes
+    for (int32 Channel = 0; Channel < 3; ++Channel)
+    {
+        Result->ChannelQuality[Channel] = Result->Quality;
+    }
 
-        // Read version
-        uint8 Version = Data[Offset++];
-        if (Version != MSQ3::CURRENT_VERSION)
+    if (bChannelQuality)
+    {
+        if (Offset + 3 > Data.Num())
         {
-            UE_LOG(LogTemp, Warning, TEXT("Minra Mosaique: Unsupported MSQ3 version %d. Expected %d."), Version, MSQ3::CURRENT_VERSION);
+            UE_LOG(LogTemp, Warning, TEXT("Minra Mosaique: MSQ3 file too small for its channel qualities."));
             return nullptr;
         }
 
-        // Read dimensions (little-endian)
-        auto ReadUInt32 = [&Data, &Offset]() -> uint32
+        for (int32 Channel = 0; Channel < 3; ++Channel)
         {
-            uint32 Value = Data[Offset] |
-                          (Data[Offset + 1] << 8) |
-                          (Data[Offset + 2] << 16) |
-                          (Data[Offset + 3] << 24);
-            Offset += 4;
-            return Value;
-        };
+            Result->ChannelQuality[Channel] = Data[Offset++];
+        }
+    }
+
+    // Validate dimensions
+    if (Result->Width <= 0 || Result->Height <= 0 ||
+        Result->Width > MSQ3::MAX_DIMENSION || Result->Height > MSQ3::MAX_DIMENSION)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("Minra Mosaique: Invalid MSQ3 dimensions: %dx%d"), Result->Width, Result->Height);
+        return nullptr;
+    }
 
-        Result->Width = static_cast<int32>(ReadUInt32());
-        Result->Height = static_cast<int32>(ReadUInt32());
-        Result->Quality = Data[Offset++];
+    // Read channel data
+    auto ReadChannel = [&Data, &Offset, &ReadUInt32]() -> TArray<uint8>
+    {
+        TArray<uint8> ChannelData;
 
-        // Validate dimensions
-        if (Result->Width <= 0 || Result->Height <= 0 ||
-            Result->Width > MSQ3::MAX_DIMENSION || Result->Height > MSQ3::MAX_DIMENSION)
+        if (Offset + 4 > Data.Num())
         {
-            UE_LOG(LogTemp, Warning, TEXT("Minra Mosaique: Invalid MSQ3 dimensions: %dx%d"), Result->Width, Result->Height);
-            return nullptr;
+            return ChannelData;
         }
 
-        // Read channel data
-        auto ReadChannel = [&Data, &Offset, &ReadUInt32]() -> TArray<uint8>
+        uint32 Size = ReadUInt32();
+
+        if (Offset + static_cast<int32>(Size) > Data.Num())
         {
-            TArray<uint8> ChannelData;
+            return ChannelData;
+        }
 
-            if (Offset + 4 > Data.Num())
+        ChannelData.SetNum(Size);
+        FMemory::Memcpy(ChannelData.GetData(), &Data[Offset], Size);
+        Offset += Size;
+
+        return ChannelData;
+    };
+
+    // v2 channels are four consecutive records; keep them together as one payload
+    auto ReadPackedChannel = [&Data, &Offset]() -> TArray<uint8>
+    {
+        TArray<uint8> ChannelData;
+        int32 End = Offset;
+
+        for (int32 SubPlane = 0; SubPlane < MSQ3::NUM_SUBPLANES; ++SubPlane)
+        {
+            if (End + 4 > Data.Num())
             {
                 return ChannelData;
             }
 
-            uint32 Size = ReadUInt32();
-
-            if (Offset + static_cast<int32>(Size) > Data.Num())
+            const int64 RecordEnd = static_cast<int64>(End) + 4 + MSQ3::ReadUInt32LE(&Data[End]);
+            if (RecordEnd > Data.Num())
             {
                 return ChannelData;
             }
 
-            ChannelData.SetNum(Size);
-            FMemory::Memcpy(ChannelData.GetData(), &Data[Offset], Size);
-            Offset += Size;
+            End = static_cast<int32>(RecordEnd);
+        }
 
-            return ChannelData;
-        };
+        ChannelData.Append(&Data[Offset], End - Offset);
+        Offset = End;
+
+        return ChannelData;
+    };
 
+    if (Version == MSQ3::VERSION_PLANE_PACKED)
+    {
+        Result->ChannelR = ReadPackedChannel();
+        Result->ChannelG = ReadPackedChannel();
+        Result->ChannelB = ReadPackedChannel();
+    }
+    else
+    {
         Result->ChannelR = ReadChannel();
         Result->ChannelG = ReadChannel();
         Result->ChannelB = ReadChannel();
+    }
 
-        if (!Result->IsValid())
+    if (!Result->IsValid())
+    {
+        UE_LOG(LogTemp, Warning, TEXT("Minra Mosaique: Failed to read MSQ3 channel data."));
+        return nullptr;
+    }
+
+    return Result;
+}
+
+TSharedPtr<FMinraMSQ3Decoder::FMQ3Data> FMinraMSQ3Decoder::DecodeFromFile(const FString& FilePath)
+{
+    TArray<uint8> FileData;
+
+    if (!FFileHelper::LoadFileToArray(FileData, *FilePath))
+    {
+        UE_LOG(LogTemp, Warning, TEXT("Minra Mosaique: Failed to read MSQ3 file: %s"), *FilePath);
+        return nullptr;
+    }
+
+    return Decode(FileData);
+}
+
+bool FMinraMSQ3Decoder::DecodeChannel(
+    const TArray<uint8>& Payload,
+    uint8 Version,
+    int32 Width,
+    int32 Height,
+    TArray<uint8>& OutCFA)
+{
+    if (Version == MSQ3::VERSION_INTERLEAVED)
+    {
+        return FMinraWebP::DecodeGrayscale(Payload.GetData(), Payload.Num(), Width, Height, OutCFA);
+    }
+
+    if (Version != MSQ3::VERSION_PLANE_PACKED)
+    {
+        return false;
+    }
+
+    // Locate the four sub-plane records
+    const uint8* Blobs[MSQ3::NUM_SUBPLANES];
+    int32 BlobSizes[MSQ3::NUM_SUBPLANES];
+    int32 Offset = 0;
+
+    for (int32 SubPlane = 0; SubPlane < MSQ3::NUM_SUBPLANES; ++SubPlane)
+    {
+        if (Offset + 4 > Payload.Num())
         {
-            UE_LOG(LogTemp, Warning, TEXT("Minra Mosaique: Failed to read MSQ3 channel data."));
-            return nullptr;
+            return false;
         }
 
-        return Result;
+        BlobSizes[SubPlane] = static_cast<int32>(MSQ3::ReadUInt32LE(&Payload[Offset]));
+        Offset += 4;
+
+        if (BlobSizes[SubPlane] <= 0 || Offset + BlobSizes[SubPlane] > Payload.Num())
+        {
+            return false;
+        }
+
+        Blobs[SubPlane] = &Payload[Offset];
+        Offset += BlobSizes[SubPlane];
     }
 
-    /**
-     * Decodes MSQ3 file from disk.
-     */
-    static TSharedPtr<FMQ3Data> DecodeFromFile(const FString& FilePath)
+    const int32 HalfWidth = (Width + 1) / 2;
+    const int32 HalfHeight = (Height + 1) / 2;
+
+    TArray<uint8> SubPlanes[MSQ3::NUM_SUBPLANES];
+    bool bSucceeded[MSQ3::NUM_SUBPLANES] = { false, false, false, false };
+
+    ParallelFor(MSQ3::NUM_SUBPLANES, [&](int32 SubPlane)
     {
-        TArray<uint8> FileData;
+        bSucceeded[SubPlane] = FMinraWebP::DecodeGrayscale(Blobs[SubPlane], BlobSizes[SubPlane], HalfWidth, HalfHeight, SubPlanes[SubPlane]);
+    });
 
-        if (!FFileHelper::LoadFileToArray(FileData, *FilePath))
+    for (int32 SubPlane = 0; SubPlane < MSQ3::NUM_SUBPLANES; ++SubPlane)
+    {
+        if (!bSucceeded[SubPlane])
         {
-            UE_LOG(LogTemp, Warning, TEXT("Minra Mosaique: Failed to read MSQ3 file: %s"), *FilePath);
-            return nullptr;
+            return false;
         }
+    }
+
+    // Re-interleave: even rows are R/G1, odd rows are G2/B
+    OutCFA.SetNumUninitialized(Width * Height);
 
-        return Decode(FileData);
+    for (int32 Y = 0; Y < Height; ++Y)
+    {
+        const int32 SubRow = (Y >> 1) * HalfWidth;
+        const TArray<uint8>& Even = SubPlanes[(Y & 1) == 0 ? 0 : 2];
+        const TArray<uint8>& Odd = SubPlanes[(Y & 1) == 0 ? 1 : 3];
+
+        MinraSIMD::InterleaveBytes(&Even[SubRow], &Odd[SubRow], &OutCFA[Y * Width], Width);
     }
-};
+
+    return true;
+}
+
+bool FMinraMSQ3Decoder::DecodeCombinedPixels(const FMQ3Data& Data, TArray<FColor>& OutPixels)
+{
+    if (!Data.IsValid())
+    {
+        return false;
+    }
+
+    const TArray<uint8>* Payloads[3] = { &Data.ChannelR, &Data.ChannelG, &Data.ChannelB };
+    TArray<uint8> CFAs[3];
+    bool bSucceeded[3] = { false, false, false };
+
+    ParallelFor(3, [&](int32 Channel)
+    {
+        bSucceeded[Channel] = DecodeChannel(*Payloads[Channel], Data.Version, Data.Width, Data.Height, CFAs[Channel]);
+    });
+
+    if (!bSucceeded[0] || !bSucceeded[1] || !bSucceeded[2])
+    {
+        UE_LOG(LogTemp, Warning, TEXT("Minra Mosaique: Failed to decompress MSQ3 channel data."));
+        return false;
+    }
+
+    const int32 NumPixels = Data.Width * Data.Height;
+    OutPixels.SetNumUninitialized(NumPixels);
+    MinraSIMD::PackBGRA(CFAs[0].GetData(), CFAs[1].GetData(), CFAs[2].GetData(), OutPixels.GetData(), NumPixels);
+
+    return true;
+}
 
 // UMSQ3Asset implementation
 
@@ -155,17 +296,54 @@ UMSQ3Asset::UMSQ3Asset()
     : Width(0)
     , Height(0)
     , Quality(0)
+    , ChannelQuality{ 0, 0, 0 }
     , CombinedTexture(nullptr)
     , Algorithm(EMinraDemosaicAlgorithm::Bilinear)
     , BakedImage1(nullptr)
     , BakedImage2(nullptr)
     , BakedImage3(nullptr)
+    , BakedImageArray(nullptr)
 {
+#if WITH_EDITORONLY_DATA
+    AssetImportData = nullptr;
+    CookedImages[0] = CookedImages[1] = CookedImages[2] = nullptr;
+    CookedImageArray = nullptr;
+#endif
+}
+
+void UMSQ3Asset::PostInitProperties()
+{
+#if WITH_EDITORONLY_DATA
+    if (!HasAnyFlags(RF_ClassDefaultObject))
+    {
+        AssetImportData = NewObject<UAssetImportData>(this, TEXT("AssetImportData"));
+    }
+
+    // New assets bake on cook; loaded ones keep their saved value, or the class default (off)
+    if (!HasAnyFlags(RF_ClassDefaultObject | RF_NeedLoad | RF_WasLoaded))
+    {
+        bBakeOnCook = true;
+    }
+#endif
+
+    Super::PostInitProperties();
+}
+
+#if WITH_EDITORONLY_DATA
+void UMSQ3Asset::GetAssetRegistryTags(TArray<FAssetRegistryTag>& OutTags) const
+{
+    if (AssetImportData)
+    {
+        OutTags.Add(FAssetRegistryTag(SourceFileTagName(), AssetImportData->GetSourceData().ToJson(), FAssetRegistryTag::TT_Hidden));
+    }
+
+    Super::GetAssetRegistryTags(OutTags);
 }
+#endif
 
 bool UMSQ3Asset::IsValid() const
 {
-    return CombinedTexture != nullptr && Width > 0 && Height > 0;
+    return (CombinedTexture != nullptr || CompressedData.Num() > 0 || HasBakedTextures() || HasBakedTextureArray()) && Width > 0 && Height > 0;
 }
 
 bool UMSQ3Asset::HasBakedTextures() const
@@ -173,17 +351,257 @@ bool UMSQ3Asset::HasBakedTextures() const
     return BakedImage1 != nullptr && BakedImage2 != nullptr && BakedImage3 != nullptr;
 }
 
+bool UMSQ3Asset::HasBakedTextureArray() const
+{
+    return BakedImageArray != nullptr;
+}
+
+UTexture2DArray* UMSQ3Asset::GetImageArray() const
+{
+    return BakedImageArray;
+}
+
+UTexture2D* UMSQ3Asset::GetCombinedTexture() const
+{
+    if (CompressedData.Num() > 0 && FMinraWebP::IsAvailable())
+    {
+        return FMinraMSQ3DecodeCache::Get().FindOrDecode(this);
+    }
+
+    return CombinedTexture;
+}
+
+bool UMSQ3Asset::IsCombinedTextureReady() const
+{
+    if (CompressedData.Num() > 0 && FMinraWebP::IsAvailable())
+    {
+        return FMinraMSQ3DecodeCache::Get().IsDecoded(this);
+    }
+
+    return CombinedTexture != nullptr;
+}
+
+void UMSQ3Asset::ReleaseDecodedData() const
+{
+    FMinraMSQ3DecodeCache::Get().Release(this);
+}
+
+bool UMSQ3Asset::DecodeCombinedPixels(TArray<FColor>& OutPixels) const
+{
+    if (CompressedData.Num() == 0)
+    {
+        return false;
+    }
+
+    TSharedPtr<FMinraMSQ3Decoder::FMQ3Data> Decoded = FMinraMSQ3Decoder::Decode(CompressedData);
+    return Decoded.IsValid() && FMinraMSQ3Decoder::DecodeCombinedPixels(*Decoded, OutPixels);
+}
+
 UTexture2D* UMSQ3Asset::GetImage1() const
 {
-    return BakedImage1 != nullptr ? BakedImage1 : CombinedTexture;
+    return BakedImage1 != nullptr ? BakedImage1 : GetUnbakedImage();
 }
 
 UTexture2D* UMSQ3Asset::GetImage2() const
 {
-    return BakedImage2 != nullptr ? BakedImage2 : CombinedTexture;
+    return BakedImage2 != nullptr ? BakedImage2 : GetUnbakedImage();
 }
 
 UTexture2D* UMSQ3Asset::GetImage3() const
 {
-    return BakedImage3 != nullptr ? BakedImage3 : CombinedTexture;
+    return BakedImage3 != nullptr ? BakedImage3 : GetUnbakedImage();
+}
+
+UTexture2D* UMSQ3Asset::GetUnbakedImage() const
+{
+    // A slice cannot be returned as a UTexture2D, and cooked array assets have no combined texture
+    ensureMsgf(BakedImageArray == nullptr, TEXT("Minra Mosaique: %s is baked to a texture array; use GetImageArray."), *GetName());
+    return GetCombinedTexture();
+}
+
+#if WITH_EDITOR
+bool UMSQ3Asset::HasCookedImages() const
+{
+    return CookedImages[0] != nullptr && CookedImages[1] != nullptr && CookedImages[2] != nullptr;
+}
+
+bool UMSQ3Asset::CanStripCombinedForCook() const
+{
+    // The runtime reads only the baked textures once all three (or the array) exist
+    return HasBakedTextures() || HasBakedTextureArray() || HasCookedImages() || CookedImageArray != nullptr;
+}
+
+void UMSQ3Asset::Serialize(FArchive& Ar)
+{
+    if (Ar.IsSaving() && Ar.IsCooking() && CanStripCombinedForCook())
+    {
+        TGuardValue<UTexture2D*> StripCombinedTexture(CombinedTexture, nullptr);
+        TArray<uint8> KeptData = MoveTemp(CompressedData);
+
+        if (HasCookedImages())
+        {
+            TGuardValue<UTexture2D*> CookedImage1(BakedImage1, CookedImages[0]);
+            TGuardValue<UTexture2D*> CookedImage2(BakedImage2, CookedImages[1]);
+            TGuardValue<UTexture2D*> CookedImage3(BakedImage3, CookedImages[2]);
+            Super::Serialize(Ar);
+        }
+        else if (CookedImageArray)
+        {
+            TGuardValue<UTexture2DArray*> CookedArray(BakedImageArray, CookedImageArray);
+            Super::Serialize(Ar);
+        }
+        else
+        {
+            Super::Serialize(Ar);
+        }
+
+        CompressedData = MoveTemp(KeptData);
+        return;
+    }
+
+    Super::Serialize(Ar);
+}
+
+void UMSQ3Asset::PreSaveRoot(FObjectPreSaveRootContext ObjectSaveContext)
+{
+    Super::PreSaveRoot(ObjectSaveContext);
+
+    if (!ObjectSaveContext.IsCooking() || !CanStripCombinedForCook())
+    {
+        return;
+    }
+
+    // Cook-time outputs are saved only into cooked packages
+    if (HasCookedImages())
+    {
+        for (UTexture2D* Image : CookedImages)
+        {
+            Image->ClearFlags(RF_Transient);
+        }
+        ObjectSaveContext.SetCleanupRequired(true);
+    }
+    else if (CookedImageArray)
+    {
+        CookedImageArray->ClearFlags(RF_Transient);
+        ObjectSaveContext.SetCleanupRequired(true);
+    }
+
+    int64 BytesSaved = CompressedData.Num();
+    FString Stripped = CompressedData.Num() > 0 ? TEXT("CompressedData") : FString();
+
+    // Assets imported before CompressedData existed own their combined texture; keep it out of the package
+    if (CombinedTexture && CombinedTexture->GetOuter() == this && !CombinedTexture->HasAnyFlags(RF_Transient))
+    {
+        CombinedTexture->SetFlags(RF_Transient);
+        bCombinedTextureStripped = true;
+        ObjectSaveContext.SetCleanupRequired(true);
+
+        // CFA textures are uncompressed BGRA8 without mips
+        BytesSaved += static_cast<int64>(Width) * Height * sizeof(FColor);
+        Stripped = TEXT("CombinedTexture");
+    }
+
+    if (BytesSaved > 0)
+    {
+        FMinraCookReport::AddStripped(ObjectSaveContext.GetTargetPlatform(), this, Stripped, BytesSaved);
+    }
+}
+
+void UMSQ3Asset::PostSaveRoot(FObjectPostSaveRootContext ObjectSaveContext)
+{
+    Super::PostSaveRoot(ObjectSaveContext);
+
+    for (UTexture2D* Image : CookedImages)
+    {
+        if (Image)
+        {
+            Image->SetFlags(RF_Transient);
+        }
+    }
+
+    if (CookedImageArray)
+    {
+        CookedImageArray->SetFlags(RF_Transient);
+    }
+
+    if (bCombinedTextureStripped)
+    {
+        if (CombinedTexture)
+        {
+            CombinedTexture->ClearFlags(RF_Transient);
+        }
+        bCombinedTextureStripped = false;
+    }
+}
+
+void UMSQ3Asset::BeginCacheForCookedPlatformData(const ITargetPlatform* TargetPlatform)
+{
+    Super::BeginCacheForCookedPlatformData(TargetPlatform);
+
+    // Assets baked to an array ship an array
+    const bool bTextureArray = BakedImageArray != nullptr;
+    if (!bBakeOnCook || (CookBake.IsValid() && CookBake->Matches(Algorithm, EMinraCFAPattern::RGGB, CookCompression, bTextureArray)))
+    {
+        return;
+    }
+
+    FMinraCookBake::FReadCombined ReadCombined;
+    if (CompressedData.Num() > 0)
+    {
+        ReadCombined = [Data = CompressedData](TArray<FColor>& OutPixels, int32& OutWidth, int32& OutHeight)
+        {
+            TSharedPtr<FMinraMSQ3Decoder::FMQ3Data> Decoded = FMinraMSQ3Decoder::Decode(Data);
+            if (!Decoded.IsValid() || !FMinraMSQ3Decoder::DecodeCombinedPixels(*Decoded, OutPixels))
+            {
+                return false;
+            }
+            OutWidth = Decoded->Width;
+            OutHeight = Decoded->Height;
+            return true;
+        };
+    }
+    else
+    {
+        // Older imports: read the saved combined texture here, texture data is not for worker threads
+        TArray<FColor> Pixels;
+        int32 PixelsWidth = 0;
+        int32 PixelsHeight = 0;
+        if (!FMinraDemosaicCPU::ReadTexturePixels(CombinedTexture, Pixels, PixelsWidth, PixelsHeight))
+        {
+            UE_LOG(LogTemp, Warning, TEXT("Minra Mosaique: %s has no combined data to bake while cooking."), *GetName());
+            return;
+        }
+
+        ReadCombined = [Pixels = MoveTemp(Pixels), PixelsWidth, PixelsHeight](TArray<FColor>& OutPixels, int32& OutWidth, int32& OutHeight) mutable
+        {
+            OutPixels = MoveTemp(Pixels);
+            OutWidth = PixelsWidth;
+            OutHeight = PixelsHeight;
+            return true;
+        };
+    }
+
+    CookedImages[0] = CookedImages[1] = CookedImages[2] = nullptr;
+    CookedImageArray = nullptr;
+    CookBake = MakeShared<FMinraCookBake>(MoveTemp(ReadCombined), Algorithm, EMinraCFAPattern::RGGB, CookCompression.GetValue(), bTextureArray, GetName());
+}
+
+bool UMSQ3Asset::IsCachedCookedPlatformDataLoaded(const ITargetPlatform* TargetPlatform)
+{
+    if (CookBake.IsValid() && !CookBake->Poll(this, TargetPlatform, CookedImages, CookedImageArray))
+    {
+        return false;
+    }
+
+    return Super::IsCachedCookedPlatformDataLoaded(TargetPlatform);
+}
+
+void UMSQ3Asset::ClearAllCachedCookedPlatformData()
+{
+    Super::ClearAllCachedCookedPlatformData();
+
+    CookBake.Reset();
+    CookedImages[0] = CookedImages[1] = CookedImages[2] = nullptr;
+    CookedImageArray = nullptr;
 }
+#endif
@@ -0,0 +1,142 @@
+// Copyright Minra. All Rights Reserved.
+
+#include "MinraBakeDDC.h"
+
+#if WITH_EDITOR
+
+#include "DerivedDataCacheInterface.h"
+#include "Algo/AllOf.h"
+#include "Misc/SecureHash.h"
+#include "HAL/IConsoleManager.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include <atomic>
+
+// Change when the demosaic kernels or the payload layout change, to invalidate every cached bake
+#define MINRA_BAKE_DDC_VERSION TEXT("6B0E3C1A8F5D4E29B7A41C02D9E35F71")
+
+namespace MinraBakeDDC
+{
+    static std::atomic<int32> Hits{ 0 };
+    static std::atomic<int32> Misses{ 0 };
+
+    static void SerializeMips(FArchive& Ar, FIntPoint& Size, FMinraBakeDDC::FMipChains& Mips)
+    {
+        Ar << Size.X;
+        Ar << Size.Y;
+
+        for (TArray<TArray<FColor>>& Chain : Mips)
+        {
+            int32 NumMips = Chain.Num();
+            Ar << NumMips;
+
+            if (Ar.IsLoading())
+            {
+                if (NumMips < 0 || NumMips > 32)
+                {
+                    Ar.SetError();
+                    return;
+                }
+                Chain.SetNum(NumMips);
+            }
+
+            for (TArray<FColor>& Mip : Chain)
+            {
+                Mip.BulkSerialize(Ar);
+            }
+        }
+    }
+
+    static FAutoConsoleCommand StatsCommand(
+        TEXT("MinraMosaique.BakeCacheStats"),
+        TEXT("Logs the derived-data cache hits and misses of Minra Mosaique bakes."),
+        FConsoleCommandDelegate::CreateLambda([]()
+        {
+            UE_LOG(LogTemp, Display, TEXT("Minra Mosaique: Bake cache %d hits, %d misses."), Hits.load(), Misses.load());
+        }));
+}
+
+FString FMinraBakeDDC::BuildKey(
+    const TArray<FColor>& Combined,
+    int32 Width,
+    int32 Height,
+    EMinraDemosaicAlgorithm Algorithm,
+    EMinraCFAPattern Pattern,
+    const TCHAR* OutputFormat)
+{
+    return BuildKey(HashPixels(Combined), Width, Height, Algorithm, Pattern, OutputFormat);
+}
+
+FString FMinraBakeDDC::BuildKey(
+    const FSHAHash& PixelHash,
+    int32 Width,
+    int32 Height,
+    EMinraDemosaicAlgorithm Algorithm,
+    EMinraCFAPattern Pattern,
+    const TCHAR* OutputFormat)
+{
+    const FString Suffix = FString::Printf(TEXT("%s_%dx%d_A%d_P%d_%s"),
+        *PixelHash.ToString(), Width, Height, static_cast<int32>(Algorithm), static_cast<int32>(Pattern), OutputFormat);
+
+    return FDerivedDataCacheInterface::BuildCacheKey(TEXT("MINRABAKE"), MINRA_BAKE_DDC_VERSION, *Suffix);
+}
+
+FSHAHash FMinraBakeDDC::HashPixels(const TArray<FColor>& Combined)
+{
+    FSHA1 Hash;
+    Hash.Update(reinterpret_cast<const uint8*>(Combined.GetData()), Combined.Num() * sizeof(FColor));
+    return Hash.Finalize();
+}
+
+const TCHAR* FMinraBakeDDC::GetVersion()
+{
+    return MINRA_BAKE_DDC_VERSION;
+}
+
+bool FMinraBakeDDC::Get(const FString& Key, FIntPoint& OutSize, FMipChains& OutMips)
+{
+    TArray<uint8> Data;
+    if (GetDerivedDataCacheRef().GetSynchronous(*Key, Data, TEXT("MinraBake")))
+    {
+        FMemoryReader Ar(Data);
+        MinraBakeDDC::SerializeMips(Ar, OutSize, OutMips);
+
+        const bool bValid = !Ar.IsError() && OutSize.X > 0 && OutSize.Y > 0 &&
+            Algo::AllOf(OutMips, [&OutSize](const TArray<TArray<FColor>>& Chain)
+            {
+                return Chain.Num() > 0 && Chain[0].Num() == OutSize.X * OutSize.Y;
+            });
+
+        if (bValid)
+        {
+            ++MinraBakeDDC::Hits;
+            return true;
+        }
+
+        UE_LOG(LogTemp, Warning, TEXT("Minra Mosaique: Discarding corrupt cached bake %s."), *Key);
+        for (TArray<TArray<FColor>>& Chain : OutMips)
+        {
+            Chain.Reset();
+        }
+    }
+
+    ++MinraBakeDDC::Misses;
+    return false;
+}
+
+void FMinraBakeDDC::Put(const FString& Key, FIntPoint Size, const FMipChains& Mips)
+{
+    TArray<uint8> Data;
+    FMemoryWriter Ar(Data);
+    MinraBakeDDC::SerializeMips(Ar, Size, const_cast<FMipChains&>(Mips));
+
+    GetDerivedDataCacheRef().Put(*Key, Data, TEXT("MinraBake"));
+}
+
+void FMinraBakeDDC::GetStats(int32& OutHits, int32& OutMisses)
+{
+    OutHits = MinraBakeDDC::Hits;
+    OutMisses = MinraBakeDDC::Misses;
+}
+
+#endif
@@ -0,0 +1,204 @@
+// Copyright Minra. All Rights Reserved.
+
+#include "MinraCookBake.h"
+
+#if WITH_EDITOR
+
+#include "MinraDemosaicCPU.h"
+#include "MinraBakeDDC.h"
+#include "Engine/Texture2D.h"
+#include "Engine/Texture2DArray.h"
+#include "Async/Async.h"
+#include "Misc/SecureHash.h"
+#include "UObject/Package.h"
+
+FMinraCookBake::FMinraCookBake(
+    FReadCombined ReadCombined,
+    EMinraDemosaicAlgorithm InAlgorithm,
+    EMinraCFAPattern InPattern,
+    TextureCompressionSettings InCompression,
+    bool bInTextureArray,
+    const FString& InDebugName)
+    : Algorithm(InAlgorithm)
+    , Pattern(InPattern)
+    , Compression(InCompression)
+    , bTextureArray(bInTextureArray)
+    , DebugName(InDebugName)
+    , Result(MakeShared<FResult, ESPMode::ThreadSafe>())
+{
+    Task = Async(EAsyncExecution::ThreadPool, [Read = MoveTemp(ReadCombined), Result = Result, InAlgorithm, InPattern, InDebugName]()
+    {
+        TArray<FColor> Combined;
+        int32 Width = 0;
+        int32 Height = 0;
+        if (!Read(Combined, Width, Height) || Width <= 0 || Height <= 0)
+        {
+            UE_LOG(LogTemp, Error, TEXT("Minra Mosaique: Cook bake of %s has no readable combined data."), *InDebugName);
+            return;
+        }
+
+        // Platform compression happens later on the textures, so the cached result is mip 0 only
+        const FSHAHash PixelHash = FMinraBakeDDC::HashPixels(Combined);
+        const FString CacheKey = FMinraBakeDDC::BuildKey(PixelHash, Width, Height, InAlgorithm, InPattern, TEXT("BGRA8"));
+        FMinraBakeDDC::FMipChains Mips;
+        FIntPoint CachedSize;
+        if (FMinraBakeDDC::Get(CacheKey, CachedSize, Mips))
+        {
+            for (int32 Channel = 0; Channel < 3; ++Channel)
+            {
+                Result->Images[Channel] = MoveTemp(Mips[Channel][0]);
+            }
+        }
+        else
+        {
+            if (!FMinraDemosaicCPU::Demosaic(Combined, Width, Height, InAlgorithm, InPattern, Result->Images[0], Result->Images[1], Result->Images[2]))
+            {
+                UE_LOG(LogTemp, Error, TEXT("Minra Mosaique: Cook bake of %s failed to demosaic."), *InDebugName);
+                return;
+            }
+
+            for (int32 Channel = 0; Channel < 3; ++Channel)
+            {
+                Mips[Channel].Add(MoveTemp(Result->Images[Channel]));
+            }
+            FMinraBakeDDC::Put(CacheKey, FMinraDemosaicCPU::GetOutputSize(Width, Height, InAlgorithm), Mips);
+            for (int32 Channel = 0; Channel < 3; ++Channel)
+            {
+                Result->Images[Channel] = MoveTemp(Mips[Channel][0]);
+            }
+        }
+
+        // Source ids from the inputs and kernel version keep texture DDC keys stable across
+        // cooks and change with the kernels; the fourth is the array's
+        const FTCHARToUTF8 Version(FMinraBakeDDC::GetVersion());
+        for (int32 Channel = 0; Channel < 4; ++Channel)
+        {
+            const int32 Size[2] = { Width, Height };
+            const uint8 Settings[3] = { static_cast<uint8>(InAlgorithm), static_cast<uint8>(InPattern), static_cast<uint8>(Channel) };
+
+            FMD5 Hash;
+            Hash.Update(PixelHash.Hash, sizeof(PixelHash.Hash));
+            Hash.Update(reinterpret_cast<const uint8*>(Version.Get()), Version.Length());
+            Hash.Update(reinterpret_cast<const uint8*>(Size), sizeof(Size));
+            Hash.Update(Settings, sizeof(Settings));
+
+            uint32 Digest[4];
+            Hash.Final(reinterpret_cast<uint8*>(Digest));
+            Result->Ids[Channel] = FGuid(Digest[0], Digest[1], Digest[2], Digest[3]);
+        }
+
+        Result->Size = FMinraDemosaicCPU::GetOutputSize(Width, Height, InAlgorithm);
+        Result->bSucceeded = true;
+    });
+}
+
+bool FMinraCookBake::Matches(EMinraDemosaicAlgorithm InAlgorithm, EMinraCFAPattern InPattern, TextureCompressionSettings InCompression, bool bInTextureArray) const
+{
+    return Algorithm == InAlgorithm && Pattern == InPattern && Compression == InCompression && bTextureArray == bInTextureArray;
+}
+
+bool FMinraCookBake::Poll(UObject* Outer, const ITargetPlatform* TargetPlatform, UTexture2D* (&OutImages)[3], UTexture2DArray*& OutImageArray)
+{
+    check(IsInGameThread());
+
+    if (!Task.IsReady())
+    {
+        return false;
+    }
+
+    if (!Result->bSucceeded)
+    {
+        return true;
+    }
+
+    if (!bTexturesCreated)
+    {
+        CreateTextures(Outer, OutImages, OutImageArray);
+        bTexturesCreated = true;
+    }
+
+    const bool bStart = !StartedPlatforms.Contains(TargetPlatform);
+    if (bStart)
+    {
+        StartedPlatforms.Add(TargetPlatform);
+    }
+
+    UTexture* const Outputs[4] = { OutImages[0], OutImages[1], OutImages[2], OutImageArray };
+
+    bool bCached = true;
+    for (UTexture* Image : Outputs)
+    {
+        if (!Image)
+        {
+            continue;
+        }
+
+        if (bStart)
+        {
+            Image->BeginCacheForCookedPlatformData(TargetPlatform);
+        }
+        bCached &= Image->IsCachedCookedPlatformDataLoaded(TargetPlatform);
+    }
+
+    return bCached;
+}
+
+void FMinraCookBake::CreateTextures(UObject* Outer, UTexture2D* (&OutImages)[3], UTexture2DArray*& OutImageArray)
+{
+    // Transient outside the cooked save (see the owners' PreSaveRoot), so editor saves never keep them
+    if (bTextureArray)
+    {
+        const FName Name(TEXT("CookedImageArray"));
+        ReleaseName(Outer, UTexture2DArray::StaticClass(), Name);
+
+        const int64 SliceBytes = static_cast<int64>(Result->Size.X) * Result->Size.Y * sizeof(FColor);
+        TArray64<uint8> SourceData;
+        SourceData.SetNumUninitialized(SliceBytes * 3);
+        for (int32 Slice = 0; Slice < 3; ++Slice)
+        {
+            FMemory::Memcpy(SourceData.GetData() + Slice * SliceBytes, Result->Images[Slice].GetData(), SliceBytes);
+            Result->Images[Slice].Empty();
+        }
+
+        UTexture2DArray* ImageArray = NewObject<UTexture2DArray>(Outer, Name, RF_Transient);
+        ImageArray->Source.Init(Result->Size.X, Result->Size.Y, 3, 1, TSF_BGRA8, SourceData.GetData());
+        ImageArray->Source.SetId(Result->Ids[3], true);
+        ImageArray->CompressionSettings = Compression;
+        ImageArray->MipGenSettings = TMGS_FromTextureGroup;
+        ImageArray->SRGB = true;
+
+        OutImageArray = ImageArray;
+    }
+    else
+    {
+        for (int32 Channel = 0; Channel < 3; ++Channel)
+        {
+            const FName Name(*FString::Printf(TEXT("CookedImage%d"), Channel + 1));
+            ReleaseName(Outer, UTexture2D::StaticClass(), Name);
+
+            UTexture2D* Texture = NewObject<UTexture2D>(Outer, Name, RF_Transient);
+            Texture->Source.Init(Result->Size.X, Result->Size.Y, 1, 1, TSF_BGRA8, reinterpret_cast<const uint8*>(Result->Images[Channel].GetData()));
+            Texture->Source.SetId(Result->Ids[Channel], true);
+            Texture->CompressionSettings = Compression;
+            Texture->MipGenSettings = TMGS_FromTextureGroup;
+            Texture->SRGB = true;
+
+            OutImages[Channel] = Texture;
+
+            Result->Images[Channel].Empty();
+        }
+    }
+
+    UE_LOG(LogTemp, Log, TEXT("Minra Mosaique: Cook-baked %s (%dx%d%s)."), *DebugName, Result->Size.X, Result->Size.Y,
+        bTextureArray ? TEXT(", texture array") : TEXT(""));
+}
+
+void FMinraCookBake::ReleaseName(UObject* Outer, UClass* Class, FName Name)
+{
+    if (UObject* Existing = StaticFindObjectFast(Class, Outer, Name))
+    {
+        Existing->Rename(nullptr, GetTransientPackage(), REN_DontCreateRedirectors | REN_NonTransactional);
+    }
+}
+
+#endif
@@ -0,0 +1,105 @@
+// Copyright Minra. All Rights Reserved.
+
+#include "MinraCookReport.h"
+
+#if WITH_EDITOR
+
+#include "MinraBakeDDC.h"
+#include "Interfaces/ITargetPlatform.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+
+namespace MinraCookReport
+{
+    struct FStrippedEntry
+    {
+        FString Platform;
+        FString Asset;
+        FString Source;
+        int64 BytesSaved = 0;
+    };
+
+    static FCriticalSection Lock;
+
+    /** Keyed by platform and asset path */
+    static TMap<FString, FStrippedEntry> Stripped;
+}
+
+void FMinraCookReport::AddStripped(const ITargetPlatform* TargetPlatform, const UObject* Asset, const FString& Source, int64 BytesSaved)
+{
+    if (!Asset)
+    {
+        return;
+    }
+
+    MinraCookReport::FStrippedEntry Entry;
+    Entry.Platform = TargetPlatform ? TargetPlatform->PlatformName() : TEXT("Unknown");
+    Entry.Asset = Asset->GetPathName();
+    Entry.Source = Source;
+    Entry.BytesSaved = BytesSaved;
+
+    UE_LOG(LogTemp, Verbose, TEXT("Minra Mosaique: Cooked %s for %s without %s (%lld bytes)."),
+        *Entry.Asset, *Entry.Platform, *Entry.Source, Entry.BytesSaved);
+
+    FScopeLock ScopeLock(&MinraCookReport::Lock);
+    const FString Key = Entry.Platform + TEXT("|") + Entry.Asset;
+    MinraCookReport::Stripped.Add(Key, MoveTemp(Entry));
+}
+
+void FMinraCookReport::Write()
+{
+    int32 CacheHits = 0;
+    int32 CacheMisses = 0;
+    FMinraBakeDDC::GetStats(CacheHits, CacheMisses);
+
+    if (CacheHits + CacheMisses > 0)
+    {
+        UE_LOG(LogTemp, Display, TEXT("Minra Mosaique: Bake cache %d hits, %d misses."), CacheHits, CacheMisses);
+    }
+
+    FScopeLock ScopeLock(&MinraCookReport::Lock);
+
+    if (MinraCookReport::Stripped.Num() == 0)
+    {
+        return;
+    }
+
+    MinraCookReport::Stripped.ValueSort([](const MinraCookReport::FStrippedEntry& A, const MinraCookReport::FStrippedEntry& B)
+    {
+        return A.Platform != B.Platform ? A.Platform < B.Platform : A.Asset < B.Asset;
+    });
+
+    TMap<FString, int64> PlatformTotals;
+    int64 Total = 0;
+
+    FString Csv = TEXT("Platform,Asset,Stripped,BytesSaved\n");
+    for (const TPair<FString, MinraCookReport::FStrippedEntry>& Pair : MinraCookReport::Stripped)
+    {
+        const MinraCookReport::FStrippedEntry& Entry = Pair.Value;
+        Csv += FString::Printf(TEXT("%s,%s,%s,%lld\n"), *Entry.Platform, *Entry.Asset, *Entry.Source, Entry.BytesSaved);
+
+        PlatformTotals.FindOrAdd(Entry.Platform) += Entry.BytesSaved;
+        Total += Entry.BytesSaved;
+    }
+    Csv += FString::Printf(TEXT("Total,,,%lld\n"), Total);
+
+    const FString ReportPath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("MinraMosaique"), TEXT("CookReport.csv"));
+    if (!FFileHelper::SaveStringToFile(Csv, *ReportPath))
+    {
+        UE_LOG(LogTemp, Warning, TEXT("Minra Mosaique: Failed to write %s."), *ReportPath);
+    }
+
+    for (const TPair<FString, int64>& Pair : PlatformTotals)
+    {
+        UE_LOG(LogTemp, Display, TEXT("Minra Mosaique: Cook for %s stripped combined data of baked assets, %.2f MB saved."),
+            *Pair.Key, Pair.Value / (1024.0 * 1024.0));
+    }
+
+    UE_LOG(LogTemp, Display, TEXT("Minra Mosaique: %d stripped assets, %lld bytes saved in total. Report: %s"),
+        MinraCookReport::Stripped.Num(), Total, *ReportPath);
+
+    MinraCookReport::Stripped.Reset();
+}
+
+#endif
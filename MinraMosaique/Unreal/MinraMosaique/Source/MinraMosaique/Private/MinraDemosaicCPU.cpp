@@ -0,0 +1,1528 @@
+// Copyright Minra. All Rights Reserved.
+
+#include "MinraDemosaicCPU.h"
+#include "MinraSIMD.h"
+#include "Engine/Texture2D.h"
+#include "Async/ParallelFor.h"
+#include "Math/VectorRegister.h"
+
+namespace MinraDemosaicCPU
+{
+    // Each vector holds one texel of the combined image in FColor memory order:
+    // lane 0 = CFA 3 (B), lane 1 = CFA 2 (G), lane 2 = CFA 1 (R), lane 3 = alpha (unused).
+    const int32 LANE_IMAGE1 = 2;
+    const int32 LANE_IMAGE2 = 1;
+    const int32 LANE_IMAGE3 = 0;
+
+    int32 ClampIndex(int32 P, int32 Size)
+    {
+        return FMath::Clamp(P, 0, Size - 1);
+    }
+
+    // Same rule as MirrorCoord_MHC in MHCDemosaic.usf
+    int32 MirrorIndex(int32 P, int32 Size)
+    {
+        if (P < 0) P = -P;
+        if (P >= Size) P = 2 * Size - P - 2;
+        return FMath::Clamp(P, 0, Size - 1);
+    }
+
+    /**
+     * Remapped texel indices for offsets -Radius..Radius along one axis.
+     * Boundary handling is separable, so it is resolved once per axis like the shaders do.
+     */
+    template <typename RemapFunc>
+    void BuildAxisTable(int32 Size, int32 Radius, RemapFunc Remap, TArray<int32>& OutTable)
+    {
+        const int32 Taps = 2 * Radius + 1;
+        OutTable.SetNumUninitialized(Size * Taps);
+
+        for (int32 P = 0; P < Size; ++P)
+        {
+            for (int32 Tap = 0; Tap < Taps; ++Tap)
+            {
+                OutTable[P * Taps + Tap] = Remap(P + Tap - Radius, Size);
+            }
+        }
+    }
+
+    // Normalise like a UNORM texture fetch (v / 255, correctly rounded)
+    FORCEINLINE VectorRegister4Float LoadTexel(const FColor* Row, int32 X, const VectorRegister4Float& Scale)
+    {
+        return VectorDivide(VectorLoadByte4(&Row[X]), Scale);
+    }
+
+    FORCEINLINE VectorRegister4Float Add4(const VectorRegister4Float& A, const VectorRegister4Float& B, const VectorRegister4Float& C, const VectorRegister4Float& D)
+    {
+        return VectorAdd(VectorAdd(VectorAdd(A, B), C), D);
+    }
+
+    FORCEINLINE uint8 Quantize(float Value)
+    {
+        return static_cast<uint8>(FMath::Clamp(FMath::RoundToInt(Value * 255.0f), 0, 255));
+    }
+
+    /**
+     * Writes one pixel of each output image from the reconstructed R, G, B vectors.
+     */
+    FORCEINLINE void StorePixel(
+        const VectorRegister4Float& R,
+        const VectorRegister4Float& G,
+        const VectorRegister4Float& B,
+        FColor* Out1,
+        FColor* Out2,
+        FColor* Out3,
+        int32 Index)
+    {
+        alignas(16) float RL[4];
+        alignas(16) float GL[4];
+        alignas(16) float BL[4];
+        VectorStoreAligned(R, RL);
+        VectorStoreAligned(G, GL);
+        VectorStoreAligned(B, BL);
+
+        Out1[Index] = FColor(Quantize(RL[LANE_IMAGE1]), Quantize(GL[LANE_IMAGE1]), Quantize(BL[LANE_IMAGE1]), 255);
+        Out2[Index] = FColor(Quantize(RL[LANE_IMAGE2]), Quantize(GL[LANE_IMAGE2]), Quantize(BL[LANE_IMAGE2]), 255);
+        Out3[Index] = FColor(Quantize(RL[LANE_IMAGE3]), Quantize(GL[LANE_IMAGE3]), Quantize(BL[LANE_IMAGE3]), 255);
+    }
+
+    /**
+     * Offset that moves a pattern's red site onto the RGGB origin (MINRA_CFA_PHASE).
+     */
+    FIntPoint GetCFAPhase(EMinraCFAPattern Pattern)
+    {
+        switch (Pattern)
+        {
+            case EMinraCFAPattern::BGGR: return FIntPoint(1, 1);
+            case EMinraCFAPattern::GRBG: return FIntPoint(1, 0);
+            case EMinraCFAPattern::GBRG: return FIntPoint(0, 1);
+            default:                     return FIntPoint(0, 0);
+        }
+    }
+
+    /**
+     * Columns [XBegin, XEnd) of one row of BilinearDemosaicFused.
+     */
+    void DemosaicRowBilinear(
+        const FColor* Pixels,
+        int32 Width,
+        int32 Y,
+        int32 XBegin,
+        int32 XEnd,
+        FIntPoint Phase,
+        const TArray<int32>& XTable,
+        const TArray<int32>& YTable,
+        FColor* Out1,
+        FColor* Out2,
+        FColor* Out3)
+    {
+        const VectorRegister4Float Scale = MakeVectorRegisterFloat(255.0f, 255.0f, 255.0f, 255.0f);
+        const VectorRegister4Float Quarter = MakeVectorRegisterFloat(0.25f, 0.25f, 0.25f, 0.25f);
+        const VectorRegister4Float Half = MakeVectorRegisterFloat(0.5f, 0.5f, 0.5f, 0.5f);
+
+        const FColor* RowN = Pixels + YTable[Y * 3 + 0] * Width;
+        const FColor* Row0 = Pixels + YTable[Y * 3 + 1] * Width;
+        const FColor* RowS = Pixels + YTable[Y * 3 + 2] * Width;
+        const bool EvenRow = ((Y + Phase.Y) & 1) == 0;
+
+        for (int32 X = XBegin; X < XEnd; ++X)
+        {
+            const int32 XW = XTable[X * 3 + 0];
+            const int32 X0 = XTable[X * 3 + 1];
+            const int32 XE = XTable[X * 3 + 2];
+            const bool EvenCol = ((X + Phase.X) & 1) == 0;
+
+            const VectorRegister4Float Center = LoadTexel(Row0, X0, Scale);
+
+            const VectorRegister4Float Top    = LoadTexel(RowN, X0, Scale);
+            const VectorRegister4Float Bottom = LoadTexel(RowS, X0, Scale);
+            const VectorRegister4Float Left   = LoadTexel(Row0, XW, Scale);
+            const VectorRegister4Float Right  = LoadTexel(Row0, XE, Scale);
+
+            const VectorRegister4Float TopLeft     = LoadTexel(RowN, XW, Scale);
+            const VectorRegister4Float TopRight    = LoadTexel(RowN, XE, Scale);
+            const VectorRegister4Float BottomLeft  = LoadTexel(RowS, XW, Scale);
+            const VectorRegister4Float BottomRight = LoadTexel(RowS, XE, Scale);
+
+            VectorRegister4Float R, G, B;
+
+            if (EvenRow && EvenCol)
+            {
+                R = Center;
+                G = VectorMultiply(Add4(Top, Bottom, Left, Right), Quarter);
+                B = VectorMultiply(Add4(TopLeft, TopRight, BottomLeft, BottomRight), Quarter);
+            }
+            else if (EvenRow && !EvenCol)
+            {
+                R = VectorMultiply(VectorAdd(Left, Right), Half);
+                G = Center;
+                B = VectorMultiply(VectorAdd(Top, Bottom), Half);
+            }
+            else if (!EvenRow && EvenCol)
+            {
+                R = VectorMultiply(VectorAdd(Top, Bottom), Half);
+                G = Center;
+                B = VectorMultiply(VectorAdd(Left, Right), Half);
+            }
+            else
+            {
+                R = VectorMultiply(Add4(TopLeft, TopRight, BottomLeft, BottomRight), Quarter);
+                G = VectorMultiply(Add4(Top, Bottom, Left, Right), Quarter);
+                B = Center;
+            }
+
+            StorePixel(R, G, B, Out1, Out2, Out3, X);
+        }
+    }
+
+    /**
+     * Columns [XBegin, XEnd) of one row of MHCDemosaicFused.
+     */
+    void DemosaicRowMHC(
+        const FColor* Pixels,
+        int32 Width,
+        int32 Y,
+        int32 XBegin,
+        int32 XEnd,
+        FIntPoint Phase,
+        const TArray<int32>& XTable,
+        const TArray<int32>& YTable,
+        FColor* Out1,
+        FColor* Out2,
+        FColor* Out3)
+    {
+        const VectorRegister4Float Scale = MakeVectorRegisterFloat(255.0f, 255.0f, 255.0f, 255.0f);
+        const VectorRegister4Float Half = MakeVectorRegisterFloat(0.5f, 0.5f, 0.5f, 0.5f);
+        const VectorRegister4Float OneAndHalf = MakeVectorRegisterFloat(1.5f, 1.5f, 1.5f, 1.5f);
+        const VectorRegister4Float Two = MakeVectorRegisterFloat(2.0f, 2.0f, 2.0f, 2.0f);
+        const VectorRegister4Float Four = MakeVectorRegisterFloat(4.0f, 4.0f, 4.0f, 4.0f);
+        const VectorRegister4Float Five = MakeVectorRegisterFloat(5.0f, 5.0f, 5.0f, 5.0f);
+        const VectorRegister4Float Six = MakeVectorRegisterFloat(6.0f, 6.0f, 6.0f, 6.0f);
+        const VectorRegister4Float Eight = MakeVectorRegisterFloat(8.0f, 8.0f, 8.0f, 8.0f);
+        const VectorRegister4Float Zero = VectorZeroFloat();
+        const VectorRegister4Float One = VectorOneFloat();
+
+        const FColor* RowN2 = Pixels + YTable[Y * 5 + 0] * Width;
+        const FColor* RowN  = Pixels + YTable[Y * 5 + 1] * Width;
+        const FColor* Row0  = Pixels + YTable[Y * 5 + 2] * Width;
+        const FColor* RowS  = Pixels + YTable[Y * 5 + 3] * Width;
+        const FColor* RowS2 = Pixels + YTable[Y * 5 + 4] * Width;
+        const bool EvenRow = ((Y + Phase.Y) & 1) == 0;
+
+        for (int32 X = XBegin; X < XEnd; ++X)
+        {
+            const int32 XW2 = XTable[X * 5 + 0];
+            const int32 XW  = XTable[X * 5 + 1];
+            const int32 X0  = XTable[X * 5 + 2];
+            const int32 XE  = XTable[X * 5 + 3];
+            const int32 XE2 = XTable[X * 5 + 4];
+            const bool EvenCol = ((X + Phase.X) & 1) == 0;
+
+            const VectorRegister4Float C = LoadTexel(Row0, X0, Scale);
+
+            const VectorRegister4Float N = LoadTexel(RowN, X0, Scale);
+            const VectorRegister4Float S = LoadTexel(RowS, X0, Scale);
+            const VectorRegister4Float W = LoadTexel(Row0, XW, Scale);
+            const VectorRegister4Float E = LoadTexel(Row0, XE, Scale);
+
+            const VectorRegister4Float NW = LoadTexel(RowN, XW, Scale);
+            const VectorRegister4Float NE = LoadTexel(RowN, XE, Scale);
+            const VectorRegister4Float SW = LoadTexel(RowS, XW, Scale);
+            const VectorRegister4Float SE = LoadTexel(RowS, XE, Scale);
+
+            const VectorRegister4Float N2 = LoadTexel(RowN2, X0, Scale);
+            const VectorRegister4Float S2 = LoadTexel(RowS2, X0, Scale);
+            const VectorRegister4Float W2 = LoadTexel(Row0, XW2, Scale);
+            const VectorRegister4Float E2 = LoadTexel(Row0, XE2, Scale);
+
+            // Shared terms, summed in the same order as the shader expressions
+            const VectorRegister4Float Cross = Add4(N, S, W, E);
+            const VectorRegister4Float Cross2 = Add4(N2, S2, W2, E2);
+            const VectorRegister4Float Diagonal = Add4(NW, NE, SW, SE);
+
+            // (4*C + 2*Cross - Cross2) / 8
+            auto GreenAtRB = [&]()
+            {
+                return VectorDivide(VectorSubtract(VectorAdd(VectorMultiply(Four, C), VectorMultiply(Two, Cross)), Cross2), Eight);
+            };
+
+            // (6*C + 2*Diagonal - 1.5*Cross2) / 8
+            auto DiagonalAtRB = [&]()
+            {
+                return VectorDivide(VectorSubtract(VectorAdd(VectorMultiply(Six, C), VectorMultiply(Two, Diagonal)), VectorMultiply(OneAndHalf, Cross2)), Eight);
+            };
+
+            // (5*C + 4*(W+E) - (W2+E2) - Diagonal + 0.5*(N2+S2)) / 8
+            auto HorizontalAtG = [&]()
+            {
+                const VectorRegister4Float Sum = VectorSubtract(VectorSubtract(VectorAdd(VectorMultiply(Five, C), VectorMultiply(Four, VectorAdd(W, E))), VectorAdd(W2, E2)), Diagonal);
+                return VectorDivide(VectorAdd(Sum, VectorMultiply(Half, VectorAdd(N2, S2))), Eight);
+            };
+
+            // (5*C + 4*(N+S) - (N2+S2) - Diagonal + 0.5*(W2+E2)) / 8
+            auto VerticalAtG = [&]()
+            {
+                const VectorRegister4Float Sum = VectorSubtract(VectorSubtract(VectorAdd(VectorMultiply(Five, C), VectorMultiply(Four, VectorAdd(N, S))), VectorAdd(N2, S2)), Diagonal);
+                return VectorDivide(VectorAdd(Sum, VectorMultiply(Half, VectorAdd(W2, E2))), Eight);
+            };
+
+            VectorRegister4Float R, G, B;
+
+            if (EvenRow && EvenCol)
+            {
+                R = C;
+                G = GreenAtRB();
+                B = DiagonalAtRB();
+            }
+            else if (EvenRow && !EvenCol)
+            {
+                G = C;
+                R = HorizontalAtG();
+                B = VerticalAtG();
+            }
+            else if (!EvenRow && EvenCol)
+            {
+                G = C;
+                R = VerticalAtG();
+                B = HorizontalAtG();
+            }
+            else
+            {
+                B = C;
+                G = GreenAtRB();
+                R = DiagonalAtRB();
+            }
+
+            // saturate()
+            R = VectorMin(VectorMax(R, Zero), One);
+            G = VectorMin(VectorMax(G, Zero), One);
+            B = VectorMin(VectorMax(B, Zero), One);
+
+            StorePixel(R, G, B, Out1, Out2, Out3, X);
+        }
+    }
+
+    /**
+     * One output row of SuperpixelDemosaicFused.
+     */
+    void DemosaicRowSuperpixel(
+        const FColor* Pixels,
+        int32 Width,
+        int32 Height,
+        int32 Y,
+        FIntPoint Phase,
+        int32 OutWidth,
+        FColor* Out1,
+        FColor* Out2,
+        FColor* Out3)
+    {
+        const VectorRegister4Float Scale = MakeVectorRegisterFloat(255.0f, 255.0f, 255.0f, 255.0f);
+        const VectorRegister4Float Half = MakeVectorRegisterFloat(0.5f, 0.5f, 0.5f, 0.5f);
+
+        // Quad rows; an odd height mirrors the missing bottom row like QuadCoord_Superpixel
+        const FColor* RowTop = Pixels + (Y * 2) * Width;
+        const FColor* RowBottom = Pixels + MirrorIndex(Y * 2 + 1, Height) * Width;
+
+        // Red at (Phase.X, Phase.Y) inside the quad, blue opposite, greens on the other diagonal
+        const bool bRedRight = Phase.X != 0;
+        const bool bRedBottom = Phase.Y != 0;
+        const bool bGreenAntiDiagonal = bRedRight == bRedBottom;
+
+        for (int32 X = 0; X < OutWidth; ++X)
+        {
+            const int32 X0 = X * 2;
+            const int32 X1 = MirrorIndex(X0 + 1, Width);
+
+            const VectorRegister4Float TopLeft     = LoadTexel(RowTop, X0, Scale);
+            const VectorRegister4Float TopRight    = LoadTexel(RowTop, X1, Scale);
+            const VectorRegister4Float BottomLeft  = LoadTexel(RowBottom, X0, Scale);
+            const VectorRegister4Float BottomRight = LoadTexel(RowBottom, X1, Scale);
+
+            const VectorRegister4Float R = bRedBottom ? (bRedRight ? BottomRight : BottomLeft) : (bRedRight ? TopRight : TopLeft);
+            const VectorRegister4Float B = bRedBottom ? (bRedRight ? TopLeft : TopRight) : (bRedRight ? BottomLeft : BottomRight);
+            const VectorRegister4Float G = VectorMultiply(
+                VectorAdd(bGreenAntiDiagonal ? TopRight : TopLeft, bGreenAntiDiagonal ? BottomLeft : BottomRight), Half);
+
+            StorePixel(R, G, B, Out1, Out2, Out3, X);
+        }
+    }
+
+    // The colour-difference demosaicers below are ports of client/js/demosaicing-advanced.js.
+    // They work in 0-255 units and round each stage to an integer like the JS clamp(),
+    // so intermediate planes are stored as bytes in the combined texture's lane order.
+
+    FORCEINLINE VectorRegister4Float LoadBytes(const FColor* Row, int32 X)
+    {
+        return VectorLoadByte4(&Row[X]);
+    }
+
+    // Math.round and clamp to 0-255
+    FORCEINLINE VectorRegister4Float Round255(const VectorRegister4Float& Value)
+    {
+        const VectorRegister4Float Half = MakeVectorRegisterFloat(0.5f, 0.5f, 0.5f, 0.5f);
+        const VectorRegister4Float Max = MakeVectorRegisterFloat(255.0f, 255.0f, 255.0f, 255.0f);
+        return VectorMin(VectorMax(VectorFloor(VectorAdd(Value, Half)), VectorZeroFloat()), Max);
+    }
+
+    /**
+     * Writes one pixel of each output image from per-site planes (lanes = CFAs).
+     */
+    FORCEINLINE void StorePlanePixel(
+        const FColor& R,
+        const FColor& G,
+        const FColor& B,
+        FColor* Out1,
+        FColor* Out2,
+        FColor* Out3,
+        int32 Index)
+    {
+        // Lane 2/1/0 of a texel is its R/G/B member
+        Out1[Index] = FColor(R.R, G.R, B.R, 255);
+        Out2[Index] = FColor(R.G, G.G, B.G, 255);
+        Out3[Index] = FColor(R.B, G.B, B.B, 255);
+    }
+
+    /**
+     * Weight of the horizontal green estimate at an R/B site, from the 5-tap cross
+     * around it. Each algorithm's JS blend (wH * H + wV * V) / (wH + wV) is rewritten as
+     * V + (H - V) * T, one division instead of three and no overflow for SmoothHue.
+     */
+    FORCEINLINE VectorRegister4Float HorizontalGreenWeight(
+        EMinraDemosaicAlgorithm Algorithm,
+        const VectorRegister4Float& C,
+        const VectorRegister4Float& W, const VectorRegister4Float& E,
+        const VectorRegister4Float& N, const VectorRegister4Float& S,
+        const VectorRegister4Float& W2, const VectorRegister4Float& E2,
+        const VectorRegister4Float& N2, const VectorRegister4Float& S2)
+    {
+        const VectorRegister4Float One = VectorOneFloat();
+
+        if (Algorithm == EMinraDemosaicAlgorithm::SmoothHue)
+        {
+            // wH = exp(-1.5 * GradH), so T = 1 / (1 + exp(1.5 * (GradH - GradV)))
+            const VectorRegister4Float K = MakeVectorRegisterFloat(1.5f, 1.5f, 1.5f, 1.5f);
+            const VectorRegister4Float GradH = VectorAdd(VectorAbs(VectorSubtract(W, E)), VectorAbs(VectorSubtract(W2, E2)));
+            const VectorRegister4Float GradV = VectorAdd(VectorAbs(VectorSubtract(N, S)), VectorAbs(VectorSubtract(N2, S2)));
+            return VectorDivide(One, VectorAdd(One, VectorExp(VectorMultiply(K, VectorSubtract(GradH, GradV)))));
+        }
+
+        VectorRegister4Float GradH, GradV;
+
+        if (Algorithm == EMinraDemosaicAlgorithm::FrequencyAware)
+        {
+            GradH = VectorAdd(VectorAdd(VectorAbs(VectorSubtract(W2, C)), VectorAbs(VectorSubtract(C, E2))), VectorAbs(VectorSubtract(W, E)));
+            GradV = VectorAdd(VectorAdd(VectorAbs(VectorSubtract(N2, C)), VectorAbs(VectorSubtract(C, S2))), VectorAbs(VectorSubtract(N, S)));
+        }
+        else
+        {
+            const VectorRegister4Float TwoC = VectorAdd(C, C);
+            GradH = VectorAdd(VectorAbs(VectorSubtract(W, E)), VectorAbs(VectorSubtract(VectorSubtract(TwoC, W2), E2)));
+            GradV = VectorAdd(VectorAbs(VectorSubtract(N, S)), VectorAbs(VectorSubtract(VectorSubtract(TwoC, N2), S2)));
+        }
+
+        // wH = 1 / (GradH + eps), so T = (GradV + eps) / (GradH + GradV + 2 eps)
+        const VectorRegister4Float Epsilon = MakeVectorRegisterFloat(0.1f, 0.1f, 0.1f, 0.1f);
+        const VectorRegister4Float WeightV = VectorAdd(GradV, Epsilon);
+        return VectorDivide(WeightV, VectorAdd(VectorAdd(GradH, Epsilon), WeightV));
+    }
+
+    /**
+     * One row of the green plane: CFA green at G sites, the edge-directed blend of the
+     * Laplacian-corrected horizontal and vertical estimates at R and B sites.
+     */
+    void DemosaicRowAdaptiveGreen(
+        const FColor* Pixels,
+        int32 Width,
+        int32 Y,
+        FIntPoint Phase,
+        EMinraDemosaicAlgorithm Algorithm,
+        const TArray<int32>& XTable,
+        const TArray<int32>& YTable,
+        FColor* GreenRow)
+    {
+        const VectorRegister4Float Half = MakeVectorRegisterFloat(0.5f, 0.5f, 0.5f, 0.5f);
+        const VectorRegister4Float Quarter = MakeVectorRegisterFloat(0.25f, 0.25f, 0.25f, 0.25f);
+
+        const FColor* RowN2 = Pixels + YTable[Y * 5 + 0] * Width;
+        const FColor* RowN  = Pixels + YTable[Y * 5 + 1] * Width;
+        const FColor* Row0  = Pixels + YTable[Y * 5 + 2] * Width;
+        const FColor* RowS  = Pixels + YTable[Y * 5 + 3] * Width;
+        const FColor* RowS2 = Pixels + YTable[Y * 5 + 4] * Width;
+        const bool EvenRow = ((Y + Phase.Y) & 1) == 0;
+
+        for (int32 X = 0; X < Width; ++X)
+        {
+            const int32 X0 = XTable[X * 5 + 2];
+            const bool EvenCol = ((X + Phase.X) & 1) == 0;
+
+            if (EvenRow != EvenCol)
+            {
+                GreenRow[X] = Row0[X0];
+                continue;
+            }
+
+            const VectorRegister4Float C = LoadBytes(Row0, X0);
+
+            const VectorRegister4Float W = LoadBytes(Row0, XTable[X * 5 + 1]);
+            const VectorRegister4Float E = LoadBytes(Row0, XTable[X * 5 + 3]);
+            const VectorRegister4Float N = LoadBytes(RowN, X0);
+            const VectorRegister4Float S = LoadBytes(RowS, X0);
+
+            const VectorRegister4Float W2 = LoadBytes(Row0, XTable[X * 5 + 0]);
+            const VectorRegister4Float E2 = LoadBytes(Row0, XTable[X * 5 + 4]);
+            const VectorRegister4Float N2 = LoadBytes(RowN2, X0);
+            const VectorRegister4Float S2 = LoadBytes(RowS2, X0);
+
+            // (W + E) / 2 + (2C - W2 - E2) / 4, and the same vertically
+            const VectorRegister4Float TwoC = VectorAdd(C, C);
+            const VectorRegister4Float EstimateH = VectorAdd(VectorMultiply(VectorAdd(W, E), Half), VectorMultiply(VectorSubtract(VectorSubtract(TwoC, W2), E2), Quarter));
+            const VectorRegister4Float EstimateV = VectorAdd(VectorMultiply(VectorAdd(N, S), Half), VectorMultiply(VectorSubtract(VectorSubtract(TwoC, N2), S2), Quarter));
+
+            const VectorRegister4Float T = HorizontalGreenWeight(Algorithm, C, W, E, N, S, W2, E2, N2, S2);
+            VectorStoreByte4(Round255(VectorAdd(EstimateV, VectorMultiply(VectorSubtract(EstimateH, EstimateV), T))), &GreenRow[X]);
+        }
+    }
+
+    /**
+     * One row of the red and blue planes: native samples at their own sites, elsewhere the
+     * pixel's green plus the average colour difference (C - G) of the nearest same-colour
+     * sites. SmoothHue averages log((C + 1) / (G + 1)) instead; exp of that mean is the
+     * geometric mean of the ratios, so it is computed with square roots rather than log/exp.
+     */
+    void DemosaicRowChroma(
+        const FColor* Pixels,
+        const FColor* Green,
+        int32 Width,
+        int32 Y,
+        FIntPoint Phase,
+        bool bRatio,
+        const TArray<int32>& XTable,
+        const TArray<int32>& YTable,
+        FColor* RedRow,
+        FColor* BlueRow)
+    {
+        const VectorRegister4Float Half = MakeVectorRegisterFloat(0.5f, 0.5f, 0.5f, 0.5f);
+        const VectorRegister4Float Quarter = MakeVectorRegisterFloat(0.25f, 0.25f, 0.25f, 0.25f);
+        const VectorRegister4Float One = VectorOneFloat();
+
+        const int32 YN = YTable[Y * 5 + 1];
+        const int32 Y0 = YTable[Y * 5 + 2];
+        const int32 YS = YTable[Y * 5 + 3];
+        const FColor* RowN = Pixels + YN * Width;
+        const FColor* Row0 = Pixels + Y0 * Width;
+        const FColor* RowS = Pixels + YS * Width;
+        const FColor* GreenN = Green + YN * Width;
+        const FColor* Green0 = Green + Y0 * Width;
+        const FColor* GreenS = Green + YS * Width;
+        const bool EvenRow = ((Y + Phase.Y) & 1) == 0;
+
+        // Colour difference or colour ratio of a same-colour site
+        auto Chroma = [&](const FColor* Row, const FColor* GreenRowPtr, int32 XI)
+        {
+            const VectorRegister4Float C = LoadBytes(Row, XI);
+            const VectorRegister4Float G = LoadBytes(GreenRowPtr, XI);
+            return bRatio ? VectorDivide(VectorAdd(C, One), VectorAdd(G, One)) : VectorSubtract(C, G);
+        };
+
+        // Pixel green combined with the mean chroma of two or four sites
+        auto Reconstruct2 = [&](const VectorRegister4Float& G, const VectorRegister4Float& A, const VectorRegister4Float& B)
+        {
+            return bRatio
+                ? Round255(VectorSubtract(VectorMultiply(VectorAdd(G, One), VectorSqrt(VectorMultiply(A, B))), One))
+                : Round255(VectorAdd(G, VectorMultiply(VectorAdd(A, B), Half)));
+        };
+
+        auto Reconstruct4 = [&](const VectorRegister4Float& G, const VectorRegister4Float& A, const VectorRegister4Float& B, const VectorRegister4Float& C, const VectorRegister4Float& D)
+        {
+            return bRatio
+                ? Round255(VectorSubtract(VectorMultiply(VectorAdd(G, One), VectorSqrt(VectorSqrt(VectorMultiply(VectorMultiply(A, B), VectorMultiply(C, D))))), One))
+                : Round255(VectorAdd(G, VectorMultiply(Add4(A, B, C, D), Quarter)));
+        };
+
+        for (int32 X = 0; X < Width; ++X)
+        {
+            const int32 XW = XTable[X * 5 + 1];
+            const int32 X0 = XTable[X * 5 + 2];
+            const int32 XE = XTable[X * 5 + 3];
+            const bool EvenCol = ((X + Phase.X) & 1) == 0;
+
+            const VectorRegister4Float G = LoadBytes(Green0, X0);
+
+            if (EvenRow == EvenCol)
+            {
+                // R or B site: the other colour sits on the diagonals
+                const VectorRegister4Float Diagonal = Reconstruct4(G,
+                    Chroma(RowN, GreenN, XW), Chroma(RowN, GreenN, XE),
+                    Chroma(RowS, GreenS, XW), Chroma(RowS, GreenS, XE));
+
+                FColor& Native = EvenRow ? RedRow[X] : BlueRow[X];
+                FColor& Other = EvenRow ? BlueRow[X] : RedRow[X];
+                Native = Row0[X0];
+                VectorStoreByte4(Diagonal, &Other);
+            }
+            else
+            {
+                // G site: one colour on the row, the other on the column
+                const VectorRegister4Float Horizontal = Reconstruct2(G, Chroma(Row0, Green0, XW), Chroma(Row0, Green0, XE));
+                const VectorRegister4Float Vertical = Reconstruct2(G, Chroma(RowN, GreenN, X0), Chroma(RowS, GreenS, X0));
+
+                VectorStoreByte4(EvenRow ? Horizontal : Vertical, &RedRow[X]);
+                VectorStoreByte4(EvenRow ? Vertical : Horizontal, &BlueRow[X]);
+            }
+        }
+    }
+
+    // Median of nine by exchange network (19 min/max pairs), per lane
+    FORCEINLINE VectorRegister4Float Median9(VectorRegister4Float P[9])
+    {
+        auto Sort = [&P](int32 A, int32 B)
+        {
+            const VectorRegister4Float Low = VectorMin(P[A], P[B]);
+            P[B] = VectorMax(P[A], P[B]);
+            P[A] = Low;
+        };
+
+        Sort(1, 2); Sort(4, 5); Sort(7, 8);
+        Sort(0, 1); Sort(3, 4); Sort(6, 7);
+        Sort(1, 2); Sort(4, 5); Sort(7, 8);
+        Sort(0, 3); Sort(5, 8); Sort(4, 7);
+        Sort(3, 6); Sort(1, 4); Sort(2, 5);
+        Sort(4, 7); Sort(4, 2); Sort(6, 4);
+        Sort(4, 2);
+        return P[4];
+    }
+
+    /**
+     * One output row of AGCRD's artifact suppression: in flat green regions, red and blue
+     * values far from their 3x3 median are pulled 40% towards it. Interior pixels only;
+     * the two-pixel border is written unchanged.
+     */
+    void DemosaicRowSuppress(
+        const FColor* Red,
+        const FColor* Green,
+        const FColor* Blue,
+        int32 Width,
+        int32 Height,
+        int32 Y,
+        FColor* Out1,
+        FColor* Out2,
+        FColor* Out3)
+    {
+        const VectorRegister4Float FlatLimit = MakeVectorRegisterFloat(30.0f, 30.0f, 30.0f, 30.0f);
+        const VectorRegister4Float DeviationLimit = MakeVectorRegisterFloat(15.0f, 15.0f, 15.0f, 15.0f);
+        const VectorRegister4Float KeepWeight = MakeVectorRegisterFloat(0.6f, 0.6f, 0.6f, 0.6f);
+        const VectorRegister4Float MedianWeight = MakeVectorRegisterFloat(0.4f, 0.4f, 0.4f, 0.4f);
+
+        const int32 RowOffset = Y * Width;
+        const bool bInteriorRow = Y >= 2 && Y < Height - 2;
+
+        auto Suppress = [&](const FColor* Plane, int32 X, const VectorRegister4Float& FlatMask)
+        {
+            VectorRegister4Float P[9];
+            for (int32 DY = -1; DY <= 1; ++DY)
+            {
+                const FColor* Row = Plane + (Y + DY) * Width;
+                P[(DY + 1) * 3 + 0] = LoadBytes(Row, X - 1);
+                P[(DY + 1) * 3 + 1] = LoadBytes(Row, X);
+                P[(DY + 1) * 3 + 2] = LoadBytes(Row, X + 1);
+            }
+
+            const VectorRegister4Float Center = P[4];
+            const VectorRegister4Float Median = Median9(P);
+            const VectorRegister4Float Deviates = VectorCompareGT(VectorAbs(VectorSubtract(Center, Median)), DeviationLimit);
+            const VectorRegister4Float Blended = Round255(VectorAdd(VectorMultiply(KeepWeight, Center), VectorMultiply(MedianWeight, Median)));
+
+            FColor Result;
+            VectorStoreByte4(VectorSelect(VectorBitwiseAnd(FlatMask, Deviates), Blended, Center), &Result);
+            return Result;
+        };
+
+        for (int32 X = 0; X < Width; ++X)
+        {
+            const int32 Index = RowOffset + X;
+
+            if (!bInteriorRow || X < 2 || X >= Width - 2)
+            {
+                StorePlanePixel(Red[Index], Green[Index], Blue[Index], Out1, Out2, Out3, X);
+                continue;
+            }
+
+            const VectorRegister4Float GradX = VectorAbs(VectorSubtract(LoadBytes(Green, Index - 1), LoadBytes(Green, Index + 1)));
+            const VectorRegister4Float GradY = VectorAbs(VectorSubtract(LoadBytes(Green, Index - Width), LoadBytes(Green, Index + Width)));
+            const VectorRegister4Float FlatMask = VectorCompareLT(VectorAdd(GradX, GradY), FlatLimit);
+
+            // Lanes 0-2 are the CFAs; skip both medians when no image is flat here
+            if ((VectorMaskBits(FlatMask) & 0x7) == 0)
+            {
+                StorePlanePixel(Red[Index], Green[Index], Blue[Index], Out1, Out2, Out3, X);
+                continue;
+            }
+
+            StorePlanePixel(Suppress(Red, X, FlatMask), Green[Index], Suppress(Blue, X, FlatMask), Out1, Out2, Out3, X);
+        }
+    }
+
+    /**
+     * Output rows 2Y and 2Y + 1 of NearestDemosaicAll: one superpixel row, splatted over
+     * each quad's 2x2 pixels. Scratch holds three superpixel rows.
+     */
+    void DemosaicRowNearest(
+        const FColor* Pixels,
+        int32 Width,
+        int32 Height,
+        int32 Y,
+        FIntPoint Phase,
+        FColor* Scratch,
+        FColor* Out1,
+        FColor* Out2,
+        FColor* Out3)
+    {
+        const int32 QuadWidth = (Width + 1) / 2;
+        FColor* Quads[3] = { Scratch, Scratch + QuadWidth, Scratch + QuadWidth * 2 };
+        FColor* Outs[3] = { Out1, Out2, Out3 };
+
+        DemosaicRowSuperpixel(Pixels, Width, Height, Y, Phase, QuadWidth, Quads[0], Quads[1], Quads[2]);
+
+        // An odd height has no second row for the last quad row
+        const bool bSecondRow = Y * 2 + 1 < Height;
+
+        for (int32 Image = 0; Image < 3; ++Image)
+        {
+            FColor* Top = Outs[Image] + (Y * 2) * Width;
+            MinraSIMD::DuplicatePixels(Quads[Image], Top, Width);
+
+            if (bSecondRow)
+            {
+                FMemory::Memcpy(Top + Width, Top, Width * sizeof(FColor));
+            }
+        }
+    }
+
+    /**
+     * Mean same-colour gradient |C - C(x+2)| + |C - C(y+2)| over [X0, X1) x [Y0, Y1), in 0-255
+     * units, of the busiest of the three CFAs. Pairs that would leave the image are skipped.
+     */
+    float TileGradientEnergy(const FColor* Pixels, int32 Width, int32 Height, int32 X0, int32 Y0, int32 X1, int32 Y1)
+    {
+        VectorRegister4Float Sum = VectorZeroFloat();
+        const int32 XEndH = FMath::Min(X1, Width - 2);
+
+        for (int32 Y = Y0; Y < Y1; ++Y)
+        {
+            const FColor* Row = Pixels + Y * Width;
+
+            for (int32 X = X0; X < XEndH; ++X)
+            {
+                Sum = VectorAdd(Sum, VectorAbs(VectorSubtract(LoadBytes(Row, X), LoadBytes(Row, X + 2))));
+            }
+
+            if (Y + 2 < Height)
+            {
+                const FColor* RowS = Row + 2 * Width;
+                for (int32 X = X0; X < X1; ++X)
+                {
+                    Sum = VectorAdd(Sum, VectorAbs(VectorSubtract(LoadBytes(Row, X), LoadBytes(RowS, X))));
+                }
+            }
+        }
+
+        alignas(16) float Lanes[4];
+        VectorStoreAligned(Sum, Lanes);
+        const float Busiest = FMath::Max3(Lanes[LANE_IMAGE1], Lanes[LANE_IMAGE2], Lanes[LANE_IMAGE3]);
+        return Busiest / ((X1 - X0) * (Y1 - Y0));
+    }
+
+    // AHD (Hirakawa-Parks adaptive homogeneity-directed) runs per tile. Each tile demosaics
+    // its core plus an apron wide enough for every stage, so tiles are independent:
+    // CFA +-2 for green, +-1 for red/blue, +-1 for homogeneity, +-1 for its 3x3 sum.
+    const int32 AHD_TILE_SIZE = 40;
+    const int32 AHD_APRON = 5;
+
+    /**
+     * sRGB decode and CIELab f(t) tables. Lab is only compared between the two
+     * directional candidates of the same pixel, so table precision is ample.
+     */
+    struct FAHDLabTables
+    {
+        static constexpr int32 CBRT_SIZE = 4096;
+
+        float Linear[256];
+        float Cbrt[CBRT_SIZE + 1];
+
+        FAHDLabTables()
+        {
+            for (int32 Index = 0; Index < 256; ++Index)
+            {
+                const float V = Index / 255.0f;
+                Linear[Index] = V <= 0.04045f ? V / 12.92f : FMath::Pow((V + 0.055f) / 1.055f, 2.4f);
+            }
+
+            for (int32 Index = 0; Index <= CBRT_SIZE; ++Index)
+            {
+                const float T = static_cast<float>(Index) / CBRT_SIZE;
+                Cbrt[Index] = T > 0.008856f ? FMath::Pow(T, 1.0f / 3.0f) : 7.787f * T + 16.0f / 116.0f;
+            }
+        }
+
+        static const FAHDLabTables& Get()
+        {
+            static const FAHDLabTables Tables;
+            return Tables;
+        }
+    };
+
+    /**
+     * Converts per-lane 0-255 RGB to CIELab (D65). Lanes are converted independently.
+     */
+    void RGBToLab(
+        const FAHDLabTables& Tables,
+        const VectorRegister4Float& R,
+        const VectorRegister4Float& G,
+        const VectorRegister4Float& B,
+        VectorRegister4Float& OutL,
+        VectorRegister4Float& OutA,
+        VectorRegister4Float& OutB)
+    {
+        alignas(16) float RL[4];
+        alignas(16) float GL[4];
+        alignas(16) float BL[4];
+        VectorStoreAligned(R, RL);
+        VectorStoreAligned(G, GL);
+        VectorStoreAligned(B, BL);
+
+        for (int32 Lane = 0; Lane < 4; ++Lane)
+        {
+            RL[Lane] = Tables.Linear[static_cast<int32>(RL[Lane])];
+            GL[Lane] = Tables.Linear[static_cast<int32>(GL[Lane])];
+            BL[Lane] = Tables.Linear[static_cast<int32>(BL[Lane])];
+        }
+
+        const VectorRegister4Float LinearR = VectorLoadAligned(RL);
+        const VectorRegister4Float LinearG = VectorLoadAligned(GL);
+        const VectorRegister4Float LinearB = VectorLoadAligned(BL);
+
+        // sRGB to XYZ, each row divided by the D65 white point, then scaled to a table index
+        const float Scale = static_cast<float>(FAHDLabTables::CBRT_SIZE);
+        auto Row = [&](float CR, float CG, float CB)
+        {
+            const VectorRegister4Float Value = VectorAdd(VectorAdd(
+                VectorMultiply(LinearR, MakeVectorRegisterFloat(CR, CR, CR, CR)),
+                VectorMultiply(LinearG, MakeVectorRegisterFloat(CG, CG, CG, CG))),
+                VectorMultiply(LinearB, MakeVectorRegisterFloat(CB, CB, CB, CB)));
+            return VectorMin(VectorMax(VectorAdd(VectorMultiply(Value, MakeVectorRegisterFloat(Scale, Scale, Scale, Scale)),
+                MakeVectorRegisterFloat(0.5f, 0.5f, 0.5f, 0.5f)), VectorZeroFloat()), MakeVectorRegisterFloat(Scale, Scale, Scale, Scale));
+        };
+
+        alignas(16) float FX[4];
+        alignas(16) float FY[4];
+        alignas(16) float FZ[4];
+        VectorStoreAligned(Row(0.4124564f / 0.95047f, 0.3575761f / 0.95047f, 0.1804375f / 0.95047f), FX);
+        VectorStoreAligned(Row(0.2126729f, 0.7151522f, 0.0721750f), FY);
+        VectorStoreAligned(Row(0.0193339f / 1.08883f, 0.1191920f / 1.08883f, 0.9503041f / 1.08883f), FZ);
+
+        for (int32 Lane = 0; Lane < 4; ++Lane)
+        {
+            FX[Lane] = Tables.Cbrt[static_cast<int32>(FX[Lane])];
+            FY[Lane] = Tables.Cbrt[static_cast<int32>(FY[Lane])];
+            FZ[Lane] = Tables.Cbrt[static_cast<int32>(FZ[Lane])];
+        }
+
+        const VectorRegister4Float VX = VectorLoadAligned(FX);
+        const VectorRegister4Float VY = VectorLoadAligned(FY);
+        const VectorRegister4Float VZ = VectorLoadAligned(FZ);
+
+        OutL = VectorSubtract(VectorMultiply(VY, MakeVectorRegisterFloat(116.0f, 116.0f, 116.0f, 116.0f)), MakeVectorRegisterFloat(16.0f, 16.0f, 16.0f, 16.0f));
+        OutA = VectorMultiply(VectorSubtract(VX, VY), MakeVectorRegisterFloat(500.0f, 500.0f, 500.0f, 500.0f));
+        OutB = VectorMultiply(VectorSubtract(VY, VZ), MakeVectorRegisterFloat(200.0f, 200.0f, 200.0f, 200.0f));
+    }
+
+    /**
+     * Working buffers of one AHD tile, (core + 2 * apron)^2 texels with the three CFAs in
+     * lanes: about 600 KB at the default tile size, so a tile stays in L2. Each worker owns
+     * one and reuses it for every tile it runs.
+     */
+    struct FAHDTile
+    {
+        int32 Width = 0;
+        int32 Height = 0;
+
+        TArray<VectorRegister4Float> Cfa;
+
+        // Candidate images and their Lab values, [0] horizontal, [1] vertical
+        TArray<VectorRegister4Float> Red[2];
+        TArray<VectorRegister4Float> Green[2];
+        TArray<VectorRegister4Float> Blue[2];
+        TArray<VectorRegister4Float> L[2];
+        TArray<VectorRegister4Float> A[2];
+        TArray<VectorRegister4Float> B[2];
+        TArray<VectorRegister4Float> Homogeneity[2];
+
+        // Mirrored image column of each tile column
+        TArray<int32> Columns;
+
+        /** Sets the tile extent; buffers are allocated at full tile size once, so edge tiles never reallocate */
+        void Init(int32 InWidth, int32 InHeight)
+        {
+            Width = InWidth;
+            Height = InHeight;
+
+            if (Cfa.Num() > 0)
+            {
+                return;
+            }
+
+            const int32 MaxSize = AHD_TILE_SIZE + 2 * AHD_APRON;
+            const int32 Count = MaxSize * MaxSize;
+            Columns.SetNumUninitialized(MaxSize);
+            Cfa.SetNumUninitialized(Count);
+            for (int32 Direction = 0; Direction < 2; ++Direction)
+            {
+                Red[Direction].SetNumUninitialized(Count);
+                Green[Direction].SetNumUninitialized(Count);
+                Blue[Direction].SetNumUninitialized(Count);
+                L[Direction].SetNumUninitialized(Count);
+                A[Direction].SetNumUninitialized(Count);
+                B[Direction].SetNumUninitialized(Count);
+                Homogeneity[Direction].SetNumUninitialized(Count);
+            }
+        }
+    };
+
+    /**
+     * Demosaics one AHD tile whose core starts at image texel Origin.
+     */
+    void DemosaicTileAHD(
+        const FColor* Pixels,
+        int32 ImageWidth,
+        int32 ImageHeight,
+        FIntPoint Phase,
+        FIntPoint Origin,
+        FIntPoint CoreSize,
+        FAHDTile& Tile,
+        FColor* Out1,
+        FColor* Out2,
+        FColor* Out3)
+    {
+        const VectorRegister4Float Half = MakeVectorRegisterFloat(0.5f, 0.5f, 0.5f, 0.5f);
+        const VectorRegister4Float Quarter = MakeVectorRegisterFloat(0.25f, 0.25f, 0.25f, 0.25f);
+        const VectorRegister4Float One = VectorOneFloat();
+        const FAHDLabTables& Tables = FAHDLabTables::Get();
+
+        const int32 TW = CoreSize.X + 2 * AHD_APRON;
+        const int32 TH = CoreSize.Y + 2 * AHD_APRON;
+        Tile.Init(TW, TH);
+
+        // Image position of tile texel (0, 0). Mirroring keeps parity, so sites follow
+        // the unmirrored position.
+        const int32 X0 = Origin.X - AHD_APRON;
+        const int32 Y0 = Origin.Y - AHD_APRON;
+        auto IsEvenRow = [&](int32 TY) { return ((Y0 + TY + Phase.Y) & 1) == 0; };
+        auto IsEvenCol = [&](int32 TX) { return ((X0 + TX + Phase.X) & 1) == 0; };
+
+        // 1. Fetch the CFA with mirrored borders, so later stages need no bounds logic
+        int32* Columns = Tile.Columns.GetData();
+        for (int32 TX = 0; TX < TW; ++TX)
+        {
+            Columns[TX] = MirrorIndex(X0 + TX, ImageWidth);
+        }
+
+        for (int32 TY = 0; TY < TH; ++TY)
+        {
+            const FColor* Row = Pixels + MirrorIndex(Y0 + TY, ImageHeight) * ImageWidth;
+            VectorRegister4Float* Dest = Tile.Cfa.GetData() + TY * TW;
+            for (int32 TX = 0; TX < TW; ++TX)
+            {
+                Dest[TX] = LoadBytes(Row, Columns[TX]);
+            }
+        }
+
+        const VectorRegister4Float* Cfa = Tile.Cfa.GetData();
+
+        // 2. Horizontal and vertical green: Hamilton-Adams estimate limited to its two neighbours
+        for (int32 TY = 2; TY < TH - 2; ++TY)
+        {
+            const bool EvenRow = IsEvenRow(TY);
+            for (int32 TX = 2; TX < TW - 2; ++TX)
+            {
+                const int32 I = TY * TW + TX;
+                const VectorRegister4Float C = Cfa[I];
+
+                if (EvenRow != IsEvenCol(TX))
+                {
+                    Tile.Green[0][I] = C;
+                    Tile.Green[1][I] = C;
+                    continue;
+                }
+
+                auto Directional = [&](int32 Step)
+                {
+                    const VectorRegister4Float Near0 = Cfa[I - Step];
+                    const VectorRegister4Float Near1 = Cfa[I + Step];
+                    const VectorRegister4Float Estimate = VectorAdd(
+                        VectorMultiply(VectorAdd(Near0, Near1), Half),
+                        VectorMultiply(VectorSubtract(VectorSubtract(VectorAdd(C, C), Cfa[I - 2 * Step]), Cfa[I + 2 * Step]), Quarter));
+                    return Round255(VectorMin(VectorMax(Estimate, VectorMin(Near0, Near1)), VectorMax(Near0, Near1)));
+                };
+
+                Tile.Green[0][I] = Directional(1);
+                Tile.Green[1][I] = Directional(TW);
+            }
+        }
+
+        // 3. Red and blue for each direction from colour differences against that direction's
+        //    green, then CIELab. Sites alternate along a row, so each row is two strided passes.
+        for (int32 Direction = 0; Direction < 2; ++Direction)
+        {
+            const VectorRegister4Float* Green = Tile.Green[Direction].GetData();
+            VectorRegister4Float* Red = Tile.Red[Direction].GetData();
+            VectorRegister4Float* Blue = Tile.Blue[Direction].GetData();
+
+            auto Difference = [&](int32 I) { return VectorSubtract(Cfa[I], Green[I]); };
+
+            for (int32 TY = 3; TY < TH - 3; ++TY)
+            {
+                const bool EvenRow = IsEvenRow(TY);
+                const int32 ColourStart = IsEvenCol(3) == EvenRow ? 3 : 4;
+
+                // Red or blue sites: the other colour from the four diagonal differences
+                VectorRegister4Float* Own = EvenRow ? Red : Blue;
+                VectorRegister4Float* Other = EvenRow ? Blue : Red;
+                for (int32 TX = ColourStart; TX < TW - 3; TX += 2)
+                {
+                    const int32 I = TY * TW + TX;
+                    Own[I] = Cfa[I];
+                    Other[I] = Round255(VectorAdd(Green[I], VectorMultiply(
+                        Add4(Difference(I - TW - 1), Difference(I - TW + 1), Difference(I + TW - 1), Difference(I + TW + 1)), Quarter)));
+                }
+
+                // Green sites: the row's colour from the horizontal pair, the other from the vertical pair
+                for (int32 TX = 7 - ColourStart; TX < TW - 3; TX += 2)
+                {
+                    const int32 I = TY * TW + TX;
+                    Own[I] = Round255(VectorAdd(Cfa[I], VectorMultiply(VectorAdd(Difference(I - 1), Difference(I + 1)), Half)));
+                    Other[I] = Round255(VectorAdd(Cfa[I], VectorMultiply(VectorAdd(Difference(I - TW), Difference(I + TW)), Half)));
+                }
+
+                for (int32 TX = 3; TX < TW - 3; ++TX)
+                {
+                    const int32 I = TY * TW + TX;
+                    RGBToLab(Tables, Red[I], Green[I], Blue[I], Tile.L[Direction][I], Tile.A[Direction][I], Tile.B[Direction][I]);
+                }
+            }
+        }
+
+        // 4. Homogeneity: neighbours within the smaller of the two directions' own-axis
+        //    Lab distances, counted per direction
+        const int32 Offsets[4] = { -1, 1, -TW, TW };
+
+        for (int32 TY = 4; TY < TH - 4; ++TY)
+        {
+            for (int32 TX = 4; TX < TW - 4; ++TX)
+            {
+                const int32 I = TY * TW + TX;
+                VectorRegister4Float LDiff[2][4];
+                VectorRegister4Float ABDiff[2][4];
+
+                for (int32 Direction = 0; Direction < 2; ++Direction)
+                {
+                    for (int32 Neighbour = 0; Neighbour < 4; ++Neighbour)
+                    {
+                        const int32 J = I + Offsets[Neighbour];
+                        const VectorRegister4Float DA = VectorSubtract(Tile.A[Direction][I], Tile.A[Direction][J]);
+                        const VectorRegister4Float DB = VectorSubtract(Tile.B[Direction][I], Tile.B[Direction][J]);
+                        LDiff[Direction][Neighbour] = VectorAbs(VectorSubtract(Tile.L[Direction][I], Tile.L[Direction][J]));
+                        ABDiff[Direction][Neighbour] = VectorAdd(VectorMultiply(DA, DA), VectorMultiply(DB, DB));
+                    }
+                }
+
+                const VectorRegister4Float LEpsilon = VectorMin(VectorMax(LDiff[0][0], LDiff[0][1]), VectorMax(LDiff[1][2], LDiff[1][3]));
+                const VectorRegister4Float ABEpsilon = VectorMin(VectorMax(ABDiff[0][0], ABDiff[0][1]), VectorMax(ABDiff[1][2], ABDiff[1][3]));
+
+                for (int32 Direction = 0; Direction < 2; ++Direction)
+                {
+                    VectorRegister4Float Count = VectorZeroFloat();
+                    for (int32 Neighbour = 0; Neighbour < 4; ++Neighbour)
+                    {
+                        const VectorRegister4Float Similar = VectorBitwiseAnd(
+                            VectorCompareLE(LDiff[Direction][Neighbour], LEpsilon),
+                            VectorCompareLE(ABDiff[Direction][Neighbour], ABEpsilon));
+                        Count = VectorAdd(Count, VectorBitwiseAnd(Similar, One));
+                    }
+                    Tile.Homogeneity[Direction][I] = Count;
+                }
+            }
+        }
+
+        // 5. Per pixel and image, take the direction with more homogeneous 3x3 neighbours,
+        //    or the average on a tie
+        for (int32 CY = 0; CY < CoreSize.Y; ++CY)
+        {
+            const int32 TY = CY + AHD_APRON;
+            const int32 OutOffset = (Origin.Y + CY) * ImageWidth + Origin.X;
+
+            for (int32 CX = 0; CX < CoreSize.X; ++CX)
+            {
+                const int32 I = TY * TW + CX + AHD_APRON;
+
+                auto Sum3x3 = [&](const TArray<VectorRegister4Float>& Map)
+                {
+                    const VectorRegister4Float* Up = Map.GetData() + I - TW;
+                    const VectorRegister4Float* Mid = Map.GetData() + I;
+                    const VectorRegister4Float* Down = Map.GetData() + I + TW;
+                    return VectorAdd(VectorAdd(
+                        VectorAdd(VectorAdd(Up[-1], Up[0]), Up[1]),
+                        VectorAdd(VectorAdd(Mid[-1], Mid[0]), Mid[1])),
+                        VectorAdd(VectorAdd(Down[-1], Down[0]), Down[1]));
+                };
+
+                const VectorRegister4Float Score0 = Sum3x3(Tile.Homogeneity[0]);
+                const VectorRegister4Float Score1 = Sum3x3(Tile.Homogeneity[1]);
+                const VectorRegister4Float Use0 = VectorCompareGT(Score0, Score1);
+                const VectorRegister4Float Use1 = VectorCompareGT(Score1, Score0);
+
+                auto Choose = [&](const TArray<VectorRegister4Float>* Planes)
+                {
+                    const VectorRegister4Float Average = Round255(VectorMultiply(VectorAdd(Planes[0][I], Planes[1][I]), Half));
+                    FColor Result;
+                    VectorStoreByte4(VectorSelect(Use0, Planes[0][I], VectorSelect(Use1, Planes[1][I], Average)), &Result);
+                    return Result;
+                };
+
+                StorePlanePixel(Choose(Tile.Red), Choose(Tile.Green), Choose(Tile.Blue), Out1 + OutOffset, Out2 + OutOffset, Out3 + OutOffset, CX);
+            }
+        }
+    }
+}
+
+bool FMinraDemosaicCPU::IsCPUOnly(EMinraDemosaicAlgorithm Algorithm)
+{
+    switch (Algorithm)
+    {
+        case EMinraDemosaicAlgorithm::AGCRD:
+        case EMinraDemosaicAlgorithm::FrequencyAware:
+        case EMinraDemosaicAlgorithm::SmoothHue:
+        case EMinraDemosaicAlgorithm::AHD:
+        case EMinraDemosaicAlgorithm::Auto:
+            return true;
+        default:
+            return false;
+    }
+}
+
+FIntPoint FMinraDemosaicCPU::GetOutputSize(int32 Width, int32 Height, EMinraDemosaicAlgorithm Algorithm)
+{
+    if (Algorithm == EMinraDemosaicAlgorithm::Superpixel)
+    {
+        return FIntPoint((Width + 1) / 2, (Height + 1) / 2);
+    }
+
+    return FIntPoint(Width, Height);
+}
+
+bool FMinraDemosaicCPU::Demosaic(
+    const TArray<FColor>& Combined,
+    int32 Width,
+    int32 Height,
+    EMinraDemosaicAlgorithm Algorithm,
+    EMinraCFAPattern Pattern,
+    TArray<FColor>& OutImage1,
+    TArray<FColor>& OutImage2,
+    TArray<FColor>& OutImage3)
+{
+    using namespace MinraDemosaicCPU;
+
+    if (Width <= 0 || Height <= 0 || Combined.Num() != Width * Height)
+    {
+        UE_LOG(LogTemp, Error, TEXT("Minra Mosaique: Invalid demosaic input (%dx%d, %d pixels)."), Width, Height, Combined.Num());
+        return false;
+    }
+
+    const FIntPoint Phase = GetCFAPhase(Pattern);
+
+    if (Algorithm == EMinraDemosaicAlgorithm::Superpixel)
+    {
+        const FIntPoint OutSize = GetOutputSize(Width, Height, Algorithm);
+
+        OutImage1.SetNumUninitialized(OutSize.X * OutSize.Y);
+        OutImage2.SetNumUninitialized(OutSize.X * OutSize.Y);
+        OutImage3.SetNumUninitialized(OutSize.X * OutSize.Y);
+
+        const FColor* Pixels = Combined.GetData();
+        FColor* Out1 = OutImage1.GetData();
+        FColor* Out2 = OutImage2.GetData();
+        FColor* Out3 = OutImage3.GetData();
+
+        ParallelFor(OutSize.Y, [&](int32 Y)
+        {
+            const int32 RowOffset = Y * OutSize.X;
+            DemosaicRowSuperpixel(Pixels, Width, Height, Y, Phase, OutSize.X, Out1 + RowOffset, Out2 + RowOffset, Out3 + RowOffset);
+        });
+
+        return true;
+    }
+
+    if (Algorithm == EMinraDemosaicAlgorithm::NearestNeighbor)
+    {
+        OutImage1.SetNumUninitialized(Width * Height);
+        OutImage2.SetNumUninitialized(Width * Height);
+        OutImage3.SetNumUninitialized(Width * Height);
+
+        const FColor* Pixels = Combined.GetData();
+        FColor* Out1 = OutImage1.GetData();
+        FColor* Out2 = OutImage2.GetData();
+        FColor* Out3 = OutImage3.GetData();
+        const int32 QuadHeight = (Height + 1) / 2;
+
+        ParallelFor(QuadHeight, [&](int32 Y)
+        {
+            TArray<FColor> Scratch;
+            Scratch.SetNumUninitialized(((Width + 1) / 2) * 3);
+            DemosaicRowNearest(Pixels, Width, Height, Y, Phase, Scratch.GetData(), Out1, Out2, Out3);
+        });
+
+        return true;
+    }
+
+    if (Algorithm == EMinraDemosaicAlgorithm::Auto)
+    {
+        TArray<uint8> Selection;
+        FIntPoint Tiles(0, 0);
+        return DemosaicAuto(Combined, Width, Height, Phase, Selection, Tiles, OutImage1, OutImage2, OutImage3);
+    }
+
+    if (Algorithm == EMinraDemosaicAlgorithm::AHD)
+    {
+        return DemosaicAHD(Combined, Width, Height, Phase, OutImage1, OutImage2, OutImage3);
+    }
+
+    if (IsCPUOnly(Algorithm))
+    {
+        return DemosaicAdaptive(Combined, Width, Height, Algorithm, Phase, OutImage1, OutImage2, OutImage3);
+    }
+
+    const bool bMHC = Algorithm == EMinraDemosaicAlgorithm::MalvarHeCutler;
+
+    TArray<int32> XTable;
+    TArray<int32> YTable;
+
+    if (bMHC)
+    {
+        BuildAxisTable(Width, 2, MirrorIndex, XTable);
+        BuildAxisTable(Height, 2, MirrorIndex, YTable);
+    }
+    else
+    {
+        BuildAxisTable(Width, 1, ClampIndex, XTable);
+        BuildAxisTable(Height, 1, ClampIndex, YTable);
+    }
+
+    OutImage1.SetNumUninitialized(Width * Height);
+    OutImage2.SetNumUninitialized(Width * Height);
+    OutImage3.SetNumUninitialized(Width * Height);
+
+    const FColor* Pixels = Combined.GetData();
+    FColor* Out1 = OutImage1.GetData();
+    FColor* Out2 = OutImage2.GetData();
+    FColor* Out3 = OutImage3.GetData();
+
+    ParallelFor(Height, [&](int32 Y)
+    {
+        const int32 RowOffset = Y * Width;
+
+        if (bMHC)
+        {
+            DemosaicRowMHC(Pixels, Width, Y, 0, Width, Phase, XTable, YTable, Out1 + RowOffset, Out2 + RowOffset, Out3 + RowOffset);
+        }
+        else
+        {
+            DemosaicRowBilinear(Pixels, Width, Y, 0, Width, Phase, XTable, YTable, Out1 + RowOffset, Out2 + RowOffset, Out3 + RowOffset);
+        }
+    });
+
+    return true;
+}
+
+bool FMinraDemosaicCPU::ComputeAutoSelection(
+    const TArray<FColor>& Combined,
+    int32 Width,
+    int32 Height,
+    TArray<uint8>& OutSelection,
+    FIntPoint& OutTiles)
+{
+    using namespace MinraDemosaicCPU;
+
+    if (Width <= 0 || Height <= 0 || Combined.Num() != Width * Height)
+    {
+        UE_LOG(LogTemp, Error, TEXT("Minra Mosaique: Invalid demosaic input (%dx%d, %d pixels)."), Width, Height, Combined.Num());
+        return false;
+    }
+
+    OutTiles = FIntPoint(FMath::DivideAndRoundUp(Width, AUTO_TILE_SIZE), FMath::DivideAndRoundUp(Height, AUTO_TILE_SIZE));
+    OutSelection.SetNumUninitialized(OutTiles.X * OutTiles.Y);
+
+    const FColor* Pixels = Combined.GetData();
+
+    ParallelFor(OutTiles.Y, [&](int32 TileY)
+    {
+        const int32 Y0 = TileY * AUTO_TILE_SIZE;
+        const int32 Y1 = FMath::Min(Y0 + AUTO_TILE_SIZE, Height);
+
+        for (int32 TileX = 0; TileX < OutTiles.X; ++TileX)
+        {
+            const int32 X0 = TileX * AUTO_TILE_SIZE;
+            const int32 X1 = FMath::Min(X0 + AUTO_TILE_SIZE, Width);
+            const float Energy = TileGradientEnergy(Pixels, Width, Height, X0, Y0, X1, Y1);
+            OutSelection[TileY * OutTiles.X + TileX] = Energy > AUTO_MHC_THRESHOLD ? 1 : 0;
+        }
+    });
+
+    return true;
+}
+
+bool FMinraDemosaicCPU::DemosaicAutoWithSelection(
+    const TArray<FColor>& Combined,
+    int32 Width,
+    int32 Height,
+    EMinraCFAPattern Pattern,
+    TArray<uint8>& OutSelection,
+    FIntPoint& OutTiles,
+    TArray<FColor>& OutImage1,
+    TArray<FColor>& OutImage2,
+    TArray<FColor>& OutImage3)
+{
+    using namespace MinraDemosaicCPU;
+
+    return DemosaicAuto(Combined, Width, Height, GetCFAPhase(Pattern), OutSelection, OutTiles, OutImage1, OutImage2, OutImage3);
+}
+
+bool FMinraDemosaicCPU::DemosaicAuto(
+    const TArray<FColor>& Combined,
+    int32 Width,
+    int32 Height,
+    FIntPoint Phase,
+    TArray<uint8>& OutSelection,
+    FIntPoint& OutTiles,
+    TArray<FColor>& OutImage1,
+    TArray<FColor>& OutImage2,
+    TArray<FColor>& OutImage3)
+{
+    using namespace MinraDemosaicCPU;
+
+    // Validates the input for both entry points
+    if (!ComputeAutoSelection(Combined, Width, Height, OutSelection, OutTiles))
+    {
+        return false;
+    }
+    const TArray<uint8>& Selection = OutSelection;
+    const FIntPoint Tiles = OutTiles;
+
+    // Each kernel keeps its own boundary rule, so a tile gives the same pixels as a full-image run
+    TArray<int32> BilinearXTable;
+    TArray<int32> BilinearYTable;
+    TArray<int32> MHCXTable;
+    TArray<int32> MHCYTable;
+    BuildAxisTable(Width, 1, ClampIndex, BilinearXTable);
+    BuildAxisTable(Height, 1, ClampIndex, BilinearYTable);
+    BuildAxisTable(Width, 2, MirrorIndex, MHCXTable);
+    BuildAxisTable(Height, 2, MirrorIndex, MHCYTable);
+
+    OutImage1.SetNumUninitialized(Width * Height);
+    OutImage2.SetNumUninitialized(Width * Height);
+    OutImage3.SetNumUninitialized(Width * Height);
+
+    const FColor* Pixels = Combined.GetData();
+    FColor* Out1 = OutImage1.GetData();
+    FColor* Out2 = OutImage2.GetData();
+    FColor* Out3 = OutImage3.GetData();
+
+    ParallelFor(Height, [&](int32 Y)
+    {
+        const int32 RowOffset = Y * Width;
+        const uint8* TileRow = Selection.GetData() + (Y / AUTO_TILE_SIZE) * Tiles.X;
+
+        for (int32 TileX = 0; TileX < Tiles.X; ++TileX)
+        {
+            const int32 X0 = TileX * AUTO_TILE_SIZE;
+            const int32 X1 = FMath::Min(X0 + AUTO_TILE_SIZE, Width);
+
+            if (TileRow[TileX])
+            {
+                DemosaicRowMHC(Pixels, Width, Y, X0, X1, Phase, MHCXTable, MHCYTable, Out1 + RowOffset, Out2 + RowOffset, Out3 + RowOffset);
+            }
+            else
+            {
+                DemosaicRowBilinear(Pixels, Width, Y, X0, X1, Phase, BilinearXTable, BilinearYTable, Out1 + RowOffset, Out2 + RowOffset, Out3 + RowOffset);
+            }
+        }
+    });
+
+    return true;
+}
+
+bool FMinraDemosaicCPU::DemosaicAdaptive(
+    const TArray<FColor>& Combined,
+    int32 Width,
+    int32 Height,
+    EMinraDemosaicAlgorithm Algorithm,
+    FIntPoint Phase,
+    TArray<FColor>& OutImage1,
+    TArray<FColor>& OutImage2,
+    TArray<FColor>& OutImage3)
+{
+    using namespace MinraDemosaicCPU;
+
+    // Same reflection as the JS getPixel
+    TArray<int32> XTable;
+    TArray<int32> YTable;
+    BuildAxisTable(Width, 2, MirrorIndex, XTable);
+    BuildAxisTable(Height, 2, MirrorIndex, YTable);
+
+    // Per-site planes; every stage reads neighbours of the previous one, so each is a full pass
+    TArray<FColor> Green;
+    TArray<FColor> Red;
+    TArray<FColor> Blue;
+    Green.SetNumUninitialized(Width * Height);
+    Red.SetNumUninitialized(Width * Height);
+    Blue.SetNumUninitialized(Width * Height);
+
+    OutImage1.SetNumUninitialized(Width * Height);
+    OutImage2.SetNumUninitialized(Width * Height);
+    OutImage3.SetNumUninitialized(Width * Height);
+
+    const FColor* Pixels = Combined.GetData();
+    FColor* Out1 = OutImage1.GetData();
+    FColor* Out2 = OutImage2.GetData();
+    FColor* Out3 = OutImage3.GetData();
+
+    ParallelFor(Height, [&](int32 Y)
+    {
+        DemosaicRowAdaptiveGreen(Pixels, Width, Y, Phase, Algorithm, XTable, YTable, Green.GetData() + Y * Width);
+    });
+
+    const bool bRatio = Algorithm == EMinraDemosaicAlgorithm::SmoothHue;
+
+    ParallelFor(Height, [&](int32 Y)
+    {
+        const int32 RowOffset = Y * Width;
+        DemosaicRowChroma(Pixels, Green.GetData(), Width, Y, Phase, bRatio, XTable, YTable, Red.GetData() + RowOffset, Blue.GetData() + RowOffset);
+    });
+
+    if (Algorithm == EMinraDemosaicAlgorithm::AGCRD)
+    {
+        ParallelFor(Height, [&](int32 Y)
+        {
+            const int32 RowOffset = Y * Width;
+            DemosaicRowSuppress(Red.GetData(), Green.GetData(), Blue.GetData(), Width, Height, Y, Out1 + RowOffset, Out2 + RowOffset, Out3 + RowOffset);
+        });
+    }
+    else
+    {
+        ParallelFor(Height, [&](int32 Y)
+        {
+            const int32 RowOffset = Y * Width;
+            for (int32 X = 0; X < Width; ++X)
+            {
+                StorePlanePixel(Red[RowOffset + X], Green[RowOffset + X], Blue[RowOffset + X], Out1 + RowOffset, Out2 + RowOffset, Out3 + RowOffset, X);
+            }
+        });
+    }
+
+    return true;
+}
+
+bool FMinraDemosaicCPU::DemosaicAHD(
+    const TArray<FColor>& Combined,
+    int32 Width,
+    int32 Height,
+    FIntPoint Phase,
+    TArray<FColor>& OutImage1,
+    TArray<FColor>& OutImage2,
+    TArray<FColor>& OutImage3)
+{
+    using namespace MinraDemosaicCPU;
+
+    OutImage1.SetNumUninitialized(Width * Height);
+    OutImage2.SetNumUninitialized(Width * Height);
+    OutImage3.SetNumUninitialized(Width * Height);
+
+    const FColor* Pixels = Combined.GetData();
+    FColor* Out1 = OutImage1.GetData();
+    FColor* Out2 = OutImage2.GetData();
+    FColor* Out3 = OutImage3.GetData();
+
+    const int32 TilesX = FMath::DivideAndRoundUp(Width, AHD_TILE_SIZE);
+    const int32 TilesY = FMath::DivideAndRoundUp(Height, AHD_TILE_SIZE);
+
+    // One scratch tile per worker rather than per tile
+    TArray<FAHDTile> Scratch;
+    ParallelForWithTaskContext(Scratch, TilesX * TilesY, [&](FAHDTile& Tile, int32 TileIndex)
+    {
+        const FIntPoint Origin((TileIndex % TilesX) * AHD_TILE_SIZE, (TileIndex / TilesX) * AHD_TILE_SIZE);
+        const FIntPoint CoreSize(FMath::Min(AHD_TILE_SIZE, Width - Origin.X), FMath::Min(AHD_TILE_SIZE, Height - Origin.Y));
+
+        DemosaicTileAHD(Pixels, Width, Height, Phase, Origin, CoreSize, Tile, Out1, Out2, Out3);
+    });
+
+    return true;
+}
+
+int64 FMinraDemosaicCPU::GetAHDScratchBytes()
+{
+    using namespace MinraDemosaicCPU;
+
+    // FAHDTile at full tile size: the CFA, seven planes per direction and the column table
+    const int64 MaxSize = AHD_TILE_SIZE + 2 * AHD_APRON;
+    return MaxSize * MaxSize * 15 * sizeof(VectorRegister4Float) + MaxSize * sizeof(int32);
+}
+
+bool FMinraDemosaicCPU::ReadTexturePixels(
+    UTexture2D* Texture,
+    TArray<FColor>& OutPixels,
+    int32& OutWidth,
+    int32& OutHeight)
+{
+    if (!Texture)
+    {
+        return false;
+    }
+
+#if WITH_EDITORONLY_DATA
+    // Prefer the uncompressed source data
+    if (Texture->Source.IsValid() && Texture->Source.GetFormat() == TSF_BGRA8)
+    {
+        TArray64<uint8> MipData;
+        if (Texture->Source.GetMipData(MipData, 0))
+        {
+            OutWidth = Texture->Source.GetSizeX();
+            OutHeight = Texture->Source.GetSizeY();
+            OutPixels.SetNumUninitialized(OutWidth * OutHeight);
+            FMemory::Memcpy(OutPixels.GetData(), MipData.GetData(), OutPixels.Num() * sizeof(FColor));
+            return true;
+        }
+    }
+#endif
+
+    // Fall back to uncompressed platform data
+    FTexturePlatformData* PlatformData = Texture->GetPlatformData();
+    if (!PlatformData || PlatformData->Mips.Num() == 0 || PlatformData->PixelFormat != PF_B8G8R8A8)
+    {
+        return false;
+    }
+
+    OutWidth = Texture->GetSizeX();
+    OutHeight = Texture->GetSizeY();
+
+    FTexture2DMipMap& Mip = PlatformData->Mips[0];
+    const void* Data = Mip.BulkData.LockReadOnly();
+
+    if (!Data)
+    {
+        return false;
+    }
+
+    OutPixels.SetNumUninitialized(OutWidth * OutHeight);
+    FMemory::Memcpy(OutPixels.GetData(), Data, OutPixels.Num() * sizeof(FColor));
+    Mip.BulkData.Unlock();
+
+    return true;
+}
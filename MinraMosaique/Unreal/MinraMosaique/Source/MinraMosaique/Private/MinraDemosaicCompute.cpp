@@ -0,0 +1,154 @@
+// Copyright Minra. All Rights Reserved.
+
+#include "MinraDemosaicCompute.h"
+#include "MinraDemosaicCPU.h"
+#include "Engine/Texture2D.h"
+#include "Engine/TextureRenderTarget2D.h"
+#include "GlobalShader.h"
+#include "ShaderParameterStruct.h"
+#include "RenderGraphBuilder.h"
+#include "RenderGraphUtils.h"
+#include "RenderTargetPool.h"
+#include "RenderingThread.h"
+#include "TextureResource.h"
+#include "Misc/App.h"
+#include "Async/Async.h"
+
+/**
+ * Compute shader demosaicing all three CFAs of a combined texture.
+ */
+class FMinraDemosaicCS : public FGlobalShader
+{
+public:
+    DECLARE_GLOBAL_SHADER(FMinraDemosaicCS);
+    SHADER_USE_PARAMETER_STRUCT(FMinraDemosaicCS, FGlobalShader);
+
+    static constexpr int32 ThreadGroupSize = 8;
+
+    // Values match EMinraDemosaicAlgorithm / EMinraCFAPattern and MinraDemosaic.ush.
+    // Both are compile-time, so each permutation is a straight-line kernel.
+    class FAlgorithmDim : SHADER_PERMUTATION_INT("MINRA_DEMOSAIC_ALGORITHM", 4);
+    class FCFAPatternDim : SHADER_PERMUTATION_INT("MINRA_CFA_PATTERN", 4);
+    using FPermutationDomain = TShaderPermutationDomain<FAlgorithmDim, FCFAPatternDim>;
+
+    BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+        SHADER_PARAMETER_RDG_TEXTURE(Texture2D, CombinedTexture)
+        SHADER_PARAMETER_SAMPLER(SamplerState, CombinedSampler)
+        SHADER_PARAMETER(FIntPoint, TextureSize)
+        SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float4>, OutImage1)
+        SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float4>, OutImage2)
+        SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float4>, OutImage3)
+    END_SHADER_PARAMETER_STRUCT()
+
+    static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+    {
+        return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+    }
+
+    static void ModifyCompilationEnvironment(const FGlobalShaderPermutationParameters& Parameters, FShaderCompilerEnvironment& OutEnvironment)
+    {
+        FGlobalShader::ModifyCompilationEnvironment(Parameters, OutEnvironment);
+        OutEnvironment.SetDefine(TEXT("THREADGROUP_SIZE"), ThreadGroupSize);
+    }
+};
+
+IMPLEMENT_GLOBAL_SHADER(FMinraDemosaicCS, "/Plugin/MinraMosaique/MinraDemosaicCS.usf", "MainCS", SF_Compute);
+
+bool FMinraDemosaicCompute::IsSupported()
+{
+    return FApp::CanEverRender() && GMaxRHIFeatureLevel >= ERHIFeatureLevel::SM5;
+}
+
+bool FMinraDemosaicCompute::Dispatch(
+    UTexture2D* CombinedTexture,
+    EMinraDemosaicAlgorithm Algorithm,
+    EMinraCFAPattern Pattern,
+    UTextureRenderTarget2D* const Targets[NUM_OUTPUTS],
+    TFunction<void(bool bRan)> OnCompleted)
+{
+    check(IsInGameThread());
+
+    if (!IsSupported() || !CombinedTexture || !CombinedTexture->GetResource())
+    {
+        return false;
+    }
+
+    if (FMinraDemosaicCPU::IsCPUOnly(Algorithm))
+    {
+        UE_LOG(LogTemp, Error, TEXT("Minra Mosaique: %s has no compute shader; use FMinraDemosaicCPU."), *StaticEnum<EMinraDemosaicAlgorithm>()->GetNameStringByValue(static_cast<int64>(Algorithm)));
+        return false;
+    }
+
+    const FIntPoint Size(CombinedTexture->GetSizeX(), CombinedTexture->GetSizeY());
+    const FIntPoint OutputSize = FMinraDemosaicCPU::GetOutputSize(Size.X, Size.Y, Algorithm);
+    FTextureResource* SourceResource = CombinedTexture->GetResource();
+
+    FTextureRenderTargetResource* TargetResources[NUM_OUTPUTS];
+    for (int32 Index = 0; Index < NUM_OUTPUTS; ++Index)
+    {
+        if (!Targets[Index] || Targets[Index]->SizeX != OutputSize.X || Targets[Index]->SizeY != OutputSize.Y || !Targets[Index]->bCanCreateUAV)
+        {
+            UE_LOG(LogTemp, Error, TEXT("Minra Mosaique: Demosaic target %d is missing, mis-sized or not UAV-capable."), Index + 1);
+            return false;
+        }
+
+        TargetResources[Index] = Targets[Index]->GameThread_GetRenderTargetResource();
+        if (!TargetResources[Index])
+        {
+            return false;
+        }
+    }
+
+    const int32 AlgorithmIndex = static_cast<int32>(Algorithm);
+    const int32 PatternIndex = static_cast<int32>(Pattern);
+
+    ENQUEUE_RENDER_COMMAND(MinraDemosaic)(
+        [SourceResource, TargetResources, Size, OutputSize, AlgorithmIndex, PatternIndex, OnCompleted = MoveTemp(OnCompleted)](FRHICommandListImmediate& RHICmdList) mutable
+        {
+            auto Complete = [&OnCompleted](bool bRan)
+            {
+                if (OnCompleted)
+                {
+                    AsyncTask(ENamedThreads::GameThread, [OnCompleted = MoveTemp(OnCompleted), bRan]() { OnCompleted(bRan); });
+                }
+            };
+
+            // The texture may not have been streamed in or initialised yet
+            if (!SourceResource->TextureRHI)
+            {
+                Complete(false);
+                return;
+            }
+
+            FRDGBuilder GraphBuilder(RHICmdList);
+
+            FMinraDemosaicCS::FParameters* Parameters = GraphBuilder.AllocParameters<FMinraDemosaicCS::FParameters>();
+            Parameters->CombinedTexture = GraphBuilder.RegisterExternalTexture(CreateRenderTarget(SourceResource->TextureRHI, TEXT("MinraCombined")));
+            Parameters->CombinedSampler = TStaticSamplerState<SF_Point, AM_Clamp, AM_Clamp, AM_Clamp>::GetRHI();
+            Parameters->TextureSize = Size;
+
+            FRDGTextureUAVRef* Outputs[NUM_OUTPUTS] = { &Parameters->OutImage1, &Parameters->OutImage2, &Parameters->OutImage3 };
+            for (int32 Index = 0; Index < NUM_OUTPUTS; ++Index)
+            {
+                FRDGTextureRef Target = GraphBuilder.RegisterExternalTexture(CreateRenderTarget(TargetResources[Index]->GetRenderTargetTexture(), TEXT("MinraDemosaicOutput")));
+                *Outputs[Index] = GraphBuilder.CreateUAV(Target);
+            }
+
+            FMinraDemosaicCS::FPermutationDomain Permutation;
+            Permutation.Set<FMinraDemosaicCS::FAlgorithmDim>(AlgorithmIndex);
+            Permutation.Set<FMinraDemosaicCS::FCFAPatternDim>(PatternIndex);
+            TShaderMapRef<FMinraDemosaicCS> ComputeShader(GetGlobalShaderMap(GMaxRHIFeatureLevel), Permutation);
+
+            FComputeShaderUtils::AddPass(
+                GraphBuilder,
+                RDG_EVENT_NAME("MinraDemosaic %dx%d", Size.X, Size.Y),
+                ComputeShader,
+                Parameters,
+                FComputeShaderUtils::GetGroupCount(OutputSize, FMinraDemosaicCS::ThreadGroupSize));
+
+            GraphBuilder.Execute();
+            Complete(true);
+        });
+
+    return true;
+}
@@ -1,15 +1,59 @@
 // Copyright Minra. All Rights Reserved.
 
 #include "MinraDemosaicTexture.h"
+#include "MinraDemosaicCompute.h"
+#include "MinraDemosaicCPU.h"
+#include "MinraCookReport.h"
+#include "MinraCookBake.h"
 #include "Engine/Texture2D.h"
+#include "Engine/Texture2DArray.h"
+#include "Engine/TextureRenderTarget2D.h"
+#include "Async/Async.h"
+#include "HAL/IConsoleManager.h"
+#include "UObject/UObjectIterator.h"
+#include "UObject/ObjectSaveContext.h"
+
+#if WITH_EDITOR
+#include "AssetRegistry/AssetRegistryModule.h"
+#endif
+
+static TAutoConsoleVariable<int32> CVarMinraForceCPUDemosaic(
+    TEXT("r.MinraMosaique.ForceCPUDemosaic"),
+    0,
+    TEXT("1: build UMinraDemosaicTexture runtime outputs on the CPU even when the GPU pass is available."),
+    ECVF_Default);
 
 UMinraDemosaicTexture::UMinraDemosaicTexture()
     : CombinedTexture(nullptr)
     , Algorithm(EMinraDemosaicAlgorithm::Bilinear)
+    , CFAPattern(EMinraCFAPattern::RGGB)
+    , bDemosaicAtRuntime(true)
     , BakedImage1(nullptr)
     , BakedImage2(nullptr)
     , BakedImage3(nullptr)
+    , BakedImageArray(nullptr)
+    , RuntimeOutputs{ nullptr, nullptr, nullptr }
+    , bRuntimeOutputsValid(false)
+    , bRuntimeOutputsPending(false)
+    , RuntimeOutputsSerial(0)
+{
+#if WITH_EDITORONLY_DATA
+    CookedImages[0] = CookedImages[1] = CookedImages[2] = nullptr;
+    CookedImageArray = nullptr;
+#endif
+}
+
+void UMinraDemosaicTexture::PostInitProperties()
 {
+#if WITH_EDITORONLY_DATA
+    // New assets bake on cook; loaded ones keep their saved value, or the class default (off)
+    if (!HasAnyFlags(RF_ClassDefaultObject | RF_NeedLoad | RF_WasLoaded))
+    {
+        bBakeOnCook = true;
+    }
+#endif
+
+    Super::PostInitProperties();
 }
 
 bool UMinraDemosaicTexture::IsValid() const
@@ -26,19 +70,282 @@ bool UMinraDemosaicTexture::HasBakedTextures() const
            BakedImage3 != nullptr;
 }
 
+bool UMinraDemosaicTexture::HasBakedTextureArray() const
+{
+    return BakedImageArray != nullptr;
+}
+
+UTexture2DArray* UMinraDemosaicTexture::GetImageArray() const
+{
+    return BakedImageArray;
+}
+
 UTexture2D* UMinraDemosaicTexture::GetImage1() const
 {
-    return BakedImage1 != nullptr ? BakedImage1 : CombinedTexture;
+    return BakedImage1 != nullptr ? BakedImage1 : GetUnbakedImage();
 }
 
 UTexture2D* UMinraDemosaicTexture::GetImage2() const
 {
-    return BakedImage2 != nullptr ? BakedImage2 : CombinedTexture;
+    return BakedImage2 != nullptr ? BakedImage2 : GetUnbakedImage();
 }
 
 UTexture2D* UMinraDemosaicTexture::GetImage3() const
 {
-    return BakedImage3 != nullptr ? BakedImage3 : CombinedTexture;
+    return BakedImage3 != nullptr ? BakedImage3 : GetUnbakedImage();
+}
+
+UTexture2D* UMinraDemosaicTexture::GetUnbakedImage() const
+{
+    // A slice cannot be returned as a UTexture2D, and cooked array assets have no combined texture
+    ensureMsgf(BakedImageArray == nullptr, TEXT("Minra Mosaique: %s is baked to a texture array; use GetImageArray or GetOutputTexture."), *GetName());
+    return CombinedTexture;
+}
+
+UTexture* UMinraDemosaicTexture::GetOutputTexture(int32 ImageNumber)
+{
+    if (ImageNumber < 1 || ImageNumber > 3)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("Minra Mosaique: Invalid image number %d, expected 1-3."), ImageNumber);
+        return nullptr;
+    }
+
+    UTexture2D* const Baked[3] = { BakedImage1, BakedImage2, BakedImage3 };
+    const int32 Index = ImageNumber - 1;
+
+    if (Baked[Index] != nullptr)
+    {
+        return Baked[Index];
+    }
+
+    // Image N is slice N-1
+    if (BakedImageArray != nullptr)
+    {
+        return BakedImageArray;
+    }
+
+    if (bDemosaicAtRuntime && IsValid())
+    {
+        if (!HasRuntimeOutputs() && !IsRuntimeOutputUpdatePending())
+        {
+            UpdateRuntimeOutputs();
+        }
+
+        if (bRuntimeOutputsValid || IsRuntimeOutputUpdatePending())
+        {
+            return RuntimeOutputs[Index];
+        }
+    }
+
+    return CombinedTexture;
+}
+
+bool UMinraDemosaicTexture::HasRuntimeOutputs() const
+{
+    return bRuntimeOutputsValid &&
+           RuntimeOutputs[0] != nullptr &&
+           RuntimeOutputs[1] != nullptr &&
+           RuntimeOutputs[2] != nullptr &&
+           RuntimeOutputKey == MakeRuntimeOutputKey();
+}
+
+bool UMinraDemosaicTexture::IsRuntimeOutputUpdatePending() const
+{
+    return bRuntimeOutputsPending && RuntimeOutputKey == MakeRuntimeOutputKey();
+}
+
+void UMinraDemosaicTexture::ReleaseRuntimeOutputs()
+{
+    for (UTexture*& Output : RuntimeOutputs)
+    {
+        if (UTextureRenderTarget2D* Target = Cast<UTextureRenderTarget2D>(Output))
+        {
+            // Keep the object so materials holding it pick up the rebuilt resource
+            Target->ReleaseResource();
+        }
+        else
+        {
+            Output = nullptr;
+        }
+    }
+
+    bRuntimeOutputsValid = false;
+    bRuntimeOutputsPending = false;
+    ++RuntimeOutputsSerial;
+}
+
+void UMinraDemosaicTexture::ReleaseAllRuntimeOutputs()
+{
+    // The trim delegate can fire off the game thread; object iteration must not
+    if (!IsInGameThread())
+    {
+        AsyncTask(ENamedThreads::GameThread, []() { ReleaseAllRuntimeOutputs(); });
+        return;
+    }
+
+    int32 NumReleased = 0;
+    for (TObjectIterator<UMinraDemosaicTexture> It; It; ++It)
+    {
+        if (It->bRuntimeOutputsValid || It->bRuntimeOutputsPending)
+        {
+            It->ReleaseRuntimeOutputs();
+            ++NumReleased;
+        }
+    }
+
+    if (NumReleased > 0)
+    {
+        UE_LOG(LogTemp, Log, TEXT("Minra Mosaique: Released runtime outputs of %d textures on memory trim."), NumReleased);
+    }
+}
+
+FMinraRuntimeOutputKey UMinraDemosaicTexture::MakeRuntimeOutputKey() const
+{
+    FMinraRuntimeOutputKey Key;
+    Key.Source = CombinedTexture;
+    Key.Algorithm = Algorithm;
+    Key.Pattern = CFAPattern;
+
+    if (CombinedTexture)
+    {
+        Key.Size = FIntPoint(CombinedTexture->GetSizeX(), CombinedTexture->GetSizeY());
+#if WITH_EDITORONLY_DATA
+        Key.SourceId = CombinedTexture->Source.GetId();
+#endif
+    }
+
+    return Key;
+}
+
+bool UMinraDemosaicTexture::UpdateRuntimeOutputs()
+{
+    bRuntimeOutputsValid = false;
+    bRuntimeOutputsPending = false;
+    ++RuntimeOutputsSerial;
+
+    if (!IsValid())
+    {
+        return false;
+    }
+
+    // Algorithms without a shader always take the CPU path
+    const bool bUseGPU = FMinraDemosaicCompute::IsSupported() && !FMinraDemosaicCPU::IsCPUOnly(Algorithm) &&
+        CVarMinraForceCPUDemosaic.GetValueOnGameThread() == 0;
+    const bool bSuccess = bUseGPU ? UpdateRuntimeOutputsGPU() : UpdateRuntimeOutputsCPU();
+
+    if (!bSuccess)
+    {
+        UE_LOG(LogTemp, Error, TEXT("Minra Mosaique: Runtime demosaic of %s failed."), *GetName());
+        return false;
+    }
+
+    RuntimeOutputKey = MakeRuntimeOutputKey();
+
+    // The GPU path becomes valid in its completion, once the dispatch has actually run
+    if (bUseGPU)
+    {
+        bRuntimeOutputsPending = true;
+        return true;
+    }
+
+    bRuntimeOutputsValid = true;
+
+    UE_LOG(LogTemp, Log, TEXT("Minra Mosaique: Demosaiced %s at runtime (CPU)."), *GetName());
+    return true;
+}
+
+bool UMinraDemosaicTexture::UpdateRuntimeOutputsGPU()
+{
+    const FIntPoint OutputSize = FMinraDemosaicCPU::GetOutputSize(CombinedTexture->GetSizeX(), CombinedTexture->GetSizeY(), Algorithm);
+
+    UTextureRenderTarget2D* Targets[FMinraDemosaicCompute::NUM_OUTPUTS];
+
+    for (int32 Index = 0; Index < FMinraDemosaicCompute::NUM_OUTPUTS; ++Index)
+    {
+        UTextureRenderTarget2D* Target = Cast<UTextureRenderTarget2D>(RuntimeOutputs[Index]);
+        if (!Target)
+        {
+            Target = NewObject<UTextureRenderTarget2D>(this, NAME_None, RF_Transient);
+            Target->bCanCreateUAV = true;
+            Target->ClearColor = FLinearColor::Black;
+            RuntimeOutputs[Index] = Target;
+        }
+
+        // Stores the demosaiced values as-is, like the combined texture and the material node.
+        // Also recreates resources released on memory trim.
+        Target->InitCustomFormat(OutputSize.X, OutputSize.Y, PF_R8G8B8A8, true);
+        Targets[Index] = Target;
+    }
+
+    TWeakObjectPtr<UMinraDemosaicTexture> WeakThis(this);
+    const uint32 Serial = RuntimeOutputsSerial;
+
+    return FMinraDemosaicCompute::Dispatch(CombinedTexture, Algorithm, CFAPattern, Targets, [WeakThis, Serial](bool bRan)
+    {
+        UMinraDemosaicTexture* This = WeakThis.Get();
+        if (!This || This->RuntimeOutputsSerial != Serial)
+        {
+            return;
+        }
+
+        This->bRuntimeOutputsPending = false;
+        This->bRuntimeOutputsValid = bRan;
+
+        if (bRan)
+        {
+            UE_LOG(LogTemp, Log, TEXT("Minra Mosaique: Demosaiced %s at runtime (GPU)."), *This->GetName());
+        }
+        else
+        {
+            UE_LOG(LogTemp, Warning, TEXT("Minra Mosaique: Runtime demosaic of %s was skipped, the combined texture has no GPU resource yet; retrying on next use."), *This->GetName());
+        }
+    });
+}
+
+bool UMinraDemosaicTexture::UpdateRuntimeOutputsCPU()
+{
+    TArray<FColor> Combined;
+    int32 Width = 0;
+    int32 Height = 0;
+
+    if (!FMinraDemosaicCPU::ReadTexturePixels(CombinedTexture, Combined, Width, Height))
+    {
+        UE_LOG(LogTemp, Error, TEXT("Minra Mosaique: %s has no CPU-readable BGRA8 data."), *CombinedTexture->GetName());
+        return false;
+    }
+
+    TArray<FColor> Images[3];
+    if (!FMinraDemosaicCPU::Demosaic(Combined, Width, Height, Algorithm, CFAPattern, Images[0], Images[1], Images[2]))
+    {
+        return false;
+    }
+
+    const FIntPoint OutputSize = FMinraDemosaicCPU::GetOutputSize(Width, Height, Algorithm);
+
+    for (int32 Index = 0; Index < 3; ++Index)
+    {
+        UTexture2D* Output = Cast<UTexture2D>(RuntimeOutputs[Index]);
+        if (!Output || Output->GetSizeX() != OutputSize.X || Output->GetSizeY() != OutputSize.Y)
+        {
+            Output = UTexture2D::CreateTransient(OutputSize.X, OutputSize.Y, PF_B8G8R8A8);
+            if (!Output)
+            {
+                return false;
+            }
+
+            Output->SRGB = false;
+            RuntimeOutputs[Index] = Output;
+        }
+
+        FTexture2DMipMap& Mip = Output->GetPlatformData()->Mips[0];
+        void* Data = Mip.BulkData.Lock(LOCK_READ_WRITE);
+        FMemory::Memcpy(Data, Images[Index].GetData(), Images[Index].Num() * sizeof(FColor));
+        Mip.BulkData.Unlock();
+
+        Output->UpdateResource();
+    }
+
+    return true;
 }
 
 UTexture2D* UMinraDemosaicTexture::CreateFallbackTexture(int32 Width, int32 Height)
@@ -106,12 +413,197 @@ void UMinraDemosaicTexture::SetBakedTextures(UTexture2D* Image1, UTexture2D* Ima
     Modify();
 }
 
+void UMinraDemosaicTexture::SetBakedTextureArray(UTexture2DArray* ImageArray)
+{
+    BakedImageArray = ImageArray;
+
+    Modify();
+}
+
 void UMinraDemosaicTexture::ClearBakedTextures()
 {
     BakedImage1 = nullptr;
     BakedImage2 = nullptr;
     BakedImage3 = nullptr;
+    BakedImageArray = nullptr;
 
     Modify();
 }
+
+void UMinraDemosaicTexture::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+    Super::PostEditChangeProperty(PropertyChangedEvent);
+
+    const FName PropertyName = PropertyChangedEvent.GetPropertyName();
+
+    if (PropertyName == GET_MEMBER_NAME_CHECKED(UMinraDemosaicTexture, CombinedTexture) ||
+        PropertyName == GET_MEMBER_NAME_CHECKED(UMinraDemosaicTexture, Algorithm) ||
+        PropertyName == GET_MEMBER_NAME_CHECKED(UMinraDemosaicTexture, CFAPattern))
+    {
+        // Refresh in place so materials already using the outputs update
+        if (bRuntimeOutputsValid || bRuntimeOutputsPending)
+        {
+            UpdateRuntimeOutputs();
+        }
+    }
+    else if (PropertyName == GET_MEMBER_NAME_CHECKED(UMinraDemosaicTexture, bDemosaicAtRuntime) && !bDemosaicAtRuntime)
+    {
+        ReleaseRuntimeOutputs();
+    }
+}
+
+bool UMinraDemosaicTexture::HasCookedImages() const
+{
+    return CookedImages[0] != nullptr && CookedImages[1] != nullptr && CookedImages[2] != nullptr;
+}
+
+void UMinraDemosaicTexture::Serialize(FArchive& Ar)
+{
+    // With all three baked or cook-time outputs (or an array) the runtime never reads the combined
+    // texture, so cooked packages drop the reference and it is only cooked if something else uses it
+    if (Ar.IsSaving() && Ar.IsCooking() && HasCookedImages())
+    {
+        TGuardValue<UTexture2D*> StripCombinedTexture(CombinedTexture, nullptr);
+        TGuardValue<UTexture2D*> CookedImage1(BakedImage1, CookedImages[0]);
+        TGuardValue<UTexture2D*> CookedImage2(BakedImage2, CookedImages[1]);
+        TGuardValue<UTexture2D*> CookedImage3(BakedImage3, CookedImages[2]);
+        Super::Serialize(Ar);
+        return;
+    }
+
+    if (Ar.IsSaving() && Ar.IsCooking() && CookedImageArray)
+    {
+        TGuardValue<UTexture2D*> StripCombinedTexture(CombinedTexture, nullptr);
+        TGuardValue<UTexture2DArray*> CookedArray(BakedImageArray, CookedImageArray);
+        Super::Serialize(Ar);
+        return;
+    }
+
+    if (Ar.IsSaving() && Ar.IsCooking() && (HasBakedTextures() || HasBakedTextureArray()))
+    {
+        TGuardValue<UTexture2D*> StripCombinedTexture(CombinedTexture, nullptr);
+        Super::Serialize(Ar);
+        return;
+    }
+
+    Super::Serialize(Ar);
+}
+
+void UMinraDemosaicTexture::PreSaveRoot(FObjectPreSaveRootContext ObjectSaveContext)
+{
+    Super::PreSaveRoot(ObjectSaveContext);
+
+    if (!ObjectSaveContext.IsCooking())
+    {
+        return;
+    }
+
+    // Cook-time outputs are saved only into cooked packages
+    if (HasCookedImages())
+    {
+        for (UTexture2D* Image : CookedImages)
+        {
+            Image->ClearFlags(RF_Transient);
+        }
+        ObjectSaveContext.SetCleanupRequired(true);
+    }
+    else if (CookedImageArray)
+    {
+        CookedImageArray->ClearFlags(RF_Transient);
+        ObjectSaveContext.SetCleanupRequired(true);
+    }
+
+    if ((HasBakedTextures() || HasBakedTextureArray() || HasCookedImages() || CookedImageArray) && CombinedTexture)
+    {
+        // Dropping the reference keeps the texture out of the cook only if no other package
+        // references it in game data; otherwise report the dropped reference without savings
+        TArray<FName> Referencers;
+        IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+        AssetRegistry.GetReferencers(CombinedTexture->GetOutermost()->GetFName(), Referencers, UE::AssetRegistry::EDependencyCategory::Package, UE::AssetRegistry::EDependencyQuery::Game);
+        Referencers.Remove(GetOutermost()->GetFName());
+
+        if (Referencers.Num() == 0)
+        {
+            // CFA textures are uncompressed BGRA8 without mips
+            const int64 BytesSaved = static_cast<int64>(CombinedTexture->GetSizeX()) * CombinedTexture->GetSizeY() * sizeof(FColor);
+            FMinraCookReport::AddStripped(ObjectSaveContext.GetTargetPlatform(), this, CombinedTexture->GetPathName(), BytesSaved);
+        }
+        else
+        {
+            const FString Source = FString::Printf(TEXT("%s (still cooked: %d other referencers)"), *CombinedTexture->GetPathName(), Referencers.Num());
+            FMinraCookReport::AddStripped(ObjectSaveContext.GetTargetPlatform(), this, Source, 0);
+        }
+    }
+}
+
+void UMinraDemosaicTexture::PostSaveRoot(FObjectPostSaveRootContext ObjectSaveContext)
+{
+    Super::PostSaveRoot(ObjectSaveContext);
+
+    for (UTexture2D* Image : CookedImages)
+    {
+        if (Image)
+        {
+            Image->SetFlags(RF_Transient);
+        }
+    }
+
+    if (CookedImageArray)
+    {
+        CookedImageArray->SetFlags(RF_Transient);
+    }
+}
+
+void UMinraDemosaicTexture::BeginCacheForCookedPlatformData(const ITargetPlatform* TargetPlatform)
+{
+    Super::BeginCacheForCookedPlatformData(TargetPlatform);
+
+    // Assets baked to an array ship an array
+    const bool bTextureArray = BakedImageArray != nullptr;
+    if (!bBakeOnCook || (CookBake.IsValid() && CookBake->Matches(Algorithm, CFAPattern, CookCompression, bTextureArray)))
+    {
+        return;
+    }
+
+    // Texture data is read here, not on the worker
+    TArray<FColor> Pixels;
+    int32 PixelsWidth = 0;
+    int32 PixelsHeight = 0;
+    if (!FMinraDemosaicCPU::ReadTexturePixels(CombinedTexture, Pixels, PixelsWidth, PixelsHeight))
+    {
+        UE_LOG(LogTemp, Warning, TEXT("Minra Mosaique: %s has no readable BGRA8 combined texture to bake while cooking."), *GetName());
+        return;
+    }
+
+    FMinraCookBake::FReadCombined ReadCombined = [Pixels = MoveTemp(Pixels), PixelsWidth, PixelsHeight](TArray<FColor>& OutPixels, int32& OutWidth, int32& OutHeight) mutable
+    {
+        OutPixels = MoveTemp(Pixels);
+        OutWidth = PixelsWidth;
+        OutHeight = PixelsHeight;
+        return true;
+    };
+
+    CookedImages[0] = CookedImages[1] = CookedImages[2] = nullptr;
+    CookedImageArray = nullptr;
+    CookBake = MakeShared<FMinraCookBake>(MoveTemp(ReadCombined), Algorithm, CFAPattern, CookCompression.GetValue(), bTextureArray, GetName());
+}
+
+bool UMinraDemosaicTexture::IsCachedCookedPlatformDataLoaded(const ITargetPlatform* TargetPlatform)
+{
+    if (CookBake.IsValid() && !CookBake->Poll(this, TargetPlatform, CookedImages, CookedImageArray))
+    {
+        return false;
+    }
+
+    return Super::IsCachedCookedPlatformDataLoaded(TargetPlatform);
+}
+
+void UMinraDemosaicTexture::ClearAllCachedCookedPlatformData()
+{
+    Super::ClearAllCachedCookedPlatformData();
+
+    CookBake.Reset();
+    CookedImages[0] = CookedImages[1] = CookedImages[2] = nullptr;
+    CookedImageArray = nullptr;
+}
 #endif
@@ -0,0 +1,172 @@
+// Copyright Minra. All Rights Reserved.
+
+#include "MinraMSQ3DecodeCache.h"
+#include "MSQ3Asset.h"
+#include "MSQ3Decoder.h"
+#include "Engine/Texture2D.h"
+#include "Async/Async.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<int32> CVarMinraDecodeCacheMB(
+    TEXT("r.MinraMosaique.DecodeCacheMB"),
+    256,
+    TEXT("Budget in MB for combined textures decoded from MSQ3 assets. Least recently used ones are released beyond it."),
+    ECVF_Default);
+
+FMinraMSQ3DecodeCache& FMinraMSQ3DecodeCache::Get()
+{
+    static FMinraMSQ3DecodeCache Cache;
+    return Cache;
+}
+
+UTexture2D* FMinraMSQ3DecodeCache::FindOrDecode(const UMSQ3Asset* Asset)
+{
+    check(IsInGameThread());
+
+    if (!Asset || Asset->CompressedData.Num() == 0)
+    {
+        return nullptr;
+    }
+
+    // A hit moves to the most recently used end
+    const int32 Found = Entries.IndexOfByPredicate([Asset](const FEntry& Entry) { return Entry.Asset.Get() == Asset; });
+    if (Found != INDEX_NONE)
+    {
+        FEntry Entry = MoveTemp(Entries[Found]);
+        Entries.RemoveAt(Found);
+        return Entries.Add_GetRef(MoveTemp(Entry)).Texture;
+    }
+
+    UTexture2D* Texture = UTexture2D::CreateTransient(Asset->Width, Asset->Height, PF_B8G8R8A8);
+    if (!Texture)
+    {
+        return nullptr;
+    }
+
+    // CFA data must stay point-sampled and linear
+    Texture->SRGB = false;
+    Texture->Filter = TF_Nearest;
+
+    FEntry& Entry = Entries.AddDefaulted_GetRef();
+    Entry.Asset = Asset;
+    Entry.Texture = Texture;
+    Entry.Bytes = static_cast<int64>(Asset->Width) * Asset->Height * sizeof(FColor);
+
+    Trim();
+
+    // The worker owns a copy of the blob, so the asset may go away meanwhile
+    TWeakObjectPtr<UTexture2D> WeakTexture = Texture;
+    Async(EAsyncExecution::ThreadPool, [Data = Asset->CompressedData, WeakTexture, Name = Asset->GetName()]()
+    {
+        TArray<FColor> Pixels;
+        TSharedPtr<FMinraMSQ3Decoder::FMQ3Data> Decoded = FMinraMSQ3Decoder::Decode(Data);
+        if (!Decoded.IsValid() || !FMinraMSQ3Decoder::DecodeCombinedPixels(*Decoded, Pixels))
+        {
+            UE_LOG(LogTemp, Error, TEXT("Minra Mosaique: Failed to decode %s."), *Name);
+            return;
+        }
+
+        AsyncTask(ENamedThreads::GameThread, [WeakTexture, Pixels = MoveTemp(Pixels)]()
+        {
+            UTexture2D* Texture = WeakTexture.Get();
+            if (!Texture || Texture->GetPlatformData()->Mips[0].BulkData.GetBulkDataSize() != Pixels.Num() * sizeof(FColor))
+            {
+                return;
+            }
+
+            FTexture2DMipMap& Mip = Texture->GetPlatformData()->Mips[0];
+            void* MipData = Mip.BulkData.Lock(LOCK_READ_WRITE);
+            FMemory::Memcpy(MipData, Pixels.GetData(), Pixels.Num() * sizeof(FColor));
+            Mip.BulkData.Unlock();
+
+            Texture->UpdateResource();
+            FMinraMSQ3DecodeCache::Get().OnDecoded(Texture);
+        });
+    });
+
+    return Texture;
+}
+
+bool FMinraMSQ3DecodeCache::IsDecoded(const UMSQ3Asset* Asset) const
+{
+    const FEntry* Entry = Entries.FindByPredicate([Asset](const FEntry& Candidate) { return Candidate.Asset.Get() == Asset; });
+    return Entry && Entry->bDecoded;
+}
+
+void FMinraMSQ3DecodeCache::Release(const UMSQ3Asset* Asset)
+{
+    Entries.RemoveAll([Asset](const FEntry& Entry) { return Entry.Asset.Get() == Asset; });
+}
+
+void FMinraMSQ3DecodeCache::ReleaseAll()
+{
+    // The trim delegate can fire off the game thread
+    if (!IsInGameThread())
+    {
+        AsyncTask(ENamedThreads::GameThread, []() { ReleaseAll(); });
+        return;
+    }
+
+    FMinraMSQ3DecodeCache& Cache = Get();
+    if (Cache.Entries.Num() > 0)
+    {
+        UE_LOG(LogTemp, Log, TEXT("Minra Mosaique: Released %d decoded MSQ3 textures (%lld bytes) on memory trim."),
+            Cache.Entries.Num(), Cache.GetCachedBytes());
+        Cache.Entries.Reset();
+    }
+}
+
+int64 FMinraMSQ3DecodeCache::GetCachedBytes() const
+{
+    int64 Total = 0;
+    for (const FEntry& Entry : Entries)
+    {
+        Total += Entry.Bytes;
+    }
+    return Total;
+}
+
+void FMinraMSQ3DecodeCache::AddReferencedObjects(FReferenceCollector& Collector)
+{
+    for (FEntry& Entry : Entries)
+    {
+        Collector.AddReferencedObject(Entry.Texture);
+    }
+}
+
+FString FMinraMSQ3DecodeCache::GetReferencerName() const
+{
+    return TEXT("FMinraMSQ3DecodeCache");
+}
+
+void FMinraMSQ3DecodeCache::OnDecoded(const UTexture2D* Texture)
+{
+    for (FEntry& Entry : Entries)
+    {
+        if (Entry.Texture == Texture)
+        {
+            Entry.bDecoded = true;
+        }
+    }
+}
+
+void FMinraMSQ3DecodeCache::Trim()
+{
+    Entries.RemoveAll([](const FEntry& Entry) { return !Entry.Asset.IsValid(); });
+
+    const int64 Budget = static_cast<int64>(FMath::Max(CVarMinraDecodeCacheMB.GetValueOnGameThread(), 0)) * 1024 * 1024;
+    int64 Cached = GetCachedBytes();
+
+    int32 NumEvicted = 0;
+    while (Entries.Num() > 1 && Cached > Budget)
+    {
+        Cached -= Entries[0].Bytes;
+        Entries.RemoveAt(0);
+        ++NumEvicted;
+    }
+
+    if (NumEvicted > 0)
+    {
+        UE_LOG(LogTemp, Verbose, TEXT("Minra Mosaique: Evicted %d decoded MSQ3 textures, %lld bytes cached."), NumEvicted, Cached);
+    }
+}
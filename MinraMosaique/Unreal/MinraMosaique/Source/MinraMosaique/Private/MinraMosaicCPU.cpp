@@ -0,0 +1,104 @@
+// Copyright Minra. All Rights Reserved.
+
+#include "MinraMosaicCPU.h"
+#include "MinraSIMD.h"
+#include "Async/ParallelFor.h"
+#include "Math/VectorRegister.h"
+
+namespace MinraMosaicCPU
+{
+    // Channel sampled at [Y & 1][X & 1] for each EMinraCFAPattern, 0 = R, 1 = G, 2 = B
+    const int32 PATTERN_SITES[4][2][2] =
+    {
+        { { 0, 1 }, { 1, 2 } }, // RGGB
+        { { 2, 1 }, { 1, 0 } }, // BGGR
+        { { 1, 0 }, { 2, 1 } }, // GRBG
+        { { 1, 2 }, { 0, 1 } }, // GBRG
+    };
+
+    /**
+     * Row Y of an image blurred by [1 2 1] x [1 2 1] / 16, with edges clamped.
+     */
+    void PrefilterRow(
+        const FColor* Pixels,
+        int32 Width,
+        int32 Height,
+        int32 Y,
+        TArray<VectorRegister4Float>& Columns,
+        FColor* Out)
+    {
+        const FColor* Up = Pixels + FMath::Max(Y - 1, 0) * Width;
+        const FColor* Middle = Pixels + Y * Width;
+        const FColor* Down = Pixels + FMath::Min(Y + 1, Height - 1) * Width;
+
+        const VectorRegister4Float Two = MakeVectorRegisterFloat(2.0f, 2.0f, 2.0f, 2.0f);
+        const VectorRegister4Float Sixteenth = MakeVectorRegisterFloat(1.0f / 16.0f, 1.0f / 16.0f, 1.0f / 16.0f, 1.0f / 16.0f);
+        const VectorRegister4Float Half = MakeVectorRegisterFloat(0.5f, 0.5f, 0.5f, 0.5f);
+
+        Columns.SetNumUninitialized(Width);
+        for (int32 X = 0; X < Width; ++X)
+        {
+            Columns[X] = VectorAdd(
+                VectorAdd(VectorLoadByte4(&Up[X]), VectorLoadByte4(&Down[X])),
+                VectorMultiply(Two, VectorLoadByte4(&Middle[X])));
+        }
+
+        // Sums are integers up to 16 * 255, so scaling by 1/16 is exact and +0.5 rounds
+        for (int32 X = 0; X < Width; ++X)
+        {
+            const VectorRegister4Float Sum = VectorAdd(
+                VectorAdd(Columns[FMath::Max(X - 1, 0)], Columns[FMath::Min(X + 1, Width - 1)]),
+                VectorMultiply(Two, Columns[X]));
+            VectorStoreByte4(VectorAdd(VectorMultiply(Sum, Sixteenth), Half), &Out[X]);
+        }
+    }
+}
+
+bool FMinraMosaicCPU::Mosaic(
+    const TArray<FColor>& Image1,
+    const TArray<FColor>& Image2,
+    const TArray<FColor>& Image3,
+    int32 Width,
+    int32 Height,
+    EMinraCFAPattern Pattern,
+    bool bPrefilter,
+    TArray<FColor>& OutCombined)
+{
+    using namespace MinraMosaicCPU;
+
+    const int32 NumPixels = Width * Height;
+    if (Width <= 0 || Height <= 0 || Image1.Num() != NumPixels || Image2.Num() != NumPixels || Image3.Num() != NumPixels)
+    {
+        UE_LOG(LogTemp, Error, TEXT("Minra Mosaique: Mosaic inputs must be three %dx%d images."), Width, Height);
+        return false;
+    }
+
+    const int32 (&Sites)[2][2] = PATTERN_SITES[static_cast<int32>(Pattern)];
+    const TArray<FColor>* Images[3] = { &Image1, &Image2, &Image3 };
+
+    OutCombined.SetNumUninitialized(NumPixels);
+
+    ParallelFor(Height, [&](int32 Y)
+    {
+        const int32 RowParity = Y & 1;
+        FColor* OutRow = &OutCombined[Y * Width];
+
+        if (!bPrefilter)
+        {
+            MinraSIMD::MosaicRow(&Image1[Y * Width], &Image2[Y * Width], &Image3[Y * Width], OutRow, Width, Sites[RowParity][0], Sites[RowParity][1]);
+            return;
+        }
+
+        TArray<VectorRegister4Float> Columns;
+        TArray<FColor> Filtered[3];
+        for (int32 Image = 0; Image < 3; ++Image)
+        {
+            Filtered[Image].SetNumUninitialized(Width);
+            PrefilterRow(Images[Image]->GetData(), Width, Height, Y, Columns, Filtered[Image].GetData());
+        }
+
+        MinraSIMD::MosaicRow(Filtered[0].GetData(), Filtered[1].GetData(), Filtered[2].GetData(), OutRow, Width, Sites[RowParity][0], Sites[RowParity][1]);
+    });
+
+    return true;
+}
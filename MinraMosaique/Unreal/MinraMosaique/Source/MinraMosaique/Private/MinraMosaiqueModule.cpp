@@ -1,6 +1,13 @@
 // Copyright Minra. All Rights Reserved.
 
 #include "MinraMosaiqueModule.h"
+#include "MinraDemosaicTexture.h"
+#include "MinraMSQ3DecodeCache.h"
+#include "MinraCookReport.h"
+#include "Misc/CoreDelegates.h"
+#include "Interfaces/IPluginManager.h"
+#include "Misc/Paths.h"
+#include "ShaderCore.h"
 
 #define LOCTEXT_NAMESPACE "FMinraMosaiqueModule"
 
@@ -9,6 +16,26 @@ void FMinraMosaiqueModule::StartupModule()
     // This code will execute after your module is loaded into memory.
     // The exact timing is specified in the .uplugin file per-module.
 
+    // Expose Shaders/ as /Plugin/MinraMosaique for material includes.
+    // Must run before shaders compile, hence the PostConfigInit loading phase.
+    TSharedPtr<IPlugin> Plugin = IPluginManager::Get().FindPlugin(TEXT("MinraMosaique"));
+    if (Plugin.IsValid())
+    {
+        const FString ShaderDirectory = FPaths::Combine(Plugin->GetBaseDir(), TEXT("Shaders"));
+        AddShaderSourceDirectoryMapping(TEXT("/Plugin/MinraMosaique"), ShaderDirectory);
+    }
+    else
+    {
+        UE_LOG(LogTemp, Error, TEXT("Minra Mosaique: Plugin descriptor not found, shader includes unavailable."));
+    }
+
+    MemoryTrimHandle = FCoreDelegates::GetMemoryTrimDelegate().AddStatic(&UMinraDemosaicTexture::ReleaseAllRuntimeOutputs);
+    DecodeCacheTrimHandle = FCoreDelegates::GetMemoryTrimDelegate().AddStatic(&FMinraMSQ3DecodeCache::ReleaseAll);
+
+#if WITH_EDITOR
+    CookReportHandle = FCoreDelegates::OnEnginePreExit.AddStatic(&FMinraCookReport::Write);
+#endif
+
     UE_LOG(LogTemp, Log, TEXT("Minra Mosaique: Runtime module loaded."));
 }
 
@@ -16,6 +43,13 @@ void FMinraMosaiqueModule::ShutdownModule()
 {
     // This function may be called during shutdown to clean up your module.
 
+    FCoreDelegates::GetMemoryTrimDelegate().Remove(MemoryTrimHandle);
+    FCoreDelegates::GetMemoryTrimDelegate().Remove(DecodeCacheTrimHandle);
+
+#if WITH_EDITOR
+    FCoreDelegates::OnEnginePreExit.Remove(CookReportHandle);
+#endif
+
     UE_LOG(LogTemp, Log, TEXT("Minra Mosaique: Runtime module unloaded."));
 }
 
@@ -0,0 +1,422 @@
+// Copyright Minra. All Rights Reserved.
+
+#include "MinraQualityMetrics.h"
+#include "Async/ParallelFor.h"
+#include "Math/VectorRegister.h"
+#include <limits>
+
+namespace MinraQualityMetrics
+{
+    // Squared differences of up to this many pixels sum exactly in float (128 * 255^2 < 2^24)
+    const int32 MSE_CHUNK = 128;
+
+    // skimage defaults: K1 = 0.01, K2 = 0.03, data range 255
+    const float SSIM_C1 = (0.01f * 255.0f) * (0.01f * 255.0f);
+    const float SSIM_C2 = (0.03f * 255.0f) * (0.03f * 255.0f);
+    const int32 SSIM_WINDOW = 7;
+
+    FORCEINLINE VectorRegister4Float Splat(float Value)
+    {
+        return MakeVectorRegisterFloat(Value, Value, Value, Value);
+    }
+
+    // Sum of the B, G and R lanes of a VectorLoadByte4 result
+    FORCEINLINE double SumRGB(const VectorRegister4Float& Value)
+    {
+        alignas(16) float Lanes[4];
+        VectorStoreAligned(Value, Lanes);
+        return static_cast<double>(Lanes[0]) + Lanes[1] + Lanes[2];
+    }
+
+    /**
+     * Sum of squared RGB differences of one row.
+     */
+    double RowSquaredError(const FColor* A, const FColor* B, int32 Width)
+    {
+        const VectorRegister4Float RGBMask = MakeVectorRegisterFloat(1.0f, 1.0f, 1.0f, 0.0f);
+        double Total = 0.0;
+
+        for (int32 Start = 0; Start < Width; Start += MSE_CHUNK)
+        {
+            const int32 End = FMath::Min(Start + MSE_CHUNK, Width);
+            VectorRegister4Float Sum = VectorZeroFloat();
+
+            for (int32 X = Start; X < End; ++X)
+            {
+                const VectorRegister4Float Diff = VectorMultiply(VectorSubtract(VectorLoadByte4(&A[X]), VectorLoadByte4(&B[X])), RGBMask);
+                Sum = VectorAdd(Sum, VectorMultiply(Diff, Diff));
+            }
+
+            Total += SumRGB(Sum);
+        }
+
+        return Total;
+    }
+
+    /**
+     * SSIM summed over the windows centred on row Y, all three channels.
+     * Window moments are integer sums below 2^24, so they are exact in float and the
+     * horizontal slide can subtract without drift.
+     */
+    double RowSSIM(const FColor* A, const FColor* B, int32 Width, int32 Y, int32 Window, TArray<VectorRegister4Float>& Columns)
+    {
+        enum { SUM_A, SUM_B, SUM_AA, SUM_BB, SUM_AB, NUM_MOMENTS };
+
+        const int32 Pad = Window / 2;
+        const float Count = static_cast<float>(Window * Window);
+
+        // Vertical sums of each moment, per column
+        Columns.SetNumUninitialized(Width * NUM_MOMENTS);
+        for (int32 X = 0; X < Width; ++X)
+        {
+            VectorRegister4Float Moments[NUM_MOMENTS];
+            for (VectorRegister4Float& Moment : Moments)
+            {
+                Moment = VectorZeroFloat();
+            }
+
+            for (int32 WY = Y - Pad; WY <= Y + Pad; ++WY)
+            {
+                const VectorRegister4Float PA = VectorLoadByte4(&A[WY * Width + X]);
+                const VectorRegister4Float PB = VectorLoadByte4(&B[WY * Width + X]);
+                Moments[SUM_A] = VectorAdd(Moments[SUM_A], PA);
+                Moments[SUM_B] = VectorAdd(Moments[SUM_B], PB);
+                Moments[SUM_AA] = VectorAdd(Moments[SUM_AA], VectorMultiply(PA, PA));
+                Moments[SUM_BB] = VectorAdd(Moments[SUM_BB], VectorMultiply(PB, PB));
+                Moments[SUM_AB] = VectorAdd(Moments[SUM_AB], VectorMultiply(PA, PB));
+            }
+
+            for (int32 Moment = 0; Moment < NUM_MOMENTS; ++Moment)
+            {
+                Columns[X * NUM_MOMENTS + Moment] = Moments[Moment];
+            }
+        }
+
+        const VectorRegister4Float InvCount = Splat(1.0f / Count);
+        const VectorRegister4Float CovarianceNorm = Splat(Count / (Count - 1.0f));
+        const VectorRegister4Float Two = Splat(2.0f);
+        const VectorRegister4Float C1 = Splat(SSIM_C1);
+        const VectorRegister4Float C2 = Splat(SSIM_C2);
+
+        VectorRegister4Float Sums[NUM_MOMENTS];
+        for (int32 Moment = 0; Moment < NUM_MOMENTS; ++Moment)
+        {
+            Sums[Moment] = VectorZeroFloat();
+            for (int32 X = 0; X < 2 * Pad + 1; ++X)
+            {
+                Sums[Moment] = VectorAdd(Sums[Moment], Columns[X * NUM_MOMENTS + Moment]);
+            }
+        }
+
+        double Total = 0.0;
+        for (int32 X = Pad; X < Width - Pad; ++X)
+        {
+            const VectorRegister4Float MeanA = VectorMultiply(Sums[SUM_A], InvCount);
+            const VectorRegister4Float MeanB = VectorMultiply(Sums[SUM_B], InvCount);
+            const VectorRegister4Float MeanAB = VectorMultiply(MeanA, MeanB);
+            const VectorRegister4Float VarA = VectorMultiply(VectorSubtract(VectorMultiply(Sums[SUM_AA], InvCount), VectorMultiply(MeanA, MeanA)), CovarianceNorm);
+            const VectorRegister4Float VarB = VectorMultiply(VectorSubtract(VectorMultiply(Sums[SUM_BB], InvCount), VectorMultiply(MeanB, MeanB)), CovarianceNorm);
+            const VectorRegister4Float Covariance = VectorMultiply(VectorSubtract(VectorMultiply(Sums[SUM_AB], InvCount), MeanAB), CovarianceNorm);
+
+            // ((2 ua ub + C1)(2 cov + C2)) / ((ua^2 + ub^2 + C1)(var a + var b + C2))
+            const VectorRegister4Float Numerator = VectorMultiply(
+                VectorAdd(VectorMultiply(Two, MeanAB), C1),
+                VectorAdd(VectorMultiply(Two, Covariance), C2));
+            const VectorRegister4Float Denominator = VectorMultiply(
+                VectorAdd(VectorAdd(VectorMultiply(MeanA, MeanA), VectorMultiply(MeanB, MeanB)), C1),
+                VectorAdd(VectorAdd(VarA, VarB), C2));
+
+            Total += SumRGB(VectorDivide(Numerator, Denominator));
+
+            if (X + Pad + 1 < Width)
+            {
+                for (int32 Moment = 0; Moment < NUM_MOMENTS; ++Moment)
+                {
+                    Sums[Moment] = VectorSubtract(
+                        VectorAdd(Sums[Moment], Columns[(X + Pad + 1) * NUM_MOMENTS + Moment]),
+                        Columns[(X - Pad) * NUM_MOMENTS + Moment]);
+                }
+            }
+        }
+
+        return Total;
+    }
+
+    /**
+     * sRGB decode table, 0-255 to linear.
+     */
+    struct FLinearTable
+    {
+        float Values[256];
+
+        FLinearTable()
+        {
+            for (int32 Index = 0; Index < 256; ++Index)
+            {
+                const double V = Index / 255.0;
+                Values[Index] = static_cast<float>(V <= 0.04045 ? V / 12.92 : FMath::Pow((V + 0.055) / 1.055, 2.4));
+            }
+        }
+
+        static const FLinearTable& Get()
+        {
+            static const FLinearTable Table;
+            return Table;
+        }
+    };
+
+    /**
+     * CIELab f(t): cube root above (6/29)^3, linear below. The cube root is five Newton
+     * steps from 0.2 + 0.8t, accurate to about 1e-7 over the [0, 1.09] range XYZ reaches.
+     */
+    FORCEINLINE VectorRegister4Float LabF(const VectorRegister4Float& T)
+    {
+        const VectorRegister4Float Third = Splat(1.0f / 3.0f);
+        const VectorRegister4Float Two = Splat(2.0f);
+
+        VectorRegister4Float Root = VectorAdd(Splat(0.2f), VectorMultiply(Splat(0.8f), T));
+        for (int32 Step = 0; Step < 5; ++Step)
+        {
+            Root = VectorMultiply(VectorAdd(VectorMultiply(Two, Root), VectorDivide(T, VectorMultiply(Root, Root))), Third);
+        }
+
+        const VectorRegister4Float Linear = VectorAdd(VectorMultiply(Splat(7.787f), T), Splat(16.0f / 116.0f));
+        return VectorSelect(VectorCompareGT(T, Splat(0.008856f)), Root, Linear);
+    }
+
+    /**
+     * CIELab of four pixels, one per lane.
+     */
+    void PixelsToLab(const FColor* Pixels, int32 Count, VectorRegister4Float& OutL, VectorRegister4Float& OutA, VectorRegister4Float& OutB)
+    {
+        const FLinearTable& Table = FLinearTable::Get();
+
+        alignas(16) float R[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        alignas(16) float G[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        alignas(16) float B[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        for (int32 Lane = 0; Lane < Count; ++Lane)
+        {
+            R[Lane] = Table.Values[Pixels[Lane].R];
+            G[Lane] = Table.Values[Pixels[Lane].G];
+            B[Lane] = Table.Values[Pixels[Lane].B];
+        }
+
+        const VectorRegister4Float LinearR = VectorLoadAligned(R);
+        const VectorRegister4Float LinearG = VectorLoadAligned(G);
+        const VectorRegister4Float LinearB = VectorLoadAligned(B);
+
+        // sRGB to XYZ, each row divided by the D65 white point
+        auto Row = [&](float CR, float CG, float CB)
+        {
+            return VectorAdd(VectorAdd(
+                VectorMultiply(LinearR, Splat(CR)),
+                VectorMultiply(LinearG, Splat(CG))),
+                VectorMultiply(LinearB, Splat(CB)));
+        };
+
+        const VectorRegister4Float FX = LabF(Row(0.4124564f / 0.95047f, 0.3575761f / 0.95047f, 0.1804375f / 0.95047f));
+        const VectorRegister4Float FY = LabF(Row(0.2126729f, 0.7151522f, 0.0721750f));
+        const VectorRegister4Float FZ = LabF(Row(0.0193339f / 1.08883f, 0.1191920f / 1.08883f, 0.9503041f / 1.08883f));
+
+        OutL = VectorSubtract(VectorMultiply(FY, Splat(116.0f)), Splat(16.0f));
+        OutA = VectorMultiply(VectorSubtract(FX, FY), Splat(500.0f));
+        OutB = VectorMultiply(VectorSubtract(FY, FZ), Splat(200.0f));
+    }
+
+    /**
+     * Sum of Delta E over one row, four pixels per vector.
+     */
+    double RowDeltaE(const FColor* A, const FColor* B, int32 Width)
+    {
+        double Total = 0.0;
+
+        for (int32 X = 0; X < Width; X += 4)
+        {
+            // Lanes past the row end are black in both images, so they add nothing
+            const int32 Count = FMath::Min(4, Width - X);
+
+            VectorRegister4Float LA, AA, BA;
+            VectorRegister4Float LB, AB, BB;
+            PixelsToLab(A + X, Count, LA, AA, BA);
+            PixelsToLab(B + X, Count, LB, AB, BB);
+
+            const VectorRegister4Float DL = VectorSubtract(LA, LB);
+            const VectorRegister4Float DA = VectorSubtract(AA, AB);
+            const VectorRegister4Float DB = VectorSubtract(BA, BB);
+            const VectorRegister4Float Distance = VectorSqrt(VectorAdd(VectorAdd(VectorMultiply(DL, DL), VectorMultiply(DA, DA)), VectorMultiply(DB, DB)));
+
+            alignas(16) float Lanes[4];
+            VectorStoreAligned(Distance, Lanes);
+            Total += static_cast<double>(Lanes[0]) + Lanes[1] + Lanes[2] + Lanes[3];
+        }
+
+        return Total;
+    }
+
+    /**
+     * Runs RowFunc over every row in parallel and sums the results in row order,
+     * so totals do not depend on scheduling.
+     */
+    template <typename RowFuncType>
+    double SumRows(int32 NumRows, RowFuncType RowFunc)
+    {
+        TArray<double> RowTotals;
+        RowTotals.SetNumUninitialized(NumRows);
+
+        ParallelFor(NumRows, [&](int32 Row)
+        {
+            RowTotals[Row] = RowFunc(Row);
+        });
+
+        double Total = 0.0;
+        for (int32 Row = 0; Row < NumRows; ++Row)
+        {
+            Total += RowTotals[Row];
+        }
+        return Total;
+    }
+}
+
+bool FMinraQualityMetrics::IsValidPair(
+    const TArray<FColor>& Original,
+    const TArray<FColor>& Reconstructed,
+    int32 Width,
+    int32 Height)
+{
+    if (Width <= 0 || Height <= 0 || Original.Num() != Width * Height || Reconstructed.Num() != Width * Height)
+    {
+        UE_LOG(LogTemp, Error, TEXT("Minra Mosaique: Metric inputs do not match %dx%d (%d and %d pixels)."),
+            Width, Height, Original.Num(), Reconstructed.Num());
+        return false;
+    }
+
+    return true;
+}
+
+double FMinraQualityMetrics::ComputeMSE(
+    const TArray<FColor>& Original,
+    const TArray<FColor>& Reconstructed,
+    int32 Width,
+    int32 Height)
+{
+    using namespace MinraQualityMetrics;
+
+    if (!IsValidPair(Original, Reconstructed, Width, Height))
+    {
+        return -1.0;
+    }
+
+    const FColor* A = Original.GetData();
+    const FColor* B = Reconstructed.GetData();
+
+    const double Total = SumRows(Height, [&](int32 Y)
+    {
+        return RowSquaredError(A + Y * Width, B + Y * Width, Width);
+    });
+
+    return Total / (static_cast<double>(Width) * Height * 3.0);
+}
+
+double FMinraQualityMetrics::ComputePSNR(
+    const TArray<FColor>& Original,
+    const TArray<FColor>& Reconstructed,
+    int32 Width,
+    int32 Height)
+{
+    const double MSE = ComputeMSE(Original, Reconstructed, Width, Height);
+
+    if (MSE < 0.0)
+    {
+        return -1.0;
+    }
+
+    if (MSE == 0.0)
+    {
+        return std::numeric_limits<double>::infinity();
+    }
+
+    return 10.0 * FMath::LogX(10.0, 255.0 * 255.0 / MSE);
+}
+
+double FMinraQualityMetrics::ComputeSSIM(
+    const TArray<FColor>& Original,
+    const TArray<FColor>& Reconstructed,
+    int32 Width,
+    int32 Height)
+{
+    using namespace MinraQualityMetrics;
+
+    if (!IsValidPair(Original, Reconstructed, Width, Height))
+    {
+        return -2.0;
+    }
+
+    // Same window choice as the backend: 7, or the largest odd size that fits, at least 3
+    const int32 MinDimension = FMath::Min(Width, Height);
+    const int32 Window = FMath::Max(3, FMath::Min(SSIM_WINDOW, (MinDimension % 2 == 1) ? MinDimension : MinDimension - 1));
+    const int32 Pad = Window / 2;
+
+    const int32 NumRows = Height - 2 * Pad;
+    const int32 NumColumns = Width - 2 * Pad;
+    if (NumRows <= 0 || NumColumns <= 0)
+    {
+        UE_LOG(LogTemp, Error, TEXT("Minra Mosaique: %dx%d is too small for SSIM."), Width, Height);
+        return -2.0;
+    }
+
+    const FColor* A = Original.GetData();
+    const FColor* B = Reconstructed.GetData();
+
+    const double Total = SumRows(NumRows, [&](int32 Row)
+    {
+        TArray<VectorRegister4Float> Columns;
+        return RowSSIM(A, B, Width, Row + Pad, Window, Columns);
+    });
+
+    return Total / (static_cast<double>(NumRows) * NumColumns * 3.0);
+}
+
+double FMinraQualityMetrics::ComputeDeltaE(
+    const TArray<FColor>& Original,
+    const TArray<FColor>& Reconstructed,
+    int32 Width,
+    int32 Height)
+{
+    using namespace MinraQualityMetrics;
+
+    if (!IsValidPair(Original, Reconstructed, Width, Height))
+    {
+        return -1.0;
+    }
+
+    const FColor* A = Original.GetData();
+    const FColor* B = Reconstructed.GetData();
+
+    const double Total = SumRows(Height, [&](int32 Y)
+    {
+        return RowDeltaE(A + Y * Width, B + Y * Width, Width);
+    });
+
+    return Total / (static_cast<double>(Width) * Height);
+}
+
+bool FMinraQualityMetrics::Compute(
+    const TArray<FColor>& Original,
+    const TArray<FColor>& Reconstructed,
+    int32 Width,
+    int32 Height,
+    FMinraQualityReport& OutReport)
+{
+    if (!IsValidPair(Original, Reconstructed, Width, Height))
+    {
+        return false;
+    }
+
+    OutReport.MSE = ComputeMSE(Original, Reconstructed, Width, Height);
+    OutReport.PSNR = OutReport.MSE == 0.0
+        ? std::numeric_limits<double>::infinity()
+        : 10.0 * FMath::LogX(10.0, 255.0 * 255.0 / OutReport.MSE);
+    OutReport.SSIM = ComputeSSIM(Original, Reconstructed, Width, Height);
+    OutReport.DeltaE = ComputeDeltaE(Original, Reconstructed, Width, Height);
+    return true;
+}
@@ -0,0 +1,222 @@
+// Copyright Minra. All Rights Reserved.
+
+#include "MinraSIMD.h"
+
+#if PLATFORM_ENABLE_VECTORINTRINSICS_NEON
+#include <arm_neon.h>
+#define MINRA_SIMD_NEON 1
+#define MINRA_SIMD_SSE2 0
+#elif PLATFORM_ENABLE_VECTORINTRINSICS && PLATFORM_CPU_X86_FAMILY
+#include <emmintrin.h>
+#define MINRA_SIMD_NEON 0
+#define MINRA_SIMD_SSE2 1
+#else
+#define MINRA_SIMD_NEON 0
+#define MINRA_SIMD_SSE2 0
+#endif
+
+namespace MinraSIMD
+{
+    void InterleaveBytes(const uint8* A, const uint8* B, uint8* Out, int32 Width)
+    {
+        int32 X = 0;
+
+#if MINRA_SIMD_SSE2
+        for (; X + 32 <= Width; X += 32)
+        {
+            const __m128i VA = _mm_loadu_si128(reinterpret_cast<const __m128i*>(A + (X >> 1)));
+            const __m128i VB = _mm_loadu_si128(reinterpret_cast<const __m128i*>(B + (X >> 1)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(Out + X), _mm_unpacklo_epi8(VA, VB));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(Out + X + 16), _mm_unpackhi_epi8(VA, VB));
+        }
+#elif MINRA_SIMD_NEON
+        for (; X + 32 <= Width; X += 32)
+        {
+            uint8x16x2_t V;
+            V.val[0] = vld1q_u8(A + (X >> 1));
+            V.val[1] = vld1q_u8(B + (X >> 1));
+            vst2q_u8(Out + X, V);
+        }
+#endif
+
+        for (; X < Width; ++X)
+        {
+            Out[X] = (X & 1) == 0 ? A[X >> 1] : B[X >> 1];
+        }
+    }
+
+    void DeinterleaveBytes(const uint8* In, uint8* OutA, uint8* OutB, int32 Width)
+    {
+        int32 X = 0;
+
+#if MINRA_SIMD_SSE2
+        const __m128i LowMask = _mm_set1_epi16(0x00FF);
+        for (; X + 32 <= Width; X += 32)
+        {
+            const __m128i V0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(In + X));
+            const __m128i V1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(In + X + 16));
+            const __m128i Even = _mm_packus_epi16(_mm_and_si128(V0, LowMask), _mm_and_si128(V1, LowMask));
+            const __m128i Odd = _mm_packus_epi16(_mm_srli_epi16(V0, 8), _mm_srli_epi16(V1, 8));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(OutA + (X >> 1)), Even);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(OutB + (X >> 1)), Odd);
+        }
+#elif MINRA_SIMD_NEON
+        for (; X + 32 <= Width; X += 32)
+        {
+            const uint8x16x2_t V = vld2q_u8(In + X);
+            vst1q_u8(OutA + (X >> 1), V.val[0]);
+            vst1q_u8(OutB + (X >> 1), V.val[1]);
+        }
+#endif
+
+        for (; X < Width; X += 2)
+        {
+            OutA[X >> 1] = In[X];
+            OutB[X >> 1] = In[FMath::Min(X + 1, Width - 1)];
+        }
+    }
+
+    void PackBGRA(const uint8* R, const uint8* G, const uint8* B, FColor* Out, int32 Count)
+    {
+        int32 Index = 0;
+        uint8* OutBytes = reinterpret_cast<uint8*>(Out);
+
+#if MINRA_SIMD_SSE2
+        const __m128i Alpha = _mm_set1_epi8(static_cast<char>(0xFF));
+        for (; Index + 16 <= Count; Index += 16)
+        {
+            const __m128i VR = _mm_loadu_si128(reinterpret_cast<const __m128i*>(R + Index));
+            const __m128i VG = _mm_loadu_si128(reinterpret_cast<const __m128i*>(G + Index));
+            const __m128i VB = _mm_loadu_si128(reinterpret_cast<const __m128i*>(B + Index));
+
+            // FColor memory order is B, G, R, A
+            const __m128i BGLo = _mm_unpacklo_epi8(VB, VG);
+            const __m128i BGHi = _mm_unpackhi_epi8(VB, VG);
+            const __m128i RALo = _mm_unpacklo_epi8(VR, Alpha);
+            const __m128i RAHi = _mm_unpackhi_epi8(VR, Alpha);
+
+            __m128i* Dest = reinterpret_cast<__m128i*>(OutBytes + Index * 4);
+            _mm_storeu_si128(Dest + 0, _mm_unpacklo_epi16(BGLo, RALo));
+            _mm_storeu_si128(Dest + 1, _mm_unpackhi_epi16(BGLo, RALo));
+            _mm_storeu_si128(Dest + 2, _mm_unpacklo_epi16(BGHi, RAHi));
+            _mm_storeu_si128(Dest + 3, _mm_unpackhi_epi16(BGHi, RAHi));
+        }
+#elif MINRA_SIMD_NEON
+        for (; Index + 16 <= Count; Index += 16)
+        {
+            uint8x16x4_t V;
+            V.val[0] = vld1q_u8(B + Index);
+            V.val[1] = vld1q_u8(G + Index);
+            V.val[2] = vld1q_u8(R + Index);
+            V.val[3] = vdupq_n_u8(0xFF);
+            vst4q_u8(OutBytes + Index * 4, V);
+        }
+#endif
+
+        for (; Index < Count; ++Index)
+        {
+            Out[Index] = FColor(R[Index], G[Index], B[Index], 255);
+        }
+    }
+
+    void DuplicatePixels(const FColor* In, FColor* Out, int32 Width)
+    {
+        int32 X = 0;
+
+#if MINRA_SIMD_SSE2
+        for (; X + 8 <= Width; X += 8)
+        {
+            const __m128i V = _mm_loadu_si128(reinterpret_cast<const __m128i*>(In + (X >> 1)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(Out + X), _mm_unpacklo_epi32(V, V));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(Out + X + 4), _mm_unpackhi_epi32(V, V));
+        }
+#elif MINRA_SIMD_NEON
+        for (; X + 8 <= Width; X += 8)
+        {
+            uint32x4x2_t V;
+            V.val[0] = vld1q_u32(reinterpret_cast<const uint32*>(In + (X >> 1)));
+            V.val[1] = V.val[0];
+            vst2q_u32(reinterpret_cast<uint32*>(Out + X), V);
+        }
+#endif
+
+        for (; X < Width; ++X)
+        {
+            Out[X] = In[X >> 1];
+        }
+    }
+
+    void MosaicRow(
+        const FColor* Image1,
+        const FColor* Image2,
+        const FColor* Image3,
+        FColor* Out,
+        int32 Width,
+        int32 EvenChannel,
+        int32 OddChannel)
+    {
+        const FColor* Images[3] = { Image1, Image2, Image3 };
+        const int32 Channels[2] = { EvenChannel, OddChannel };
+        int32 X = 0;
+
+        // FColor memory order is B, G, R, A: channel C is byte 2 - C, and image I goes to byte 2 - I
+#if MINRA_SIMD_SSE2
+        const __m128i ParityLanes[2] = { _mm_setr_epi32(-1, 0, -1, 0), _mm_setr_epi32(0, -1, 0, -1) };
+        const __m128i Alpha = _mm_set1_epi32(static_cast<int32>(0xFF000000u));
+
+        __m128i Masks[2];
+        __m128i LeftShifts[3][2];
+        __m128i RightShifts[3][2];
+        for (int32 Parity = 0; Parity < 2; ++Parity)
+        {
+            Masks[Parity] = _mm_and_si128(ParityLanes[Parity], _mm_set1_epi32(0xFF << ((2 - Channels[Parity]) * 8)));
+
+            for (int32 Image = 0; Image < 3; ++Image)
+            {
+                const int32 Shift = (Channels[Parity] - Image) * 8;
+                LeftShifts[Image][Parity] = _mm_cvtsi32_si128(FMath::Max(Shift, 0));
+                RightShifts[Image][Parity] = _mm_cvtsi32_si128(FMath::Max(-Shift, 0));
+            }
+        }
+
+        for (; X + 4 <= Width; X += 4)
+        {
+            __m128i Result = Alpha;
+            for (int32 Image = 0; Image < 3; ++Image)
+            {
+                const __m128i V = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Images[Image] + X));
+                for (int32 Parity = 0; Parity < 2; ++Parity)
+                {
+                    const __m128i Site = _mm_srl_epi32(_mm_and_si128(V, Masks[Parity]), RightShifts[Image][Parity]);
+                    Result = _mm_or_si128(Result, _mm_sll_epi32(Site, LeftShifts[Image][Parity]));
+                }
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(Out + X), Result);
+        }
+#elif MINRA_SIMD_NEON
+        // Bytes of even pixels after vld4q_u8 de-interleaving
+        const uint8x16_t EvenMask = vreinterpretq_u8_u16(vdupq_n_u16(0x00FF));
+        for (; X + 16 <= Width; X += 16)
+        {
+            uint8x16x4_t Result;
+            for (int32 Image = 0; Image < 3; ++Image)
+            {
+                const uint8x16x4_t V = vld4q_u8(reinterpret_cast<const uint8*>(Images[Image] + X));
+                Result.val[2 - Image] = vbslq_u8(EvenMask, V.val[2 - EvenChannel], V.val[2 - OddChannel]);
+            }
+            Result.val[3] = vdupq_n_u8(0xFF);
+            vst4q_u8(reinterpret_cast<uint8*>(Out + X), Result);
+        }
+#endif
+
+        for (; X < Width; ++X)
+        {
+            const int32 Byte = 2 - Channels[X & 1];
+            Out[X] = FColor(
+                reinterpret_cast<const uint8*>(Image1 + X)[Byte],
+                reinterpret_cast<const uint8*>(Image2 + X)[Byte],
+                reinterpret_cast<const uint8*>(Image3 + X)[Byte],
+                255);
+        }
+    }
+}
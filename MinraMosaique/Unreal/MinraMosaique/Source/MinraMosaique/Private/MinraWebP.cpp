@@ -0,0 +1,109 @@
+// Copyright Minra. All Rights Reserved.
+
+#include "MinraWebP.h"
+
+#if WITH_MINRA_WEBP
+THIRD_PARTY_INCLUDES_START
+#include "webp/encode.h"
+#include "webp/decode.h"
+THIRD_PARTY_INCLUDES_END
+#endif
+
+bool FMinraWebP::IsAvailable()
+{
+    return WITH_MINRA_WEBP != 0;
+}
+
+bool FMinraWebP::EncodeGrayscale(
+    const uint8* Plane,
+    int32 Width,
+    int32 Height,
+    uint8 Quality,
+    TArray<uint8>& OutData)
+{
+    OutData.Reset();
+
+    if (!Plane || Width <= 0 || Height <= 0)
+    {
+        return false;
+    }
+
+#if WITH_MINRA_WEBP
+    // Replicate gray into RGB, matching what the browser canvas hands to its encoder
+    TArray<uint8> RGB;
+    RGB.SetNumUninitialized(Width * Height * 3);
+
+    const int32 NumPixels = Width * Height;
+    for (int32 Index = 0; Index < NumPixels; ++Index)
+    {
+        const uint8 Value = Plane[Index];
+        RGB[Index * 3 + 0] = Value;
+        RGB[Index * 3 + 1] = Value;
+        RGB[Index * 3 + 2] = Value;
+    }
+
+    uint8_t* Encoded = nullptr;
+    const size_t EncodedSize = WebPEncodeRGB(RGB.GetData(), Width, Height, Width * 3, static_cast<float>(FMath::Min<int32>(Quality, 100)), &Encoded);
+
+    if (EncodedSize == 0 || !Encoded)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("Minra Mosaique: WebP encoding failed for %dx%d plane."), Width, Height);
+        return false;
+    }
+
+    OutData.Append(Encoded, static_cast<int32>(EncodedSize));
+    WebPFree(Encoded);
+    return true;
+#else
+    UE_LOG(LogTemp, Warning, TEXT("Minra Mosaique: WebP encoding requires libwebp (Source/ThirdParty/libwebp)."));
+    return false;
+#endif
+}
+
+bool FMinraWebP::DecodeGrayscale(
+    const uint8* Data,
+    int32 DataSize,
+    int32 ExpectedWidth,
+    int32 ExpectedHeight,
+    TArray<uint8>& OutPlane)
+{
+    OutPlane.Reset();
+
+    if (!Data || DataSize <= 0 || ExpectedWidth <= 0 || ExpectedHeight <= 0)
+    {
+        return false;
+    }
+
+#if WITH_MINRA_WEBP
+    int BlobWidth = 0;
+    int BlobHeight = 0;
+    if (!WebPGetInfo(Data, DataSize, &BlobWidth, &BlobHeight) ||
+        BlobWidth != ExpectedWidth || BlobHeight != ExpectedHeight)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("Minra Mosaique: WebP blob is %dx%d, expected %dx%d."), BlobWidth, BlobHeight, ExpectedWidth, ExpectedHeight);
+        return false;
+    }
+
+    TArray<uint8> RGB;
+    RGB.SetNumUninitialized(ExpectedWidth * ExpectedHeight * 3);
+
+    if (!WebPDecodeRGBInto(Data, DataSize, RGB.GetData(), RGB.Num(), ExpectedWidth * 3))
+    {
+        UE_LOG(LogTemp, Warning, TEXT("Minra Mosaique: WebP decoding failed."));
+        return false;
+    }
+
+    // Extract R channel, as the browser decoder does
+    const int32 NumPixels = ExpectedWidth * ExpectedHeight;
+    OutPlane.SetNumUninitialized(NumPixels);
+    for (int32 Index = 0; Index < NumPixels; ++Index)
+    {
+        OutPlane[Index] = RGB[Index * 3];
+    }
+
+    return true;
+#else
+    UE_LOG(LogTemp, Warning, TEXT("Minra Mosaique: WebP decoding requires libwebp (Source/ThirdParty/libwebp)."));
+    return false;
+#endif
+}
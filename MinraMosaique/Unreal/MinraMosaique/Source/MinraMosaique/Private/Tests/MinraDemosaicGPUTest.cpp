@@ -0,0 +1,97 @@
+// Copyright Minra. All Rights Reserved.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "MinraDemosaicTestUtils.h"
+#include "MinraDemosaicCompute.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMinraDemosaicGPUMatchesCPUTest, "MinraMosaique.Demosaic.GPUMatchesCPU",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::EngineFilter)
+
+bool FMinraDemosaicGPUMatchesCPUTest::RunTest(const FString& Parameters)
+{
+    using namespace MinraDemosaicTest;
+
+    if (!FMinraDemosaicCompute::IsSupported())
+    {
+        AddInfo(TEXT("Compute demosaic unsupported in this process (null RHI or below SM5); skipped."));
+        return true;
+    }
+
+    // CPU and GPU round the same float results to 8 bits; FMA contraction on the GPU can move
+    // a value across a rounding boundary, never further
+    constexpr int32 Tolerance = 1;
+
+    const TArray<FColor> Combined = MakeCombinedPixels(TestSize, 1234);
+    UTexture2D* CombinedTexture = CreateCombinedTexture(Combined, TestSize);
+    if (!TestNotNull(TEXT("Combined texture"), CombinedTexture))
+    {
+        return false;
+    }
+
+    for (const EMinraDemosaicAlgorithm Algorithm : GetGPUAlgorithms())
+    {
+        const FIntPoint OutputSize = FMinraDemosaicCPU::GetOutputSize(TestSize.X, TestSize.Y, Algorithm);
+
+        for (const EMinraCFAPattern Pattern : AllPatterns)
+        {
+            const FString Case = FString::Printf(TEXT("%s/%s"), *GetName(Algorithm), *GetName(Pattern));
+
+            TArray<FColor> Expected[FMinraDemosaicCompute::NUM_OUTPUTS];
+            if (!TestTrue(Case + TEXT(" CPU demosaic"), FMinraDemosaicCPU::Demosaic(Combined, TestSize.X, TestSize.Y, Algorithm, Pattern, Expected[0], Expected[1], Expected[2])))
+            {
+                continue;
+            }
+
+            UTextureRenderTarget2D* Targets[FMinraDemosaicCompute::NUM_OUTPUTS];
+            for (UTextureRenderTarget2D*& Target : Targets)
+            {
+                Target = CreateTarget(OutputSize, PF_R8G8B8A8);
+            }
+
+            if (TestTrue(Case + TEXT(" GPU dispatch"), FMinraDemosaicCompute::Dispatch(CombinedTexture, Algorithm, Pattern, Targets)))
+            {
+                for (int32 Image = 0; Image < FMinraDemosaicCompute::NUM_OUTPUTS; ++Image)
+                {
+                    // Flushes the dispatch before reading
+                    TArray<FColor> Actual;
+                    Targets[Image]->GameThread_GetRenderTargetResource()->ReadPixels(Actual);
+
+                    if (!TestEqual(Case + TEXT(" readback size"), Actual.Num(), Expected[Image].Num()))
+                    {
+                        continue;
+                    }
+
+                    int32 NumMismatches = 0;
+                    for (int32 Index = 0; Index < Actual.Num(); ++Index)
+                    {
+                        const FColor& A = Actual[Index];
+                        const FColor& E = Expected[Image][Index];
+                        const int32 Difference = FMath::Max3(FMath::Abs(A.R - E.R), FMath::Abs(A.G - E.G), FMath::Abs(A.B - E.B));
+
+                        if (Difference > Tolerance && NumMismatches++ == 0)
+                        {
+                            AddError(FString::Printf(TEXT("%s image %d: pixel (%d, %d) is %s on the GPU, %s on the CPU."),
+                                *Case, Image + 1, Index % OutputSize.X, Index / OutputSize.X, *A.ToString(), *E.ToString()));
+                        }
+                    }
+
+                    if (NumMismatches > 1)
+                    {
+                        AddError(FString::Printf(TEXT("%s image %d: %d pixels differ by more than %d."), *Case, Image + 1, NumMismatches, Tolerance));
+                    }
+                }
+            }
+
+            Release({ Targets[0], Targets[1], Targets[2] });
+        }
+    }
+
+    Release({ CombinedTexture });
+    return true;
+}
+
+#endif
@@ -0,0 +1,157 @@
+// Copyright Minra. All Rights Reserved.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "MinraDemosaicTestUtils.h"
+#include "MinraDemosaicCompute.h"
+#include "GlobalShader.h"
+#include "ShaderParameterStruct.h"
+#include "RenderGraphBuilder.h"
+#include "RenderGraphUtils.h"
+#include "RenderTargetPool.h"
+
+/**
+ * Runs the single-channel (gather) and fused (load) shader functions on the same pixels
+ * and flags every bit difference. Compiled only for editor shader maps.
+ */
+class FMinraDemosaicGatherTestCS : public FGlobalShader
+{
+public:
+    DECLARE_GLOBAL_SHADER(FMinraDemosaicGatherTestCS);
+    SHADER_USE_PARAMETER_STRUCT(FMinraDemosaicGatherTestCS, FGlobalShader);
+
+    static constexpr int32 ThreadGroupSize = 8;
+
+    class FAlgorithmDim : SHADER_PERMUTATION_INT("MINRA_DEMOSAIC_ALGORITHM", 4);
+    class FCFAPatternDim : SHADER_PERMUTATION_INT("MINRA_CFA_PATTERN", 4);
+    using FPermutationDomain = TShaderPermutationDomain<FAlgorithmDim, FCFAPatternDim>;
+
+    BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+        SHADER_PARAMETER_RDG_TEXTURE(Texture2D, CombinedTexture)
+        SHADER_PARAMETER_SAMPLER(SamplerState, CombinedSampler)
+        SHADER_PARAMETER(FIntPoint, TextureSize)
+        SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float4>, OutMismatch)
+    END_SHADER_PARAMETER_STRUCT()
+
+    static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+    {
+        return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5) &&
+            EnumHasAllFlags(Parameters.Flags, EShaderPermutationFlags::HasEditorOnlyData);
+    }
+
+    static void ModifyCompilationEnvironment(const FGlobalShaderPermutationParameters& Parameters, FShaderCompilerEnvironment& OutEnvironment)
+    {
+        FGlobalShader::ModifyCompilationEnvironment(Parameters, OutEnvironment);
+        OutEnvironment.SetDefine(TEXT("THREADGROUP_SIZE"), ThreadGroupSize);
+    }
+};
+
+IMPLEMENT_GLOBAL_SHADER(FMinraDemosaicGatherTestCS, "/Plugin/MinraMosaique/MinraDemosaicTestCS.usf", "GatherMatchesLoadCS", SF_Compute);
+
+namespace MinraDemosaicTest
+{
+    /** Runs FMinraDemosaicGatherTestCS into Target and waits for it */
+    static void DispatchGatherTest(UTexture2D* CombinedTexture, EMinraDemosaicAlgorithm Algorithm, EMinraCFAPattern Pattern, UTextureRenderTarget2D* Target)
+    {
+        FTextureResource* SourceResource = CombinedTexture->GetResource();
+        FTextureRenderTargetResource* TargetResource = Target->GameThread_GetRenderTargetResource();
+        const FIntPoint Size(CombinedTexture->GetSizeX(), CombinedTexture->GetSizeY());
+        const FIntPoint OutputSize(Target->SizeX, Target->SizeY);
+        const int32 AlgorithmIndex = static_cast<int32>(Algorithm);
+        const int32 PatternIndex = static_cast<int32>(Pattern);
+
+        ENQUEUE_RENDER_COMMAND(MinraDemosaicGatherTest)(
+            [SourceResource, TargetResource, Size, OutputSize, AlgorithmIndex, PatternIndex](FRHICommandListImmediate& RHICmdList)
+            {
+                FRDGBuilder GraphBuilder(RHICmdList);
+
+                FMinraDemosaicGatherTestCS::FParameters* Parameters = GraphBuilder.AllocParameters<FMinraDemosaicGatherTestCS::FParameters>();
+                Parameters->CombinedTexture = GraphBuilder.RegisterExternalTexture(CreateRenderTarget(SourceResource->TextureRHI, TEXT("MinraCombined")));
+                Parameters->CombinedSampler = TStaticSamplerState<SF_Point, AM_Clamp, AM_Clamp, AM_Clamp>::GetRHI();
+                Parameters->TextureSize = Size;
+                Parameters->OutMismatch = GraphBuilder.CreateUAV(GraphBuilder.RegisterExternalTexture(CreateRenderTarget(TargetResource->GetRenderTargetTexture(), TEXT("MinraGatherMismatch"))));
+
+                FMinraDemosaicGatherTestCS::FPermutationDomain Permutation;
+                Permutation.Set<FMinraDemosaicGatherTestCS::FAlgorithmDim>(AlgorithmIndex);
+                Permutation.Set<FMinraDemosaicGatherTestCS::FCFAPatternDim>(PatternIndex);
+                TShaderMapRef<FMinraDemosaicGatherTestCS> ComputeShader(GetGlobalShaderMap(GMaxRHIFeatureLevel), Permutation);
+
+                FComputeShaderUtils::AddPass(
+                    GraphBuilder,
+                    RDG_EVENT_NAME("MinraDemosaicGatherTest"),
+                    ComputeShader,
+                    Parameters,
+                    FComputeShaderUtils::GetGroupCount(OutputSize, FMinraDemosaicGatherTestCS::ThreadGroupSize));
+
+                GraphBuilder.Execute();
+            });
+
+        FlushRenderingCommands();
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMinraDemosaicGatherMatchesLoadTest, "MinraMosaique.Demosaic.GatherMatchesLoad",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FMinraDemosaicGatherMatchesLoadTest::RunTest(const FString& Parameters)
+{
+    using namespace MinraDemosaicTest;
+
+    if (!FMinraDemosaicCompute::IsSupported())
+    {
+        AddInfo(TEXT("Compute shaders unsupported in this process (null RHI or below SM5); skipped."));
+        return true;
+    }
+
+    UTexture2D* CombinedTexture = CreateCombinedTexture(MakeCombinedPixels(TestSize, 5678), TestSize);
+    if (!TestNotNull(TEXT("Combined texture"), CombinedTexture))
+    {
+        return false;
+    }
+
+    for (const EMinraDemosaicAlgorithm Algorithm : GetGPUAlgorithms())
+    {
+        const FIntPoint OutputSize = FMinraDemosaicCPU::GetOutputSize(TestSize.X, TestSize.Y, Algorithm);
+
+        for (const EMinraCFAPattern Pattern : AllPatterns)
+        {
+            const FString Case = FString::Printf(TEXT("%s/%s"), *GetName(Algorithm), *GetName(Pattern));
+
+            UTextureRenderTarget2D* Target = CreateTarget(OutputSize, PF_R8G8B8A8);
+            DispatchGatherTest(CombinedTexture, Algorithm, Pattern, Target);
+
+            TArray<FColor> Mismatch;
+            Target->GameThread_GetRenderTargetResource()->ReadPixels(Mismatch);
+
+            if (TestEqual(Case + TEXT(" readback size"), Mismatch.Num(), OutputSize.X * OutputSize.Y))
+            {
+                int32 NumMismatches = 0;
+                for (int32 Index = 0; Index < Mismatch.Num(); ++Index)
+                {
+                    const FColor& Flags = Mismatch[Index];
+                    if ((Flags.R | Flags.G | Flags.B) != 0 && NumMismatches++ == 0)
+                    {
+                        AddError(FString::Printf(TEXT("%s: gather and load results differ at (%d, %d) (images %s%s%s)."),
+                            *Case, Index % OutputSize.X, Index / OutputSize.X,
+                            Flags.R ? TEXT("1 ") : TEXT(""), Flags.G ? TEXT("2 ") : TEXT(""), Flags.B ? TEXT("3") : TEXT("")));
+                    }
+                }
+
+                if (NumMismatches > 1)
+                {
+                    AddError(FString::Printf(TEXT("%s: %d pixels differ between the gather and load paths."), *Case, NumMismatches));
+                }
+            }
+
+            Release({ Target });
+        }
+    }
+
+    Release({ CombinedTexture });
+    return true;
+}
+
+#endif
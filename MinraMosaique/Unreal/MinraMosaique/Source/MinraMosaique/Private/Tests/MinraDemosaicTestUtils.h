@@ -0,0 +1,121 @@
+// Copyright Minra. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "MinraDemosaicCPU.h"
+#include "Engine/Texture2D.h"
+#include "Engine/TextureRenderTarget2D.h"
+#include "Math/RandomStream.h"
+#include "RenderingThread.h"
+#include "TextureResource.h"
+
+/**
+ * Helpers shared by the demosaic automation tests: small combined images, GPU-readable
+ * textures and UAV render targets.
+ */
+namespace MinraDemosaicTest
+{
+    /** Odd in both axes, so partial quads, partial thread groups and both border paths are covered */
+    static const FIntPoint TestSize(37, 29);
+
+    /** Every CFAPattern value */
+    static const EMinraCFAPattern AllPatterns[] = { EMinraCFAPattern::RGGB, EMinraCFAPattern::BGGR, EMinraCFAPattern::GRBG, EMinraCFAPattern::GBRG };
+
+    /** Algorithms with a shader, in enum order */
+    inline TArray<EMinraDemosaicAlgorithm> GetGPUAlgorithms()
+    {
+        TArray<EMinraDemosaicAlgorithm> Algorithms;
+        const UEnum* Enum = StaticEnum<EMinraDemosaicAlgorithm>();
+
+        // The last entry is the generated _MAX
+        for (int32 Index = 0; Index < Enum->NumEnums() - 1; ++Index)
+        {
+            const EMinraDemosaicAlgorithm Algorithm = static_cast<EMinraDemosaicAlgorithm>(Enum->GetValueByIndex(Index));
+            if (!FMinraDemosaicCPU::IsCPUOnly(Algorithm))
+            {
+                Algorithms.Add(Algorithm);
+            }
+        }
+
+        return Algorithms;
+    }
+
+    inline FString GetName(EMinraDemosaicAlgorithm Algorithm)
+    {
+        return StaticEnum<EMinraDemosaicAlgorithm>()->GetNameStringByValue(static_cast<int64>(Algorithm));
+    }
+
+    inline FString GetName(EMinraCFAPattern Pattern)
+    {
+        return StaticEnum<EMinraCFAPattern>()->GetNameStringByValue(static_cast<int64>(Pattern));
+    }
+
+    /** Deterministic noise, the worst case for edge-sensitive kernels */
+    inline TArray<FColor> MakeCombinedPixels(FIntPoint Size, int32 Seed)
+    {
+        FRandomStream Random(Seed);
+        TArray<FColor> Pixels;
+        Pixels.SetNumUninitialized(Size.X * Size.Y);
+
+        for (FColor& Pixel : Pixels)
+        {
+            Pixel = FColor(Random.RandRange(0, 255), Random.RandRange(0, 255), Random.RandRange(0, 255), 255);
+        }
+
+        return Pixels;
+    }
+
+    /** Linear BGRA8 texture with point sampling, initialised on the render thread before returning */
+    inline UTexture2D* CreateCombinedTexture(const TArray<FColor>& Pixels, FIntPoint Size)
+    {
+        UTexture2D* Texture = UTexture2D::CreateTransient(Size.X, Size.Y, PF_B8G8R8A8);
+        if (!Texture)
+        {
+            return nullptr;
+        }
+
+        Texture->SRGB = false;
+        Texture->Filter = TF_Nearest;
+        Texture->NeverStream = true;
+
+        FTexture2DMipMap& Mip = Texture->GetPlatformData()->Mips[0];
+        void* Data = Mip.BulkData.Lock(LOCK_READ_WRITE);
+        FMemory::Memcpy(Data, Pixels.GetData(), Pixels.Num() * sizeof(FColor));
+        Mip.BulkData.Unlock();
+
+        Texture->AddToRoot();
+        Texture->UpdateResource();
+        FlushRenderingCommands();
+        return Texture;
+    }
+
+    /** UAV-capable linear render target */
+    inline UTextureRenderTarget2D* CreateTarget(FIntPoint Size, EPixelFormat Format)
+    {
+        UTextureRenderTarget2D* Target = NewObject<UTextureRenderTarget2D>(GetTransientPackage(), NAME_None, RF_Transient);
+        Target->bCanCreateUAV = true;
+        Target->ClearColor = FLinearColor::Black;
+        Target->InitCustomFormat(Size.X, Size.Y, Format, true);
+        Target->AddToRoot();
+        FlushRenderingCommands();
+        return Target;
+    }
+
+    /** Removes objects created by the helpers from the root set */
+    inline void Release(std::initializer_list<UObject*> Objects)
+    {
+        for (UObject* Object : Objects)
+        {
+            if (Object)
+            {
+                Object->RemoveFromRoot();
+            }
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,130 @@
+// Copyright Minra. All Rights Reserved.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "MinraQualityMetrics.h"
+#include "Math/RandomStream.h"
+
+BEGIN_DEFINE_SPEC(FMinraQualityMetricsSpec, "MinraMosaique.QualityMetrics",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::ServerContext |
+    EAutomationTestFlags::CommandletContext | EAutomationTestFlags::EngineFilter)
+
+    /** Wider than one MSE chunk and not a multiple of 4, so both remainders are covered */
+    static constexpr int32 Width = 141;
+    static constexpr int32 Height = 23;
+
+    /** Channel values stay below 255 - Offset, so the offset image never clips */
+    static constexpr int32 Offset = 10;
+
+    TArray<FColor> Original;
+
+END_DEFINE_SPEC(FMinraQualityMetricsSpec)
+
+void FMinraQualityMetricsSpec::Define()
+{
+    BeforeEach([this]()
+    {
+        FRandomStream Random(42);
+        Original.SetNumUninitialized(Width * Height);
+
+        for (FColor& Pixel : Original)
+        {
+            Pixel = FColor(Random.RandRange(0, 255 - Offset), Random.RandRange(0, 255 - Offset), Random.RandRange(0, 255 - Offset), 255);
+        }
+    });
+
+    Describe("Identical images", [this]()
+    {
+        It("have zero MSE and infinite PSNR", [this]()
+        {
+            TestEqual(TEXT("MSE"), FMinraQualityMetrics::ComputeMSE(Original, Original, Width, Height), 0.0);
+
+            const double PSNR = FMinraQualityMetrics::ComputePSNR(Original, Original, Width, Height);
+            TestTrue(TEXT("PSNR is +infinity"), PSNR > 0.0 && !FMath::IsFinite(PSNR));
+        });
+
+        It("have SSIM 1", [this]()
+        {
+            TestEqual(TEXT("SSIM"), FMinraQualityMetrics::ComputeSSIM(Original, Original, Width, Height), 1.0, 1e-6);
+        });
+
+        It("have Delta E 0", [this]()
+        {
+            TestEqual(TEXT("Delta E"), FMinraQualityMetrics::ComputeDeltaE(Original, Original, Width, Height), 0.0);
+        });
+
+        It("ignore alpha", [this]()
+        {
+            TArray<FColor> Reconstructed = Original;
+            for (FColor& Pixel : Reconstructed)
+            {
+                Pixel.A = 0;
+            }
+
+            TestEqual(TEXT("MSE"), FMinraQualityMetrics::ComputeMSE(Original, Reconstructed, Width, Height), 0.0);
+        });
+    });
+
+    Describe("A constant offset", [this]()
+    {
+        It("on all channels gives MSE = offset^2", [this]()
+        {
+            TArray<FColor> Reconstructed = Original;
+            for (FColor& Pixel : Reconstructed)
+            {
+                Pixel.R += Offset;
+                Pixel.G += Offset;
+                Pixel.B += Offset;
+            }
+
+            const double ExpectedMSE = Offset * Offset;
+            TestEqual(TEXT("MSE"), FMinraQualityMetrics::ComputeMSE(Original, Reconstructed, Width, Height), ExpectedMSE, 1e-9);
+            TestEqual(TEXT("PSNR"), FMinraQualityMetrics::ComputePSNR(Original, Reconstructed, Width, Height), 10.0 * FMath::LogX(10.0, 255.0 * 255.0 / ExpectedMSE), 1e-9);
+            TestTrue(TEXT("Delta E is positive"), FMinraQualityMetrics::ComputeDeltaE(Original, Reconstructed, Width, Height) > 0.0);
+        });
+
+        It("on one channel gives MSE = offset^2 / 3", [this]()
+        {
+            TArray<FColor> Reconstructed = Original;
+            for (FColor& Pixel : Reconstructed)
+            {
+                Pixel.G += Offset;
+            }
+
+            TestEqual(TEXT("MSE"), FMinraQualityMetrics::ComputeMSE(Original, Reconstructed, Width, Height), Offset * Offset / 3.0, 1e-9);
+        });
+    });
+
+    Describe("Mismatched sizes", [this]()
+    {
+        BeforeEach([this]()
+        {
+            AddExpectedError(TEXT("Metric inputs do not match"), EAutomationExpectedErrorFlags::Contains, 0);
+        });
+
+        It("return the error values", [this]()
+        {
+            TArray<FColor> Smaller = Original;
+            Smaller.RemoveAt(Smaller.Num() - Width, Width);
+
+            TestEqual(TEXT("MSE"), FMinraQualityMetrics::ComputeMSE(Original, Smaller, Width, Height), -1.0);
+            TestEqual(TEXT("PSNR"), FMinraQualityMetrics::ComputePSNR(Original, Smaller, Width, Height), -1.0);
+            TestEqual(TEXT("SSIM"), FMinraQualityMetrics::ComputeSSIM(Original, Smaller, Width, Height), -2.0);
+            TestEqual(TEXT("Delta E"), FMinraQualityMetrics::ComputeDeltaE(Original, Smaller, Width, Height), -1.0);
+
+            FMinraQualityReport Report;
+            TestFalse(TEXT("Compute"), FMinraQualityMetrics::Compute(Original, Smaller, Width, Height, Report));
+        });
+
+        It("reject a size that disagrees with both images", [this]()
+        {
+            TestEqual(TEXT("MSE"), FMinraQualityMetrics::ComputeMSE(Original, Original, Width + 1, Height), -1.0);
+            TestEqual(TEXT("MSE with zero height"), FMinraQualityMetrics::ComputeMSE(Original, Original, Width, 0), -1.0);
+        });
+    });
+}
+
+#endif
@@ -7,6 +7,10 @@
 #include "Engine/Texture2D.h"
 #include "MSQ3Asset.generated.h"
 
+class FMinraCookBake;
+class UAssetImportData;
+class UTexture2DArray;
+
 /**
  * Demosaicing algorithm selection.
  */
@@ -17,7 +21,49 @@ enum class EMinraDemosaicAlgorithm : uint8
     Bilinear UMETA(DisplayName = "Bilinear", ToolTip = "Fast 3x3 interpolation. Good quality for most use cases. Lower GPU cost."),
 
     /** Malvar-He-Cutler: High-quality 5x5 gradient-corrected interpolation. Better edge preservation at higher GPU cost. */
-    MalvarHeCutler UMETA(DisplayName = "Malvar-He-Cutler", ToolTip = "High-quality 5x5 gradient-corrected interpolation. Better edge preservation at higher GPU cost.")
+    MalvarHeCutler UMETA(DisplayName = "Malvar-He-Cutler", ToolTip = "High-quality 5x5 gradient-corrected interpolation. Better edge preservation at higher GPU cost."),
+
+    /** Superpixel: one RGB pixel per 2x2 quad. Half-resolution output at the lowest cost, for thumbnails and distant use. */
+    Superpixel UMETA(DisplayName = "Superpixel (Half Resolution)", ToolTip = "One RGB pixel per 2x2 Bayer quad, greens averaged. Half-resolution output at the lowest cost, for thumbnails and distant use."),
+
+    /** Nearest neighbour: each 2x2 quad's colour repeated over its four pixels. Full-resolution output at superpixel cost, for iteration previews and low-end platforms. */
+    NearestNeighbor UMETA(DisplayName = "Nearest Neighbor (Preview)", ToolTip = "Each 2x2 Bayer quad's colour (greens averaged) repeated over its four pixels. Full-resolution output at the lowest cost, for iteration previews and low-end platforms."),
+
+    /** Adaptive gradient-guided colour-difference demosaicing with zipper suppression. CPU bake and runtime only. */
+    AGCRD UMETA(DisplayName = "AGCRD (CPU)", ToolTip = "Edge-directed green, colour-difference red/blue and median zipper suppression. Highest quality; CPU bake and CPU runtime only."),
+
+    /** Frequency-aware colour-difference demosaicing. CPU bake and runtime only. */
+    FrequencyAware UMETA(DisplayName = "Frequency-Aware (CPU)", ToolTip = "Edge-directed green and colour-difference red/blue. CPU bake and CPU runtime only."),
+
+    /** Smooth hue transition demosaicing in the colour-ratio domain. CPU bake and runtime only. */
+    SmoothHue UMETA(DisplayName = "Smooth Hue (CPU)", ToolTip = "Edge-directed green and colour-ratio red/blue, preserving hue across edges. CPU bake and CPU runtime only."),
+
+    /** Adaptive homogeneity-directed: horizontal and vertical candidates chosen per pixel by CIELab homogeneity. CPU bake and runtime only. */
+    AHD UMETA(DisplayName = "AHD (CPU)", ToolTip = "Builds horizontal and vertical reconstructions and picks, per pixel, the one whose CIELab neighbourhood is more homogeneous. Least zippering on fine diagonal detail; CPU bake and CPU runtime only."),
+
+    /** Bilinear or MHC per 32x32 tile by gradient energy. CPU bake and runtime only. */
+    Auto UMETA(DisplayName = "Auto (Bilinear/MHC, CPU)", ToolTip = "Uses MHC on detailed tiles and Bilinear on flat or smooth ones, so cost follows image content. CPU bake and CPU runtime only.")
+};
+
+/**
+ * Bayer CFA layout, named by the top-left 2x2 block read row by row.
+ * MSQ3 files and the browser tool always use RGGB; the other layouts are for combined
+ * textures produced elsewhere. Values match MINRA_CFA_* in MinraDemosaic.ush.
+ */
+UENUM(BlueprintType)
+enum class EMinraCFAPattern : uint8
+{
+    /** Red at (0,0), blue at (1,1). Used by MSQ3. */
+    RGGB UMETA(DisplayName = "RGGB", ToolTip = "Red at (0,0), blue at (1,1). Used by MSQ3 and the browser tool."),
+
+    /** Blue at (0,0), red at (1,1). */
+    BGGR UMETA(DisplayName = "BGGR", ToolTip = "Blue at (0,0), red at (1,1)."),
+
+    /** Red at (1,0), blue at (0,1). */
+    GRBG UMETA(DisplayName = "GRBG", ToolTip = "Red at (1,0), blue at (0,1)."),
+
+    /** Red at (0,1), blue at (1,0). */
+    GBRG UMETA(DisplayName = "GBRG", ToolTip = "Red at (0,1), blue at (1,0).")
 };
 
 /**
@@ -44,10 +90,22 @@ public:
     UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "MSQ3")
     uint8 Quality;
 
-    /** Combined texture containing all 3 CFA channels in RGB */
+    /** Quality of each CFA channel (Image 1, 2, 3); differs from Quality only for quality-searched files */
+    UPROPERTY(VisibleAnywhere, Category = "MSQ3")
+    uint8 ChannelQuality[3];
+
+    /**
+     * Combined texture containing all 3 CFA channels in RGB.
+     * Set only for assets imported without libwebp (placeholder) or before CompressedData existed;
+     * use GetCombinedTexture, which decodes CompressedData on demand.
+     */
     UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "MSQ3")
     UTexture2D* CombinedTexture;
 
+    /** The imported .msq3 file, decoded into a transient combined texture on first use */
+    UPROPERTY()
+    TArray<uint8> CompressedData;
+
     /** Demosaicing algorithm to use */
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MSQ3")
     EMinraDemosaicAlgorithm Algorithm;
@@ -64,7 +122,40 @@ public:
     UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Baked")
     UTexture2D* BakedImage3;
 
-    /** Returns true if the asset has valid data */
+    /** Baked Image 1-3 as slices 0-2 of one texture array, when baked that way */
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Baked")
+    UTexture2DArray* BakedImageArray;
+
+#if WITH_EDITORONLY_DATA
+    /** Source .msq3 path and file hash, for reimport */
+    UPROPERTY(VisibleAnywhere, Instanced, Category = "ImportSettings")
+    UAssetImportData* AssetImportData;
+
+    /**
+     * Demosaic with Algorithm while cooking and ship those outputs instead of the baked textures.
+     * On for new imports; off for assets saved before it existed, so their cooked content is unchanged.
+     */
+    UPROPERTY(EditAnywhere, Category = "Cook")
+    bool bBakeOnCook = false;
+
+    /** Compression of cook-time outputs. Default lets each platform use its preferred format (BC, ASTC, ...). */
+    UPROPERTY(EditAnywhere, Category = "Cook", meta = (EditCondition = "bBakeOnCook"))
+    TEnumAsByte<TextureCompressionSettings> CookCompression = TC_Default;
+
+    /** Algorithm the baked textures were made with; a reimport rebakes all of them when Algorithm no longer matches */
+    UPROPERTY(VisibleAnywhere, Category = "Baked")
+    EMinraDemosaicAlgorithm BakedAlgorithm = EMinraDemosaicAlgorithm::Bilinear;
+
+    /** True if the baked textures have mip chains */
+    UPROPERTY(VisibleAnywhere, Category = "Baked")
+    bool bBakedMipmaps = true;
+
+    /** Set once BakedAlgorithm and bBakedMipmaps describe the baked textures; unset for assets baked before they existed */
+    UPROPERTY()
+    bool bBakeRecorded = false;
+#endif
+
+    /** Returns true if the asset has valid data (baked textures alone suffice, as in cooked builds) */
     UFUNCTION(BlueprintCallable, Category = "MSQ3")
     bool IsValid() const;
 
@@ -72,15 +163,94 @@ public:
     UFUNCTION(BlueprintCallable, Category = "MSQ3")
     bool HasBakedTextures() const;
 
-    /** Gets the best available texture for Image 1 (baked if available, otherwise combined for runtime) */
+    /** Returns true if a baked texture array is available */
+    UFUNCTION(BlueprintCallable, Category = "MSQ3")
+    bool HasBakedTextureArray() const;
+
+    /** Gets the baked texture array (Image 1-3 in slices 0-2), or nullptr if the asset was not baked to one */
+    UFUNCTION(BlueprintCallable, Category = "MSQ3")
+    UTexture2DArray* GetImageArray() const;
+
+    /**
+     * Gets the combined texture, decoding CompressedData on a worker thread on first use.
+     * The returned texture is valid at once and receives its pixels when the decode finishes
+     * (see IsCombinedTextureReady). Decoded textures share an LRU budget, r.MinraMosaique.DecodeCacheMB,
+     * and are decoded again after eviction. Game thread only.
+     */
+    UFUNCTION(BlueprintCallable, Category = "MSQ3")
+    UTexture2D* GetCombinedTexture() const;
+
+    /** Returns true if GetCombinedTexture's pixels are available without waiting for a decode */
+    UFUNCTION(BlueprintCallable, Category = "MSQ3")
+    bool IsCombinedTextureReady() const;
+
+    /** Drops the decoded combined texture; the next GetCombinedTexture decodes again */
+    UFUNCTION(BlueprintCallable, Category = "MSQ3")
+    void ReleaseDecodedData() const;
+
+    /**
+     * Decode CompressedData into combined pixels on the calling thread, for bakes and tools.
+     *
+     * @return True if the asset has compressed data and libwebp decoded it
+     */
+    bool DecodeCombinedPixels(TArray<FColor>& OutPixels) const;
+
+    /**
+     * Gets the best available texture for Image 1 (baked if available, otherwise combined for runtime).
+     * Assets baked only to a texture array have no per-image texture; this ensures and returns the
+     * combined texture. Use GetImageArray for them.
+     */
     UFUNCTION(BlueprintCallable, Category = "MSQ3")
     UTexture2D* GetImage1() const;
 
-    /** Gets the best available texture for Image 2 */
+    /** Gets the best available texture for Image 2. See GetImage1 for array-baked assets. */
     UFUNCTION(BlueprintCallable, Category = "MSQ3")
     UTexture2D* GetImage2() const;
 
-    /** Gets the best available texture for Image 3 */
+    /** Gets the best available texture for Image 3. See GetImage1 for array-baked assets. */
     UFUNCTION(BlueprintCallable, Category = "MSQ3")
     UTexture2D* GetImage3() const;
+
+    //~ Begin UObject Interface
+    virtual void PostInitProperties() override;
+#if WITH_EDITORONLY_DATA
+    virtual void GetAssetRegistryTags(TArray<FAssetRegistryTag>& OutTags) const override;
+#endif
+#if WITH_EDITOR
+    virtual void Serialize(FArchive& Ar) override;
+    virtual void PreSaveRoot(FObjectPreSaveRootContext ObjectSaveContext) override;
+    virtual void PostSaveRoot(FObjectPostSaveRootContext ObjectSaveContext) override;
+    virtual void BeginCacheForCookedPlatformData(const ITargetPlatform* TargetPlatform) override;
+    virtual bool IsCachedCookedPlatformDataLoaded(const ITargetPlatform* TargetPlatform) override;
+    virtual void ClearAllCachedCookedPlatformData() override;
+#endif
+    //~ End UObject Interface
+
+private:
+    /** GetImage1-3 result without a per-image baked texture */
+    UTexture2D* GetUnbakedImage() const;
+
+#if WITH_EDITORONLY_DATA
+    /** Outputs of the cook-time bake, saved in place of the baked textures in cooked packages */
+    UPROPERTY(Transient)
+    UTexture2D* CookedImages[3];
+
+    /** Array output of the cook-time bake, for assets baked to a texture array */
+    UPROPERTY(Transient)
+    UTexture2DArray* CookedImageArray;
+#endif
+
+#if WITH_EDITOR
+    /** Cook-time bake in progress or done, shared by all platforms of a cook */
+    TSharedPtr<FMinraCookBake> CookBake;
+
+    /** True once the cook-time bake has produced all three outputs */
+    bool HasCookedImages() const;
+
+    /** True when cooked data may leave out CombinedTexture and CompressedData */
+    bool CanStripCombinedForCook() const;
+
+    /** Set while a legacy CombinedTexture subobject is kept out of a cooked package */
+    bool bCombinedTextureStripped = false;
+#endif
 };
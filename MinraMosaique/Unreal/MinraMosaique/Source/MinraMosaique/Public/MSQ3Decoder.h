@@ -0,0 +1,113 @@
+// Copyright Minra. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// MSQ3 Format Constants
+namespace MSQ3
+{
+    const char MAGIC[5] = "MSQ3";
+
+    // Version 1: each channel is one full-resolution WebP of the interleaved CFA.
+    // Version 2: each channel is four quarter-resolution sub-planes (R, G1, G2, B).
+    const uint8 VERSION_INTERLEAVED = 1;
+    const uint8 VERSION_PLANE_PACKED = 2;
+    const int32 NUM_SUBPLANES = 4;
+
+    const int32 HEADER_SIZE = 14;
+    const int32 MAX_DIMENSION = 16384;
+
+    // Header layout: MAGIC(4) + VERSION(1) + WIDTH(4) + HEIGHT(4) + QUALITY(1)
+    const int32 VERSION_OFFSET = 4;
+    const int32 WIDTH_OFFSET = 5;
+    const int32 HEIGHT_OFFSET = 9;
+    const int32 QUALITY_OFFSET = 13;
+
+    // Set in the version byte when the channels were compressed at different qualities.
+    // Three quality bytes (R, G, B) then follow the header, and QUALITY_OFFSET holds the lowest.
+    const uint8 CHANNEL_QUALITY_FLAG = 0x80;
+    const int32 CHANNEL_QUALITY_OFFSET = 14;
+}
+
+/**
+ * MSQ3 Decoder
+ * Decodes MSQ3 binary format files containing 3 Bayer CFA patterns.
+ *
+ * File layout:
+ *   Header (14 bytes): "MSQ3", version, width (u32 LE), height (u32 LE), quality
+ *   Channel qualities (3 bytes, only with MSQ3::CHANNEL_QUALITY_FLAG in the version byte)
+ *   Data (v1): R, G, B channel records, each [size:u32 LE][WebP blob]
+ *   Data (v2): R, G, B channels, each four [size:u32 LE][WebP blob] sub-plane records
+ *              in R, G1, G2, B site order. Sub-planes are ceil(W/2) x ceil(H/2),
+ *              edge-replicated for odd dimensions.
+ */
+class MINRAMOSAIQUE_API FMinraMSQ3Decoder
+{
+public:
+    struct FMQ3Data
+    {
+        int32 Width = 0;
+        int32 Height = 0;
+        uint8 Quality = 0;
+        uint8 Version = 0;
+
+        // Quality of each channel (R, G, B); all equal to Quality unless the file records them
+        uint8 ChannelQuality[3] = { 0, 0, 0 };
+
+        // Channel payloads. v1: one WebP blob. v2: the channel's four sub-plane records.
+        TArray<uint8> ChannelR;
+        TArray<uint8> ChannelG;
+        TArray<uint8> ChannelB;
+
+        bool IsValid() const
+        {
+            return Width > 0 && Height > 0 &&
+                   ChannelR.Num() > 0 &&
+                   ChannelG.Num() > 0 &&
+                   ChannelB.Num() > 0;
+        }
+    };
+
+    /**
+     * Validates if data contains valid MSQ3 magic bytes.
+     */
+    static bool IsMSQ3Data(const TArray<uint8>& Data);
+
+    /**
+     * Decodes MSQ3 data from raw bytes.
+     */
+    static TSharedPtr<FMQ3Data> Decode(const TArray<uint8>& Data);
+
+    /**
+     * Decodes MSQ3 file from disk.
+     */
+    static TSharedPtr<FMQ3Data> DecodeFromFile(const FString& FilePath);
+
+    /**
+     * Decompresses one channel payload into a Width x Height CFA plane.
+     * v2 sub-planes are decoded in parallel and re-interleaved with SIMD.
+     *
+     * @return True if decoding was successful (requires libwebp)
+     */
+    static bool DecodeChannel(
+        const TArray<uint8>& Payload,
+        uint8 Version,
+        int32 Width,
+        int32 Height,
+        TArray<uint8>& OutCFA);
+
+    /**
+     * Decompresses all three channels in parallel and packs them into combined
+     * texture pixels (CFA 1 in R, CFA 2 in G, CFA 3 in B).
+     *
+     * @return True if decoding was successful (requires libwebp)
+     */
+    static bool DecodeCombinedPixels(const FMQ3Data& Data, TArray<FColor>& OutPixels);
+
+    /** Returns true if this build can read the given format version (without CHANNEL_QUALITY_FLAG). */
+    static bool IsSupportedVersion(uint8 Version)
+    {
+        return Version == MSQ3::VERSION_INTERLEAVED || Version == MSQ3::VERSION_PLANE_PACKED;
+    }
+};
@@ -0,0 +1,73 @@
+// Copyright Minra. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MSQ3Asset.h"
+#include "Misc/SecureHash.h"
+
+#if WITH_EDITOR
+
+/**
+ * Derived-data cache of bake results: the demosaiced images (and their mip chains, when
+ * the bake builds them) of one combined CFA image.
+ *
+ * Keys hash the combined pixels, size, algorithm, CFA pattern, output format and
+ * the kernel version (MINRA_BAKE_DDC_VERSION), so a hit is exactly what a bake would compute.
+ * With a shared DDC, artists and build machines reuse each other's bakes. Used by the
+ * editor bake and the cook-time bake; thread-safe.
+ */
+class MINRAMOSAIQUE_API FMinraBakeDDC
+{
+public:
+    /** Mip chains of Image1..3, mip 0 first */
+    using FMipChains = TArray<TArray<FColor>>[3];
+
+    /**
+     * Cache key of a bake.
+     *
+     * @param Combined Combined CFA pixels, Width x Height
+     * @param Algorithm Demosaicing algorithm
+     * @param Pattern Bayer layout
+     * @param OutputFormat What the bake stores, e.g. "BGRA8" or "BGRA8Mips"; part of the key
+     */
+    static FString BuildKey(
+        const TArray<FColor>& Combined,
+        int32 Width,
+        int32 Height,
+        EMinraDemosaicAlgorithm Algorithm,
+        EMinraCFAPattern Pattern,
+        const TCHAR* OutputFormat);
+
+    /** Cache key of a bake whose combined pixels were already hashed with HashPixels */
+    static FString BuildKey(
+        const FSHAHash& PixelHash,
+        int32 Width,
+        int32 Height,
+        EMinraDemosaicAlgorithm Algorithm,
+        EMinraCFAPattern Pattern,
+        const TCHAR* OutputFormat);
+
+    /** SHA-1 of combined pixels, as hashed into keys */
+    static FSHAHash HashPixels(const TArray<FColor>& Combined);
+
+    /** Kernel version hashed into every key; changes whenever bake output does */
+    static const TCHAR* GetVersion();
+
+    /**
+     * Fetch a bake result. Counts a hit or a miss.
+     *
+     * @param OutSize Size of mip 0
+     * @param OutMips Receive the mip chains
+     * @return True on a hit
+     */
+    static bool Get(const FString& Key, FIntPoint& OutSize, FMipChains& OutMips);
+
+    /** Store a bake result */
+    static void Put(const FString& Key, FIntPoint Size, const FMipChains& Mips);
+
+    /** Hits and misses since startup */
+    static void GetStats(int32& OutHits, int32& OutMisses);
+};
+
+#endif
@@ -0,0 +1,94 @@
+// Copyright Minra. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MSQ3Asset.h"
+
+#if WITH_EDITOR
+
+#include "Async/Future.h"
+
+class ITargetPlatform;
+class UTexture2DArray;
+
+/**
+ * Cook-time bake of one UMSQ3Asset or UMinraDemosaicTexture.
+ *
+ * Started from BeginCacheForCookedPlatformData: the combined pixels are read (or decoded)
+ * and demosaiced on a worker thread, so the cooker bakes many assets in parallel while it
+ * loads others. Once done, Poll creates the three output textures (or one 3-slice array, for
+ * assets baked to an array) as transient subobjects of the asset and has them cache the target
+ * platform's compressed format; the asset serializes them in place of its baked textures when cooking. Outputs are shared by all
+ * platforms of a cook; only the compression runs per platform.
+ *
+ * Each output's source id is a hash of the combined pixels and settings, so unchanged assets
+ * hit the texture derived-data cache on later cooks, and iterative cooks skip their packages.
+ */
+class MINRAMOSAIQUE_API FMinraCookBake
+{
+public:
+    /** Reads the combined CFA pixels. Runs on a worker thread. */
+    using FReadCombined = TFunction<bool(TArray<FColor>& OutPixels, int32& OutWidth, int32& OutHeight)>;
+
+    /**
+     * @param ReadCombined Source of the combined pixels
+     * @param Algorithm Demosaicing algorithm
+     * @param Pattern Bayer layout of the combined pixels
+     * @param Compression Compression of the outputs; TC_Default lets each platform pick its format
+     * @param bTextureArray Output one 3-slice texture array instead of three textures
+     * @param DebugName Asset name for logging
+     */
+    FMinraCookBake(
+        FReadCombined ReadCombined,
+        EMinraDemosaicAlgorithm Algorithm,
+        EMinraCFAPattern Pattern,
+        TextureCompressionSettings Compression,
+        bool bTextureArray,
+        const FString& DebugName);
+
+    /** True if this bake was started with these settings */
+    bool Matches(EMinraDemosaicAlgorithm InAlgorithm, EMinraCFAPattern InPattern, TextureCompressionSettings InCompression, bool bInTextureArray) const;
+
+    /**
+     * Advances the bake for a platform. Game thread only.
+     *
+     * @param Outer Asset that owns the outputs
+     * @param TargetPlatform Platform being cooked
+     * @param OutImages Receive the outputs once created; left null if the bake failed or makes an array
+     * @param OutImageArray Receives the array output once created; left null unless the bake makes an array
+     * @return True when nothing is left to wait for on this platform, including after a failure
+     */
+    bool Poll(UObject* Outer, const ITargetPlatform* TargetPlatform, UTexture2D* (&OutImages)[3], UTexture2DArray*& OutImageArray);
+
+private:
+    struct FResult
+    {
+        TArray<FColor> Images[3];
+        FIntPoint Size = FIntPoint::ZeroValue;
+        FGuid Ids[4];
+        bool bSucceeded = false;
+    };
+
+    EMinraDemosaicAlgorithm Algorithm;
+    EMinraCFAPattern Pattern;
+    TextureCompressionSettings Compression;
+    bool bTextureArray;
+    FString DebugName;
+
+    TSharedRef<FResult, ESPMode::ThreadSafe> Result;
+    TFuture<void> Task;
+
+    bool bTexturesCreated = false;
+
+    /** Platforms whose compression has been started */
+    TArray<const ITargetPlatform*> StartedPlatforms;
+
+    /** Creates the output textures from the finished result */
+    void CreateTextures(UObject* Outer, UTexture2D* (&OutImages)[3], UTexture2DArray*& OutImageArray);
+
+    /** Renames an output of an earlier bake out of the way */
+    static void ReleaseName(UObject* Outer, UClass* Class, FName Name);
+};
+
+#endif
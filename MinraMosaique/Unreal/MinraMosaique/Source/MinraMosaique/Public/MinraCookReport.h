@@ -0,0 +1,40 @@
+// Copyright Minra. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if WITH_EDITOR
+
+class ITargetPlatform;
+
+/**
+ * What the cook did to Minra Mosaique assets, written to Saved/MinraMosaique/CookReport.csv
+ * and summarised in the log when the cooking process exits.
+ *
+ * Assets with baked outputs drop their combined CFA data from cooked packages, since
+ * the runtime only reads the baked textures; each such asset is listed with the bytes
+ * it no longer carries. A combined texture that other packages still reference is listed
+ * with 0 bytes. Bytes are an upper bound when the cook includes a texture for reasons the
+ * asset registry does not show, such as DirectoriesToAlwaysCook. The bake cache's hits and
+ * misses (FMinraBakeDDC) are logged too.
+ */
+class MINRAMOSAIQUE_API FMinraCookReport
+{
+public:
+    /**
+     * Record an asset cooked without its combined data. A repeated save of the same
+     * asset for the same platform replaces the earlier entry.
+     *
+     * @param TargetPlatform Platform being cooked
+     * @param Asset The MSQ3 asset or demosaic texture
+     * @param Source What was stripped, e.g. "CompressedData" or the combined texture's path
+     * @param BytesSaved Bytes left out of the cooked data
+     */
+    static void AddStripped(const ITargetPlatform* TargetPlatform, const UObject* Asset, const FString& Source, int64 BytesSaved);
+
+    /** Logs the bake cache stats, then writes the CSV and logs the totals if any asset was recorded. Bound to engine pre-exit. */
+    static void Write();
+};
+
+#endif
@@ -0,0 +1,154 @@
+// Copyright Minra. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MSQ3Asset.h"
+
+class UTexture2D;
+
+/**
+ * CPU reference implementation of the demosaic shaders.
+ * Runs the same fused three-image kernels as the Bilinear, MHC, Superpixel and Nearest shaders
+ * (same taps, boundary rules and arithmetic order) with SIMD lanes holding the three
+ * CFAs and rows processed in parallel. Used for baking and as the headless fallback
+ * of UMinraDemosaicTexture; outputs match the GPU path up to float rounding.
+ * The colour-difference algorithms (see IsCPUOnly) exist only here.
+ */
+class MINRAMOSAIQUE_API FMinraDemosaicCPU
+{
+public:
+    /**
+     * Size of the demosaiced images for a combined image of Width x Height:
+     * the same size, or ceil(Width/2) x ceil(Height/2) for Superpixel.
+     */
+    static FIntPoint GetOutputSize(int32 Width, int32 Height, EMinraDemosaicAlgorithm Algorithm);
+
+    /**
+     * True for algorithms without a shader (AGCRD, FrequencyAware, SmoothHue, AHD, Auto).
+     * They run in the bake and in the CPU runtime path only.
+     */
+    static bool IsCPUOnly(EMinraDemosaicAlgorithm Algorithm);
+
+    /**
+     * Demosaic all three CFAs of a combined image (CFA 1 in R, CFA 2 in G, CFA 3 in B).
+     * Outputs have the size returned by GetOutputSize.
+     *
+     * @param Combined Combined CFA pixels, Width x Height
+     * @param Width Image width
+     * @param Height Image height
+     * @param Algorithm Demosaicing algorithm
+     * @param Pattern Bayer layout of the three CFAs
+     * @param OutImage1 Receives the image reconstructed from CFA 1
+     * @param OutImage2 Receives the image reconstructed from CFA 2
+     * @param OutImage3 Receives the image reconstructed from CFA 3
+     * @return True if demosaicing was successful
+     */
+    static bool Demosaic(
+        const TArray<FColor>& Combined,
+        int32 Width,
+        int32 Height,
+        EMinraDemosaicAlgorithm Algorithm,
+        EMinraCFAPattern Pattern,
+        TArray<FColor>& OutImage1,
+        TArray<FColor>& OutImage2,
+        TArray<FColor>& OutImage3);
+
+    /** Tile edge, in texels, of the Auto algorithm's Bilinear/MHC selection */
+    static constexpr int32 AUTO_TILE_SIZE = 32;
+
+    /**
+     * Auto uses MHC for tiles whose mean same-colour gradient (0-255 units, busiest CFA)
+     * exceeds this, and Bilinear elsewhere.
+     */
+    static constexpr float AUTO_MHC_THRESHOLD = 16.0f;
+
+    /**
+     * The Auto algorithm's per-tile choice, for debugging: ceil(Width/AUTO_TILE_SIZE) x
+     * ceil(Height/AUTO_TILE_SIZE) entries, row-major, 1 for MHC and 0 for Bilinear.
+     * Demosaic with Auto makes the same choice.
+     *
+     * @param Combined Combined CFA pixels, Width x Height
+     * @param Width Image width
+     * @param Height Image height
+     * @param OutSelection Receives the selection map
+     * @param OutTiles Receives the map size in tiles
+     * @return True if the input was valid
+     */
+    static bool ComputeAutoSelection(
+        const TArray<FColor>& Combined,
+        int32 Width,
+        int32 Height,
+        TArray<uint8>& OutSelection,
+        FIntPoint& OutTiles);
+
+    /**
+     * Demosaic with Auto, also returning the selection it used (see ComputeAutoSelection),
+     * so callers that report it need not compute it again.
+     */
+    static bool DemosaicAutoWithSelection(
+        const TArray<FColor>& Combined,
+        int32 Width,
+        int32 Height,
+        EMinraCFAPattern Pattern,
+        TArray<uint8>& OutSelection,
+        FIntPoint& OutTiles,
+        TArray<FColor>& OutImage1,
+        TArray<FColor>& OutImage2,
+        TArray<FColor>& OutImage3);
+
+    /**
+     * Read mip 0 of a texture as BGRA8 pixels.
+     * Prefers uncompressed source data in the editor, else uncompressed platform data.
+     */
+    static bool ReadTexturePixels(
+        UTexture2D* Texture,
+        TArray<FColor>& OutPixels,
+        int32& OutWidth,
+        int32& OutHeight);
+
+private:
+    /**
+     * Multi-pass colour-difference demosaicers (AGCRD, FrequencyAware, SmoothHue): green plane,
+     * then red/blue planes, then AGCRD's artifact suppression. Each pass is row-parallel.
+     */
+    static bool DemosaicAdaptive(
+        const TArray<FColor>& Combined,
+        int32 Width,
+        int32 Height,
+        EMinraDemosaicAlgorithm Algorithm,
+        FIntPoint Phase,
+        TArray<FColor>& OutImage1,
+        TArray<FColor>& OutImage2,
+        TArray<FColor>& OutImage3);
+
+    /**
+     * Bilinear or MHC per AUTO_TILE_SIZE tile, as chosen by ComputeAutoSelection; rows in parallel.
+     */
+    static bool DemosaicAuto(
+        const TArray<FColor>& Combined,
+        int32 Width,
+        int32 Height,
+        FIntPoint Phase,
+        TArray<uint8>& OutSelection,
+        FIntPoint& OutTiles,
+        TArray<FColor>& OutImage1,
+        TArray<FColor>& OutImage2,
+        TArray<FColor>& OutImage3);
+
+    /**
+     * Adaptive homogeneity-directed demosaicing, run in independent cache-sized tiles
+     * (each with its own apron) in parallel.
+     */
+    static bool DemosaicAHD(
+        const TArray<FColor>& Combined,
+        int32 Width,
+        int32 Height,
+        FIntPoint Phase,
+        TArray<FColor>& OutImage1,
+        TArray<FColor>& OutImage2,
+        TArray<FColor>& OutImage3);
+
+    /** Bytes of DemosaicAHD's working buffers for one worker thread, allocated once per worker per call */
+    static int64 GetAHDScratchBytes();
+};
@@ -0,0 +1,47 @@
+// Copyright Minra. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MSQ3Asset.h"
+
+class UTexture2D;
+class UTextureRenderTarget2D;
+
+/**
+ * GPU demosaic-once pass.
+ * Runs MinraDemosaicCS.usf over a combined texture and writes all three images
+ * into UAV-capable render targets in a single compute dispatch.
+ */
+class MINRAMOSAIQUE_API FMinraDemosaicCompute
+{
+public:
+    /** Number of output images written by one dispatch */
+    static constexpr int32 NUM_OUTPUTS = 3;
+
+    /**
+     * Returns true if this process can run the compute pass
+     * (rendering enabled, SM5-capable RHI).
+     */
+    static bool IsSupported();
+
+    /**
+     * Enqueue the demosaic pass. Game thread only; the work runs on the render thread.
+     * Targets must have FMinraDemosaicCPU::GetOutputSize and be created with bCanCreateUAV.
+     *
+     * @param CombinedTexture Source texture with CFA 1/2/3 in R/G/B
+     * @param Algorithm Demosaicing algorithm; FMinraDemosaicCPU::IsCPUOnly algorithms are rejected
+     * @param Pattern Bayer layout of the three CFAs
+     * @param Targets Receive Image1, Image2, Image3
+     * @param OnCompleted Called on the game thread once the render thread has run the pass (true)
+     *                    or skipped it because the source had no RHI texture (false). Only called
+     *                    when Dispatch returns true.
+     * @return True if the pass was enqueued
+     */
+    static bool Dispatch(
+        UTexture2D* CombinedTexture,
+        EMinraDemosaicAlgorithm Algorithm,
+        EMinraCFAPattern Pattern,
+        UTextureRenderTarget2D* const Targets[NUM_OUTPUTS],
+        TFunction<void(bool bRan)> OnCompleted = nullptr);
+};
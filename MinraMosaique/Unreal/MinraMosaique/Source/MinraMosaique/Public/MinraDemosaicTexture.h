@@ -8,10 +8,38 @@
 #include "MSQ3Asset.h"
 #include "MinraDemosaicTexture.generated.h"
 
+class FMinraCookBake;
+class UTexture2DArray;
+
+/**
+ * Inputs the runtime outputs were produced from. Any difference invalidates them.
+ */
+struct FMinraRuntimeOutputKey
+{
+    TWeakObjectPtr<UTexture2D> Source;
+    EMinraDemosaicAlgorithm Algorithm = EMinraDemosaicAlgorithm::Bilinear;
+    EMinraCFAPattern Pattern = EMinraCFAPattern::RGGB;
+    FIntPoint Size = FIntPoint::ZeroValue;
+
+    /** Source data id, so reimporting the combined texture in the editor is detected */
+    FGuid SourceId;
+
+    bool operator==(const FMinraRuntimeOutputKey& Other) const
+    {
+        return Source == Other.Source && Algorithm == Other.Algorithm && Pattern == Other.Pattern && Size == Other.Size && SourceId == Other.SourceId;
+    }
+};
+
 /**
  * Texture asset that holds a combined Bayer CFA texture and provides
  * demosaiced output textures. Can be used for editor-time baking or
  * runtime GPU demosaicing.
+ *
+ * Without baked textures, GetOutputTexture demosaics the combined texture once into three
+ * cached runtime textures that every material can share: render targets written by one
+ * compute pass, or transient textures from the CPU implementation when rendering is
+ * unavailable. They are refreshed when the source, algorithm or pattern changes and
+ * released on memory trim.
  */
 UCLASS(BlueprintType)
 class MINRAMOSAIQUE_API UMinraDemosaicTexture : public UObject
@@ -29,6 +57,14 @@ public:
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Settings", meta = (ToolTip = "Demosaicing algorithm to use for reconstruction."))
     EMinraDemosaicAlgorithm Algorithm;
 
+    /** Bayer layout of the combined texture. MSQ3 imports are always RGGB. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Settings", meta = (ToolTip = "Bayer layout of the combined texture. MSQ3 imports are always RGGB."))
+    EMinraCFAPattern CFAPattern;
+
+    /** Without baked textures, demosaic once into cached runtime textures instead of exposing the combined texture. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Settings", meta = (ToolTip = "Without baked textures, demosaic once into cached runtime textures shared by all materials, instead of exposing the raw combined texture."))
+    bool bDemosaicAtRuntime;
+
     /** Baked output texture for Image 1 (from R channel). */
     UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Baked Outputs", meta = (ToolTip = "Demosaiced output image reconstructed from the R channel CFA pattern."))
     UTexture2D* BakedImage1;
@@ -41,6 +77,23 @@ public:
     UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Baked Outputs", meta = (ToolTip = "Demosaiced output image reconstructed from the B channel CFA pattern."))
     UTexture2D* BakedImage3;
 
+    /** Baked Image 1-3 as slices 0-2 of one texture array, when baked that way. */
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Baked Outputs", meta = (ToolTip = "Demosaiced images 1-3 as slices 0-2 of one texture array: one resource and one sampler binding for all three."))
+    UTexture2DArray* BakedImageArray;
+
+#if WITH_EDITORONLY_DATA
+    /**
+     * Demosaic with the current settings while cooking and ship those outputs instead of the baked textures.
+     * On for new assets; off for assets saved before it existed, so their cooked content is unchanged.
+     */
+    UPROPERTY(EditAnywhere, Category = "Cook", meta = (ToolTip = "Demosaic with the current algorithm and pattern while cooking, in the target platform's texture format, and ship those outputs instead of the baked textures."))
+    bool bBakeOnCook = false;
+
+    /** Compression of cook-time outputs. Default lets each platform use its preferred format. */
+    UPROPERTY(EditAnywhere, Category = "Cook", meta = (EditCondition = "bBakeOnCook", ToolTip = "Compression of cook-time outputs. Default lets each platform use its preferred format (BC, ASTC, ...)."))
+    TEnumAsByte<TextureCompressionSettings> CookCompression = TC_Default;
+#endif
+
     /** Returns true if the combined texture is valid and ready for processing. */
     UFUNCTION(BlueprintCallable, Category = "Minra Mosaique")
     bool IsValid() const;
@@ -49,27 +102,132 @@ public:
     UFUNCTION(BlueprintCallable, Category = "Minra Mosaique")
     bool HasBakedTextures() const;
 
-    /** Gets the appropriate output texture for Image 1, preferring baked if available. */
+    /** Returns true if a baked texture array is available. */
+    UFUNCTION(BlueprintCallable, Category = "Minra Mosaique")
+    bool HasBakedTextureArray() const;
+
+    /** Gets the baked texture array (Image 1-3 in slices 0-2), or nullptr if not baked to one. */
+    UFUNCTION(BlueprintCallable, Category = "Minra Mosaique")
+    UTexture2DArray* GetImageArray() const;
+
+    /**
+     * Gets the appropriate output texture for Image 1, preferring baked if available.
+     * Assets baked only to a texture array have no per-image texture (and no combined texture
+     * once cooked); this ensures and returns the combined texture. Use GetImageArray or
+     * GetOutputTexture for them.
+     */
     UFUNCTION(BlueprintCallable, Category = "Minra Mosaique")
     UTexture2D* GetImage1() const;
 
-    /** Gets the appropriate output texture for Image 2, preferring baked if available. */
+    /** Gets the appropriate output texture for Image 2, preferring baked if available. See GetImage1 for array-baked assets. */
     UFUNCTION(BlueprintCallable, Category = "Minra Mosaique")
     UTexture2D* GetImage2() const;
 
-    /** Gets the appropriate output texture for Image 3, preferring baked if available. */
+    /** Gets the appropriate output texture for Image 3, preferring baked if available. See GetImage1 for array-baked assets. */
     UFUNCTION(BlueprintCallable, Category = "Minra Mosaique")
     UTexture2D* GetImage3() const;
 
+    /**
+     * Gets the output texture for Image 1-3: baked if available, else the baked texture array
+     * (Image N is slice N-1), else the cached runtime result (demosaiced on first use), else the
+     * combined texture.
+     * While the GPU pass is in flight this returns the render targets it writes; render
+     * commands run in order, so they are written before anything samples them. If the pass
+     * is skipped, the outputs stay invalid and the next call retries.
+     */
+    UFUNCTION(BlueprintCallable, Category = "Minra Mosaique")
+    UTexture* GetOutputTexture(int32 ImageNumber);
+
+    /** Returns true if runtime outputs exist and match the current source, algorithm and pattern. */
+    UFUNCTION(BlueprintCallable, Category = "Minra Mosaique")
+    bool HasRuntimeOutputs() const;
+
+    /** Releases the runtime outputs' memory. They are rebuilt on the next GetOutputTexture call. */
+    UFUNCTION(BlueprintCallable, Category = "Minra Mosaique")
+    void ReleaseRuntimeOutputs();
+
+    /** Releases the runtime outputs of every loaded instance. Bound to the memory trim delegate. */
+    static void ReleaseAllRuntimeOutputs();
+
     /** Creates an error/fallback texture for invalid inputs. */
     UFUNCTION(BlueprintCallable, Category = "Minra Mosaique")
     static UTexture2D* CreateFallbackTexture(int32 Width = 64, int32 Height = 64);
 
+    //~ Begin UObject Interface
+    virtual void PostInitProperties() override;
+    //~ End UObject Interface
+
 #if WITH_EDITOR
     /** Sets the baked output textures. Editor-only. */
     void SetBakedTextures(UTexture2D* Image1, UTexture2D* Image2, UTexture2D* Image3);
 
-    /** Clears the baked textures. Editor-only. */
+    /** Sets the baked texture array. Editor-only. */
+    void SetBakedTextureArray(UTexture2DArray* ImageArray);
+
+    /** Clears the baked textures and texture array. Editor-only. */
     void ClearBakedTextures();
+
+    //~ Begin UObject Interface
+    virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+    virtual void Serialize(FArchive& Ar) override;
+    virtual void PreSaveRoot(FObjectPreSaveRootContext ObjectSaveContext) override;
+    virtual void PostSaveRoot(FObjectPostSaveRootContext ObjectSaveContext) override;
+    virtual void BeginCacheForCookedPlatformData(const ITargetPlatform* TargetPlatform) override;
+    virtual bool IsCachedCookedPlatformDataLoaded(const ITargetPlatform* TargetPlatform) override;
+    virtual void ClearAllCachedCookedPlatformData() override;
+    //~ End UObject Interface
+#endif
+
+private:
+    /** Runtime outputs: render targets on the GPU path, transient textures on the CPU path */
+    UPROPERTY(Transient)
+    UTexture* RuntimeOutputs[3];
+
+    /** Inputs RuntimeOutputs were produced from */
+    FMinraRuntimeOutputKey RuntimeOutputKey;
+
+    /** False until RuntimeOutputs hold a complete result, and after release */
+    bool bRuntimeOutputsValid;
+
+    /** True while a GPU dispatch into RuntimeOutputs is enqueued but has not run yet */
+    bool bRuntimeOutputsPending;
+
+    /** Incremented by every update and release, so completions of superseded dispatches are ignored */
+    uint32 RuntimeOutputsSerial;
+
+    /** True if a pending dispatch was enqueued for the current source, algorithm and pattern */
+    bool IsRuntimeOutputUpdatePending() const;
+
+    /** GetImage1-3 result without a per-image baked texture */
+    UTexture2D* GetUnbakedImage() const;
+
+    /** Builds the key for the current source, algorithm and pattern */
+    FMinraRuntimeOutputKey MakeRuntimeOutputKey() const;
+
+    /** Demosaics the combined texture into RuntimeOutputs, reusing existing outputs where possible */
+    bool UpdateRuntimeOutputs();
+
+    /** GPU path: one compute dispatch into three render targets */
+    bool UpdateRuntimeOutputsGPU();
+
+    /** CPU path for headless processes (commandlets, -nullrhi) and r.MinraMosaique.ForceCPUDemosaic */
+    bool UpdateRuntimeOutputsCPU();
+
+#if WITH_EDITORONLY_DATA
+    /** Outputs of the cook-time bake, saved in place of the baked textures in cooked packages */
+    UPROPERTY(Transient)
+    UTexture2D* CookedImages[3];
+
+    /** Array output of the cook-time bake, for assets baked to a texture array */
+    UPROPERTY(Transient)
+    UTexture2DArray* CookedImageArray;
+#endif
+
+#if WITH_EDITOR
+    /** Cook-time bake in progress or done, shared by all platforms of a cook */
+    TSharedPtr<FMinraCookBake> CookBake;
+
+    /** True once the cook-time bake has produced all three outputs */
+    bool HasCookedImages() const;
 #endif
 };
@@ -0,0 +1,68 @@
+// Copyright Minra. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/GCObject.h"
+
+class UMSQ3Asset;
+class UTexture2D;
+
+/**
+ * Least-recently-used cache of combined textures decoded from UMSQ3Asset::CompressedData.
+ *
+ * A miss returns a new transient texture at once and decodes the WebP channels on a worker
+ * thread; the pixels are uploaded to that same texture on the game thread when ready, so
+ * materials bound to it early pick them up. Entries over r.MinraMosaique.DecodeCacheMB are
+ * dropped least recently used first (the texture is freed once nothing else references it)
+ * and decoded again on their next use. The cache is also emptied on memory trim.
+ *
+ * Game thread only.
+ */
+class MINRAMOSAIQUE_API FMinraMSQ3DecodeCache : public FGCObject
+{
+public:
+    static FMinraMSQ3DecodeCache& Get();
+
+    /**
+     * The decoded combined texture of an asset, starting its decode on a miss.
+     *
+     * @return The texture (possibly still decoding), or nullptr if the asset has no compressed data
+     */
+    UTexture2D* FindOrDecode(const UMSQ3Asset* Asset);
+
+    /** True if the asset's texture is cached and its pixels have arrived */
+    bool IsDecoded(const UMSQ3Asset* Asset) const;
+
+    /** Drops the asset's entry; its next use decodes again */
+    void Release(const UMSQ3Asset* Asset);
+
+    /** Drops every entry. Bound to the memory trim delegate. */
+    static void ReleaseAll();
+
+    /** Bytes of decoded pixels currently cached */
+    int64 GetCachedBytes() const;
+
+    //~ Begin FGCObject Interface
+    virtual void AddReferencedObjects(FReferenceCollector& Collector) override;
+    virtual FString GetReferencerName() const override;
+    //~ End FGCObject Interface
+
+private:
+    struct FEntry
+    {
+        TWeakObjectPtr<const UMSQ3Asset> Asset;
+        TObjectPtr<UTexture2D> Texture;
+        int64 Bytes = 0;
+        bool bDecoded = false;
+    };
+
+    /** Least recently used first */
+    TArray<FEntry> Entries;
+
+    /** Called on the game thread when a worker's pixels have been uploaded */
+    void OnDecoded(const UTexture2D* Texture);
+
+    /** Drops entries of destroyed assets, then the oldest entries until within budget, keeping the newest */
+    void Trim();
+};
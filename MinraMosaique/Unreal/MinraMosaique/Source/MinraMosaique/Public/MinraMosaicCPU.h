@@ -0,0 +1,40 @@
+// Copyright Minra. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MSQ3Asset.h"
+
+/**
+ * CPU mosaicing engine: builds the combined texture (CFA 1 in R, CFA 2 in G, CFA 3 in B)
+ * from three full-colour images, the C++ counterpart of mosaicing.js / mosaicing.py.
+ * One SIMD pass per row samples all three images into BGRA lanes; rows run in parallel.
+ */
+class MINRAMOSAIQUE_API FMinraMosaicCPU
+{
+public:
+    /**
+     * Mosaic three images of identical size into combined texture pixels.
+     *
+     * @param Image1 Source of CFA 1 (R channel)
+     * @param Image2 Source of CFA 2 (G channel)
+     * @param Image3 Source of CFA 3 (B channel)
+     * @param Width Width of all three images
+     * @param Height Height of all three images
+     * @param Pattern Bayer layout to sample; RGGB matches the browser tool and MSQ3 files
+     * @param bPrefilter Blur each image with a 3x3 binomial kernel before sampling, like a
+     *        camera's optical low-pass filter. Trades a little sharpness for less aliasing
+     *        (moire, false colour) on fine detail.
+     * @param OutCombined Receives Width x Height combined pixels
+     * @return True if the inputs were valid
+     */
+    static bool Mosaic(
+        const TArray<FColor>& Image1,
+        const TArray<FColor>& Image2,
+        const TArray<FColor>& Image3,
+        int32 Width,
+        int32 Height,
+        EMinraCFAPattern Pattern,
+        bool bPrefilter,
+        TArray<FColor>& OutCombined);
+};
@@ -35,4 +35,16 @@ public:
     {
         return FModuleManager::Get().IsModuleLoaded("MinraMosaique");
     }
+
+private:
+    /** Releases cached runtime demosaic outputs when the platform asks to trim memory */
+    FDelegateHandle MemoryTrimHandle;
+
+    /** Releases combined textures decoded from MSQ3 assets when the platform asks to trim memory */
+    FDelegateHandle DecodeCacheTrimHandle;
+
+#if WITH_EDITOR
+    /** Writes the cook report when a cooking process exits */
+    FDelegateHandle CookReportHandle;
+#endif
 };
@@ -0,0 +1,100 @@
+// Copyright Minra. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Quality of one reconstructed image against its original.
+ */
+struct FMinraQualityReport
+{
+    /** Mean squared error over R, G and B, in 0-255 units */
+    double MSE = 0.0;
+
+    /** Peak signal-to-noise ratio in dB; infinite for identical images */
+    double PSNR = 0.0;
+
+    /** Mean structural similarity over R, G and B (1 = identical) */
+    double SSIM = 0.0;
+
+    /** Mean CIE76 colour difference (Delta E*ab, sRGB D65) */
+    double DeltaE = 0.0;
+};
+
+/**
+ * Image quality metrics for BGRA8 images, matching the browser tool and the Python backend
+ * (backend/app/core/metrics.py): PSNR over RGB, and SSIM as scikit-image computes it
+ * (7x7 uniform window, sample covariance, K1 = 0.01, K2 = 0.03, data range 255).
+ * Rows run in parallel with the RGB channels in SIMD lanes; alpha is ignored.
+ */
+class MINRAMOSAIQUE_API FMinraQualityMetrics
+{
+public:
+    /**
+     * Mean squared error over R, G and B.
+     *
+     * @param Original Reference pixels, Width x Height
+     * @param Reconstructed Pixels to measure, same size
+     * @return MSE in 0-255 units, or -1 if the sizes do not match
+     */
+    static double ComputeMSE(
+        const TArray<FColor>& Original,
+        const TArray<FColor>& Reconstructed,
+        int32 Width,
+        int32 Height);
+
+    /**
+     * Peak signal-to-noise ratio over R, G and B.
+     *
+     * @return PSNR in dB, infinity for identical images, or -1 if the sizes do not match
+     */
+    static double ComputePSNR(
+        const TArray<FColor>& Original,
+        const TArray<FColor>& Reconstructed,
+        int32 Width,
+        int32 Height);
+
+    /**
+     * Structural similarity, per channel over every window that fits the image, then averaged.
+     * The window is 7x7, or the largest odd size that fits images smaller than that.
+     *
+     * @return SSIM in [-1, 1], or -2 if the sizes do not match
+     */
+    static double ComputeSSIM(
+        const TArray<FColor>& Original,
+        const TArray<FColor>& Reconstructed,
+        int32 Width,
+        int32 Height);
+
+    /**
+     * Mean CIE76 Delta E*ab between the two images, treating pixels as sRGB (D65).
+     * About 2.3 is a just noticeable difference.
+     *
+     * @return Mean Delta E, or -1 if the sizes do not match
+     */
+    static double ComputeDeltaE(
+        const TArray<FColor>& Original,
+        const TArray<FColor>& Reconstructed,
+        int32 Width,
+        int32 Height);
+
+    /**
+     * All metrics of one image.
+     *
+     * @return True if the sizes match
+     */
+    static bool Compute(
+        const TArray<FColor>& Original,
+        const TArray<FColor>& Reconstructed,
+        int32 Width,
+        int32 Height,
+        FMinraQualityReport& OutReport);
+
+private:
+    static bool IsValidPair(
+        const TArray<FColor>& Original,
+        const TArray<FColor>& Reconstructed,
+        int32 Width,
+        int32 Height);
+};
@@ -0,0 +1,54 @@
+// Copyright Minra. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Byte shuffling helpers shared by the MSQ3 codec and the CPU kernels.
+ * SSE2 on x86, NEON on ARM, scalar elsewhere.
+ */
+namespace MinraSIMD
+{
+    /**
+     * Interleaves two half-width rows: Out[2i] = A[i], Out[2i + 1] = B[i].
+     * Rebuilds a Bayer row from its two sub-plane rows (R/G1 or G2/B).
+     *
+     * @param Width Number of output bytes; A and B must hold (Width + 1) / 2 bytes
+     */
+    MINRAMOSAIQUE_API void InterleaveBytes(const uint8* A, const uint8* B, uint8* Out, int32 Width);
+
+    /**
+     * Splits a row into its even and odd bytes: OutA[i] = In[2i], OutB[i] = In[2i + 1].
+     * Inverse of InterleaveBytes. Odd widths replicate the last byte into OutB.
+     */
+    MINRAMOSAIQUE_API void DeinterleaveBytes(const uint8* In, uint8* OutA, uint8* OutB, int32 Width);
+
+    /**
+     * Packs three planes into BGRA pixels with opaque alpha: R from R, G from G, B from B.
+     * This is the combined texture layout (CFA1 in R, CFA2 in G, CFA3 in B).
+     */
+    MINRAMOSAIQUE_API void PackBGRA(const uint8* R, const uint8* G, const uint8* B, FColor* Out, int32 Count);
+
+    /**
+     * Doubles a row of pixels horizontally: Out[2i] = Out[2i + 1] = In[i].
+     * The horizontal half of a 2x2 nearest-neighbour upsample.
+     *
+     * @param Width Number of output pixels; In must hold (Width + 1) / 2 pixels
+     */
+    MINRAMOSAIQUE_API void DuplicatePixels(const FColor* In, FColor* Out, int32 Width);
+
+    /**
+     * Samples one row of a combined texture from three source rows: pixel X takes channel
+     * EvenChannel (even X) or OddChannel (odd X) of each source, Image1's into R, Image2's
+     * into G and Image3's into B, with opaque alpha. Channels are 0 = R, 1 = G, 2 = B.
+     */
+    MINRAMOSAIQUE_API void MosaicRow(
+        const FColor* Image1,
+        const FColor* Image2,
+        const FColor* Image3,
+        FColor* Out,
+        int32 Width,
+        int32 EvenChannel,
+        int32 OddChannel);
+}
@@ -0,0 +1,52 @@
+// Copyright Minra. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Thin wrapper around libwebp for the single-channel CFA planes stored in MSQ3 files.
+ * Planes are encoded the same way the browser tool does it: the grayscale value is
+ * replicated into R, G and B and compressed as lossy WebP. Decoding reads back R.
+ *
+ * libwebp is optional. Place it under Source/ThirdParty/libwebp to enable it;
+ * without it every call fails and IsAvailable() returns false.
+ */
+class MINRAMOSAIQUE_API FMinraWebP
+{
+public:
+    /** Returns true if the plugin was built with libwebp. */
+    static bool IsAvailable();
+
+    /**
+     * Encodes a grayscale plane as lossy WebP.
+     *
+     * @param Plane Width * Height bytes, row-major
+     * @param Quality Compression quality (0-100), same scale as the MSQ3 header
+     * @param OutData Receives the WebP blob
+     * @return True if encoding was successful
+     */
+    static bool EncodeGrayscale(
+        const uint8* Plane,
+        int32 Width,
+        int32 Height,
+        uint8 Quality,
+        TArray<uint8>& OutData);
+
+    /**
+     * Decodes a WebP blob into a grayscale plane.
+     *
+     * @param Data WebP blob
+     * @param DataSize Size of the blob in bytes
+     * @param ExpectedWidth Width the blob must have
+     * @param ExpectedHeight Height the blob must have
+     * @param OutPlane Receives ExpectedWidth * ExpectedHeight bytes
+     * @return True if decoding was successful
+     */
+    static bool DecodeGrayscale(
+        const uint8* Data,
+        int32 DataSize,
+        int32 ExpectedWidth,
+        int32 ExpectedHeight,
+        TArray<uint8>& OutPlane);
+};
@@ -41,7 +41,10 @@ public class MinraMosaiqueEditor : ModuleRules
                 "RenderCore",
                 "RHI",
                 "EditorFramework",
-                "ToolMenus"
+                "ToolMenus",
+                "ContentBrowser",
+                "ImageWrapper",
+                "Json"
             }
         );
 
@@ -0,0 +1,622 @@
+// Copyright Minra. All Rights Reserved.
+
+#include "MSQ3Encoder.h"
+#include "MSQ3Decoder.h"
+#include "MinraDemosaicCPU.h"
+#include "MinraMosaicCPU.h"
+#include "MinraQualityMetrics.h"
+#include "MinraSIMD.h"
+#include "MinraWebP.h"
+#include "Engine/Texture2D.h"
+#include "Async/ParallelFor.h"
+#include "Misc/FileHelper.h"
+#include "HAL/FileManager.h"
+#include "IImageWrapper.h"
+#include "IImageWrapperModule.h"
+#include "Modules/ModuleManager.h"
+
+namespace MinraMSQ3Encoder
+{
+    // Qualities tried per channel and search round: 0-100 settles in three rounds
+    const int32 SEARCH_PROBES = 4;
+
+    // Probes evaluated at once, each with full-resolution scratch; their encodes and
+    // demosaics are parallel inside, so more would add memory rather than speed
+    const int32 MAX_CONCURRENT_PROBES = 3;
+
+    /**
+     * One channel compressed at one quality.
+     */
+    struct FProbe
+    {
+        int32 Channel = 0;
+        int32 Quality = 0;
+        TArray<TArray<uint8>> Records;
+        int64 Bytes = 0;
+        double Score = 0.0;
+        bool bSucceeded = false;
+    };
+
+    /**
+     * Decode and demosaic buffers of one probe slot, reused by the probes it evaluates.
+     */
+    struct FProbeScratch
+    {
+        TArray<uint8> CFA;
+        TArray<FColor> Combined;
+        TArray<FColor> Images[3];
+    };
+
+    /**
+     * Compress one channel's planes and, for PSNR/SSIM targets, score the demosaiced result.
+     */
+    void EvaluateProbe(
+        FProbe& Probe,
+        const TArray<FColor>& Source,
+        const TArray<TArray<uint8>>& Planes,
+        int32 Width,
+        int32 Height,
+        const FMinraMSQ3EncodeSettings& Settings,
+        EMinraDemosaicAlgorithm Algorithm,
+        FProbeScratch& Scratch)
+    {
+        const int32 PlanesPerChannel = Settings.bPlanePacked ? MSQ3::NUM_SUBPLANES : 1;
+        const int32 PlaneWidth = Settings.bPlanePacked ? (Width + 1) / 2 : Width;
+        const int32 PlaneHeight = Settings.bPlanePacked ? (Height + 1) / 2 : Height;
+
+        // Sub-planes of a channel compress in parallel too
+        TArray<bool> bEncoded;
+        bEncoded.Init(false, PlanesPerChannel);
+        Probe.Records.SetNum(PlanesPerChannel);
+
+        ParallelFor(PlanesPerChannel, [&](int32 Plane)
+        {
+            bEncoded[Plane] = FMinraWebP::EncodeGrayscale(
+                Planes[Probe.Channel * PlanesPerChannel + Plane].GetData(),
+                PlaneWidth,
+                PlaneHeight,
+                static_cast<uint8>(Probe.Quality),
+                Probe.Records[Plane]);
+        });
+
+        if (bEncoded.Contains(false))
+        {
+            return;
+        }
+
+        // Channel payload as the decoder sees it: the blob (v1) or four [size][blob] records (v2)
+        TArray<uint8> Payload;
+        for (const TArray<uint8>& Record : Probe.Records)
+        {
+            Probe.Bytes += 4 + Record.Num();
+
+            if (Settings.bPlanePacked)
+            {
+                const uint32 Size = static_cast<uint32>(Record.Num());
+                Payload.Add(static_cast<uint8>(Size & 0xFF));
+                Payload.Add(static_cast<uint8>((Size >> 8) & 0xFF));
+                Payload.Add(static_cast<uint8>((Size >> 16) & 0xFF));
+                Payload.Add(static_cast<uint8>((Size >> 24) & 0xFF));
+            }
+            Payload.Append(Record);
+        }
+
+        if (Settings.Target == EMinraMSQ3QualityTarget::Bytes)
+        {
+            Probe.bSucceeded = true;
+            return;
+        }
+
+        // Demosaic the decoded CFA alone, from the R lane of a combined image. The kernels
+        // run the three lanes side by side in SIMD, so the empty lanes cost little compute;
+        // the slot's buffers are reused so they cost no allocations either.
+        const uint8 Version = Settings.bPlanePacked ? MSQ3::VERSION_PLANE_PACKED : MSQ3::VERSION_INTERLEAVED;
+        TArray<uint8>& CFA = Scratch.CFA;
+        if (!FMinraMSQ3Decoder::DecodeChannel(Payload, Version, Width, Height, CFA))
+        {
+            return;
+        }
+
+        TArray<FColor>& Combined = Scratch.Combined;
+        Combined.SetNumUninitialized(CFA.Num());
+        for (int32 Index = 0; Index < CFA.Num(); ++Index)
+        {
+            Combined[Index] = FColor(CFA[Index], 0, 0, 255);
+        }
+
+        TArray<FColor> (&Images)[3] = Scratch.Images;
+        if (!FMinraDemosaicCPU::Demosaic(Combined, Width, Height, Algorithm, EMinraCFAPattern::RGGB, Images[0], Images[1], Images[2]))
+        {
+            return;
+        }
+
+        Probe.Score = Settings.Target == EMinraMSQ3QualityTarget::PSNR
+            ? FMinraQualityMetrics::ComputePSNR(Source, Images[0], Width, Height)
+            : FMinraQualityMetrics::ComputeSSIM(Source, Images[0], Width, Height);
+        Probe.bSucceeded = true;
+    }
+
+    /**
+     * True if the probe meets the target. Monotonic in quality: PSNR and SSIM targets pass
+     * from some quality up, byte budgets up to some quality.
+     */
+    bool MeetsTarget(const FProbe& Probe, const FMinraMSQ3EncodeSettings& Settings, double ChannelBudget)
+    {
+        return Settings.Target == EMinraMSQ3QualityTarget::Bytes
+            ? Probe.Bytes <= ChannelBudget
+            : Probe.Score >= Settings.TargetValue;
+    }
+}
+
+bool FMinraMSQ3Encoder::EncodeImages(
+    const TArray<FColor>& Image1,
+    const TArray<FColor>& Image2,
+    const TArray<FColor>& Image3,
+    int32 Width,
+    int32 Height,
+    const FMinraMSQ3EncodeSettings& Settings,
+    TArray<uint8>& OutData)
+{
+    if (Width <= 0 || Height <= 0 || Width > MSQ3::MAX_DIMENSION || Height > MSQ3::MAX_DIMENSION)
+    {
+        UE_LOG(LogTemp, Error, TEXT("Minra Mosaique: Invalid MSQ3 dimensions: %dx%d"), Width, Height);
+        return false;
+    }
+
+    const int32 NumPixels = Width * Height;
+    if (Image1.Num() != NumPixels || Image2.Num() != NumPixels || Image3.Num() != NumPixels)
+    {
+        UE_LOG(LogTemp, Error, TEXT("Minra Mosaique: All three images must be %dx%d."), Width, Height);
+        return false;
+    }
+
+    if (!FMinraWebP::IsAvailable())
+    {
+        UE_LOG(LogTemp, Error, TEXT("Minra Mosaique: MSQ3 encoding requires libwebp (Source/ThirdParty/libwebp)."));
+        return false;
+    }
+
+    const TArray<FColor>* Sources[3] = { &Image1, &Image2, &Image3 };
+
+    // Planes to compress: 3 full CFAs (v1) or 3 x 4 sub-planes (v2)
+    const int32 PlanesPerChannel = Settings.bPlanePacked ? MSQ3::NUM_SUBPLANES : 1;
+    const int32 PlaneWidth = Settings.bPlanePacked ? (Width + 1) / 2 : Width;
+    const int32 PlaneHeight = Settings.bPlanePacked ? (Height + 1) / 2 : Height;
+
+    TArray<TArray<uint8>> Planes;
+    Planes.SetNum(3 * PlanesPerChannel);
+
+    // Sample all three images in one pass, as for a combined texture; channel N is CFA N+1
+    TArray<FColor> Combined;
+    if (!FMinraMosaicCPU::Mosaic(Image1, Image2, Image3, Width, Height, EMinraCFAPattern::RGGB, false, Combined))
+    {
+        return false;
+    }
+
+    ParallelFor(3, [&](int32 Channel)
+    {
+        TArray<uint8> CFA;
+        ExtractCFA(Combined, Channel, CFA);
+
+        if (Settings.bPlanePacked)
+        {
+            SplitSubPlanes(CFA, Width, Height, &Planes[Channel * MSQ3::NUM_SUBPLANES]);
+        }
+        else
+        {
+            Planes[Channel] = MoveTemp(CFA);
+        }
+    });
+
+    TArray<TArray<uint8>> Records;
+    uint8 ChannelQuality[3] = { Settings.Quality, Settings.Quality, Settings.Quality };
+
+    if (Settings.Target != EMinraMSQ3QualityTarget::Fixed)
+    {
+        if (!SearchChannelQuality(Sources, Planes, Width, Height, Settings, ChannelQuality, Records))
+        {
+            UE_LOG(LogTemp, Error, TEXT("Minra Mosaique: Failed to compress MSQ3 channel data."));
+            return false;
+        }
+    }
+    else
+    {
+        // Compress all planes concurrently
+        Records.SetNum(Planes.Num());
+        TArray<bool> bSucceeded;
+        bSucceeded.Init(false, Planes.Num());
+
+        ParallelFor(Planes.Num(), [&](int32 Index)
+        {
+            bSucceeded[Index] = FMinraWebP::EncodeGrayscale(Planes[Index].GetData(), PlaneWidth, PlaneHeight, Settings.Quality, Records[Index]);
+        });
+
+        if (bSucceeded.Contains(false))
+        {
+            UE_LOG(LogTemp, Error, TEXT("Minra Mosaique: Failed to compress MSQ3 channel data."));
+            return false;
+        }
+    }
+
+    const uint8 Version = Settings.bPlanePacked ? MSQ3::VERSION_PLANE_PACKED : MSQ3::VERSION_INTERLEAVED;
+    WriteMSQ3(Version, Width, Height, ChannelQuality, Records, OutData);
+    return true;
+}
+
+bool FMinraMSQ3Encoder::SearchChannelQuality(
+    const TArray<FColor>* const Sources[3],
+    const TArray<TArray<uint8>>& Planes,
+    int32 Width,
+    int32 Height,
+    const FMinraMSQ3EncodeSettings& Settings,
+    uint8 OutChannelQuality[3],
+    TArray<TArray<uint8>>& OutRecords)
+{
+    using namespace MinraMSQ3Encoder;
+
+    const bool bByteTarget = Settings.Target == EMinraMSQ3QualityTarget::Bytes;
+
+    // Header, channel-quality bytes, then an even share of what is left per channel
+    const double ChannelBudget = (Settings.TargetValue - MSQ3::HEADER_SIZE - 3) / 3.0;
+
+    const EMinraDemosaicAlgorithm Algorithm =
+        FMinraDemosaicCPU::GetOutputSize(Width, Height, Settings.MetricAlgorithm) == FIntPoint(Width, Height)
+        ? Settings.MetricAlgorithm
+        : EMinraDemosaicAlgorithm::Bilinear;
+
+    // The search runs on a step axis where passing is monotonic upwards: quality itself for
+    // PSNR/SSIM, 100 - quality for a byte budget. The answer of each channel is the lowest
+    // passing step in [Low, High]; High starts at 100, the fallback if nothing passes.
+    auto StepToQuality = [bByteTarget](int32 Step)
+    {
+        return bByteTarget ? 100 - Step : Step;
+    };
+
+    int32 Low[3] = { 0, 0, 0 };
+    int32 High[3] = { 100, 100, 100 };
+    TArray<FProbe> Probes;
+    int32 NumEncodes = 0;
+
+    // Each slot evaluates every MAX_CONCURRENT_PROBES-th probe of a round with its own buffers
+    FProbeScratch Scratch[MAX_CONCURRENT_PROBES];
+
+    auto RunProbes = [&](TArray<FProbe>& Round)
+    {
+        const int32 NumSlots = FMath::Min(Round.Num(), MAX_CONCURRENT_PROBES);
+        ParallelFor(NumSlots, [&](int32 Slot)
+        {
+            for (int32 Index = Slot; Index < Round.Num(); Index += NumSlots)
+            {
+                FProbe& Probe = Round[Index];
+                EvaluateProbe(Probe, *Sources[Probe.Channel], Planes, Width, Height, Settings, Algorithm, Scratch[Slot]);
+            }
+        });
+
+        NumEncodes += Round.Num();
+        for (const FProbe& Probe : Round)
+        {
+            if (!Probe.bSucceeded)
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    while (true)
+    {
+        // Up to SEARCH_PROBES evenly spaced steps in [Low, High) of every open channel
+        TArray<FProbe> Round;
+        for (int32 Channel = 0; Channel < 3; ++Channel)
+        {
+            const int32 Span = High[Channel] - Low[Channel];
+            const int32 Count = FMath::Min(SEARCH_PROBES, Span);
+
+            for (int32 Index = 1; Index <= Count; ++Index)
+            {
+                FProbe& Probe = Round.AddDefaulted_GetRef();
+                Probe.Channel = Channel;
+                Probe.Quality = StepToQuality(Low[Channel] + Span * Index / (Count + 1));
+            }
+        }
+
+        if (Round.Num() == 0)
+        {
+            break;
+        }
+
+        if (!RunProbes(Round))
+        {
+            return false;
+        }
+
+        // Probes are in ascending step order per channel. The first passing one bounds the
+        // answer from above, the failing ones below it bound it from below.
+        bool bPassed[3] = { false, false, false };
+        for (const FProbe& Probe : Round)
+        {
+            const int32 Step = StepToQuality(Probe.Quality); // the mapping is its own inverse
+            if (bPassed[Probe.Channel])
+            {
+                continue;
+            }
+
+            if (MeetsTarget(Probe, Settings, ChannelBudget))
+            {
+                High[Probe.Channel] = Step;
+                bPassed[Probe.Channel] = true;
+            }
+            else
+            {
+                Low[Probe.Channel] = Step + 1;
+            }
+        }
+
+        Probes.Append(MoveTemp(Round));
+    }
+
+    // Gather the records of each channel's answer, encoding it if it was never probed
+    const int32 PlanesPerChannel = Settings.bPlanePacked ? MSQ3::NUM_SUBPLANES : 1;
+    OutRecords.SetNum(3 * PlanesPerChannel);
+
+    TArray<FProbe> Missing;
+    for (int32 Channel = 0; Channel < 3; ++Channel)
+    {
+        const int32 Quality = StepToQuality(High[Channel]);
+        OutChannelQuality[Channel] = static_cast<uint8>(Quality);
+
+        FProbe* Found = Probes.FindByPredicate([Channel, Quality](const FProbe& Probe)
+        {
+            return Probe.Channel == Channel && Probe.Quality == Quality;
+        });
+
+        if (!Found)
+        {
+            FProbe& Probe = Missing.AddDefaulted_GetRef();
+            Probe.Channel = Channel;
+            Probe.Quality = Quality;
+        }
+        else if (!MeetsTarget(*Found, Settings, ChannelBudget))
+        {
+            UE_LOG(LogTemp, Warning, TEXT("Minra Mosaique: Channel %d cannot reach the quality target; using quality %d."), Channel + 1, Quality);
+        }
+    }
+
+    if (Missing.Num() > 0)
+    {
+        if (!RunProbes(Missing))
+        {
+            return false;
+        }
+
+        for (const FProbe& Probe : Missing)
+        {
+            if (!MeetsTarget(Probe, Settings, ChannelBudget))
+            {
+                UE_LOG(LogTemp, Warning, TEXT("Minra Mosaique: Channel %d cannot reach the quality target; using quality %d."), Probe.Channel + 1, Probe.Quality);
+            }
+        }
+
+        Probes.Append(MoveTemp(Missing));
+    }
+
+    for (FProbe& Probe : Probes)
+    {
+        if (Probe.Quality == OutChannelQuality[Probe.Channel])
+        {
+            for (int32 Plane = 0; Plane < PlanesPerChannel; ++Plane)
+            {
+                OutRecords[Probe.Channel * PlanesPerChannel + Plane] = MoveTemp(Probe.Records[Plane]);
+            }
+        }
+    }
+
+    UE_LOG(LogTemp, Log, TEXT("Minra Mosaique: Quality search chose %d/%d/%d after %d trial encodes."),
+        OutChannelQuality[0], OutChannelQuality[1], OutChannelQuality[2], NumEncodes);
+    return true;
+}
+
+bool FMinraMSQ3Encoder::EncodeTextures(
+    UTexture2D* Image1,
+    UTexture2D* Image2,
+    UTexture2D* Image3,
+    const FMinraMSQ3EncodeSettings& Settings,
+    TArray<uint8>& OutData)
+{
+    UTexture2D* Textures[3] = { Image1, Image2, Image3 };
+    TArray<FColor> Pixels[3];
+    int32 Widths[3] = { 0, 0, 0 };
+    int32 Heights[3] = { 0, 0, 0 };
+
+    for (int32 Index = 0; Index < 3; ++Index)
+    {
+        if (!FMinraDemosaicCPU::ReadTexturePixels(Textures[Index], Pixels[Index], Widths[Index], Heights[Index]))
+        {
+            UE_LOG(LogTemp, Error, TEXT("Minra Mosaique: Failed to read source texture for Image %d."), Index + 1);
+            return false;
+        }
+    }
+
+    if (Widths[1] != Widths[0] || Widths[2] != Widths[0] || Heights[1] != Heights[0] || Heights[2] != Heights[0])
+    {
+        UE_LOG(LogTemp, Error, TEXT("Minra Mosaique: Source textures must have identical dimensions."));
+        return false;
+    }
+
+    return EncodeImages(Pixels[0], Pixels[1], Pixels[2], Widths[0], Heights[0], Settings, OutData);
+}
+
+bool FMinraMSQ3Encoder::EncodeFiles(
+    const FString& Image1Path,
+    const FString& Image2Path,
+    const FString& Image3Path,
+    const FString& OutputPath,
+    const FMinraMSQ3EncodeSettings& Settings)
+{
+    const FString* Paths[3] = { &Image1Path, &Image2Path, &Image3Path };
+    TArray<FColor> Pixels[3];
+    int32 Widths[3] = { 0, 0, 0 };
+    int32 Heights[3] = { 0, 0, 0 };
+
+    for (int32 Index = 0; Index < 3; ++Index)
+    {
+        if (!LoadImageFile(*Paths[Index], Pixels[Index], Widths[Index], Heights[Index]))
+        {
+            UE_LOG(LogTemp, Error, TEXT("Minra Mosaique: Failed to load image: %s"), **Paths[Index]);
+            return false;
+        }
+    }
+
+    if (Widths[1] != Widths[0] || Widths[2] != Widths[0] || Heights[1] != Heights[0] || Heights[2] != Heights[0])
+    {
+        UE_LOG(LogTemp, Error, TEXT("Minra Mosaique: Source images must have identical dimensions: %s"), *Image1Path);
+        return false;
+    }
+
+    TArray<uint8> Data;
+    if (!EncodeImages(Pixels[0], Pixels[1], Pixels[2], Widths[0], Heights[0], Settings, Data))
+    {
+        return false;
+    }
+
+    if (!FFileHelper::SaveArrayToFile(Data, *OutputPath))
+    {
+        UE_LOG(LogTemp, Error, TEXT("Minra Mosaique: Failed to write MSQ3 file: %s"), *OutputPath);
+        return false;
+    }
+
+    return true;
+}
+
+bool FMinraMSQ3Encoder::LoadImageFile(
+    const FString& FilePath,
+    TArray<FColor>& OutPixels,
+    int32& OutWidth,
+    int32& OutHeight)
+{
+    TArray<uint8> FileData;
+    if (!FFileHelper::LoadFileToArray(FileData, *FilePath))
+    {
+        return false;
+    }
+
+    // Module loading is game-thread only; worker threads expect it to be loaded already
+    IImageWrapperModule& ImageWrapperModule = IsInGameThread()
+        ? FModuleManager::LoadModuleChecked<IImageWrapperModule>(FName("ImageWrapper"))
+        : FModuleManager::GetModuleChecked<IImageWrapperModule>(FName("ImageWrapper"));
+
+    EImageFormat Format = ImageWrapperModule.DetectImageFormat(FileData.GetData(), FileData.Num());
+    if (Format == EImageFormat::Invalid)
+    {
+        return false;
+    }
+
+    TSharedPtr<IImageWrapper> ImageWrapper = ImageWrapperModule.CreateImageWrapper(Format);
+    if (!ImageWrapper.IsValid() || !ImageWrapper->SetCompressed(FileData.GetData(), FileData.Num()))
+    {
+        return false;
+    }
+
+    TArray64<uint8> Raw;
+    if (!ImageWrapper->GetRaw(ERGBFormat::BGRA, 8, Raw))
+    {
+        return false;
+    }
+
+    OutWidth = static_cast<int32>(ImageWrapper->GetWidth());
+    OutHeight = static_cast<int32>(ImageWrapper->GetHeight());
+
+    OutPixels.SetNumUninitialized(OutWidth * OutHeight);
+    FMemory::Memcpy(OutPixels.GetData(), Raw.GetData(), OutPixels.Num() * sizeof(FColor));
+
+    return true;
+}
+
+void FMinraMSQ3Encoder::ExtractCFA(
+    const TArray<FColor>& Combined,
+    int32 Channel,
+    TArray<uint8>& OutCFA)
+{
+    OutCFA.SetNumUninitialized(Combined.Num());
+
+    for (int32 Index = 0; Index < Combined.Num(); ++Index)
+    {
+        const FColor& Pixel = Combined[Index];
+        OutCFA[Index] = Channel == 0 ? Pixel.R : (Channel == 1 ? Pixel.G : Pixel.B);
+    }
+}
+
+void FMinraMSQ3Encoder::SplitSubPlanes(
+    const TArray<uint8>& CFA,
+    int32 Width,
+    int32 Height,
+    TArray<uint8> OutSubPlanes[4])
+{
+    const int32 HalfWidth = (Width + 1) / 2;
+    const int32 HalfHeight = (Height + 1) / 2;
+
+    for (int32 SubPlane = 0; SubPlane < MSQ3::NUM_SUBPLANES; ++SubPlane)
+    {
+        OutSubPlanes[SubPlane].SetNumUninitialized(HalfWidth * HalfHeight);
+    }
+
+    for (int32 Row = 0; Row < HalfHeight; ++Row)
+    {
+        // Even source rows hold R/G1, odd rows G2/B. A missing last odd row repeats the last row.
+        const int32 EvenY = Row * 2;
+        const int32 OddY = FMath::Min(Row * 2 + 1, Height - 1);
+
+        MinraSIMD::DeinterleaveBytes(&CFA[EvenY * Width], &OutSubPlanes[0][Row * HalfWidth], &OutSubPlanes[1][Row * HalfWidth], Width);
+        MinraSIMD::DeinterleaveBytes(&CFA[OddY * Width], &OutSubPlanes[2][Row * HalfWidth], &OutSubPlanes[3][Row * HalfWidth], Width);
+    }
+}
+
+void FMinraMSQ3Encoder::WriteMSQ3(
+    uint8 Version,
+    int32 Width,
+    int32 Height,
+    const uint8 ChannelQuality[3],
+    const TArray<TArray<uint8>>& Records,
+    TArray<uint8>& OutData)
+{
+    auto WriteUInt32 = [&OutData](uint32 Value)
+    {
+        OutData.Add(static_cast<uint8>(Value & 0xFF));
+        OutData.Add(static_cast<uint8>((Value >> 8) & 0xFF));
+        OutData.Add(static_cast<uint8>((Value >> 16) & 0xFF));
+        OutData.Add(static_cast<uint8>((Value >> 24) & 0xFF));
+    };
+
+    const bool bChannelQuality = ChannelQuality[1] != ChannelQuality[0] || ChannelQuality[2] != ChannelQuality[0];
+    const uint8 Quality = FMath::Min3(ChannelQuality[0], ChannelQuality[1], ChannelQuality[2]);
+
+    int32 TotalSize = MSQ3::HEADER_SIZE + (bChannelQuality ? 3 : 0);
+    for (const TArray<uint8>& Record : Records)
+    {
+        TotalSize += 4 + Record.Num();
+    }
+
+    OutData.Reset(TotalSize);
+
+    // Header: MAGIC(4) + VERSION(1) + WIDTH(4) + HEIGHT(4) + QUALITY(1) = 14 bytes
+    OutData.Append(reinterpret_cast<const uint8*>(MSQ3::MAGIC), 4);
+    OutData.Add(bChannelQuality ? static_cast<uint8>(Version | MSQ3::CHANNEL_QUALITY_FLAG) : Version);
+    WriteUInt32(static_cast<uint32>(Width));
+    WriteUInt32(static_cast<uint32>(Height));
+    OutData.Add(Quality);
+
+    // Then, only when they differ: QUALITY(1) for each of R, G, B
+    if (bChannelQuality)
+    {
+        OutData.Append(ChannelQuality, 3);
+    }
+
+    // Then: SIZE(4) + DATA for each record, in R, G, B channel order
+    for (const TArray<uint8>& Record : Records)
+    {
+        WriteUInt32(static_cast<uint32>(Record.Num()));
+        OutData.Append(Record);
+    }
+
+    check(OutData.Num() == TotalSize);
+}
@@ -2,8 +2,13 @@
 
 #include "MSQ3Factory.h"
 #include "MSQ3Asset.h"
+#include "MSQ3Decoder.h"
+#include "MinraWebP.h"
 #include "Engine/Texture2D.h"
 #include "EditorFramework/AssetImportData.h"
+#include "MinraBakeUtility.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
 
 #define LOCTEXT_NAMESPACE "MSQ3Factory"
 
@@ -38,7 +43,7 @@ UObject* UMSSQ3Factory::FactoryCreateBinary(
 {
     // Validate magic bytes
     int32 DataSize = BufferEnd - Buffer;
-    if (DataSize < 14)
+    if (DataSize < MSQ3::HEADER_SIZE)
     {
         Warn->Logf(ELogVerbosity::Error, TEXT("Minra Mosaique: MSQ3 file too small."));
         return nullptr;
@@ -51,27 +56,27 @@ UObject* UMSSQ3Factory::FactoryCreateBinary(
     }
 
     // Read version
-    uint8 Version = Buffer[4];
-    if (Version != 1)
+    uint8 Version = static_cast<uint8>(Buffer[MSQ3::VERSION_OFFSET] & ~MSQ3::CHANNEL_QUALITY_FLAG);
+    if (!FMinraMSQ3Decoder::IsSupportedVersion(Version))
     {
         Warn->Logf(ELogVerbosity::Error, TEXT("Minra Mosaique: Unsupported MSQ3 version %d."), Version);
         return nullptr;
     }
 
-    // Read dimensions (little-endian)
-    auto ReadUInt32 = [](const uint8* Data) -> uint32
+    // Parse header and channel records (v1 and v2)
+    TArray<uint8> FileData(Buffer, DataSize);
+    TSharedPtr<FMinraMSQ3Decoder::FMQ3Data> Decoded = FMinraMSQ3Decoder::Decode(FileData);
+    if (!Decoded.IsValid())
     {
-        return Data[0] | (Data[1] << 8) | (Data[2] << 16) | (Data[3] << 24);
-    };
-
-    uint32 Width = ReadUInt32(Buffer + 5);
-    uint32 Height = ReadUInt32(Buffer + 9);
-    uint8 Quality = Buffer[13];
+        Warn->Logf(ELogVerbosity::Error, TEXT("Minra Mosaique: Failed to read MSQ3 header or channel data."));
+        return nullptr;
+    }
 
-    // Validate dimensions
-    if (Width == 0 || Height == 0 || Width > 16384 || Height > 16384)
+    // With libwebp available, decode once here so corrupt channels fail the import
+    TArray<FColor> CombinedPixels;
+    if (FMinraWebP::IsAvailable() && !FMinraMSQ3Decoder::DecodeCombinedPixels(*Decoded, CombinedPixels))
     {
-        Warn->Logf(ELogVerbosity::Error, TEXT("Minra Mosaique: Invalid dimensions %dx%d."), Width, Height);
+        Warn->Logf(ELogVerbosity::Error, TEXT("Minra Mosaique: Failed to decode MSQ3 WebP channels."));
         return nullptr;
     }
 
@@ -82,50 +87,34 @@ UObject* UMSSQ3Factory::FactoryCreateBinary(
         return nullptr;
     }
 
-    NewAsset->Width = static_cast<int32>(Width);
-    NewAsset->Height = static_cast<int32>(Height);
-    NewAsset->Quality = Quality;
+    NewAsset->Width = Decoded->Width;
+    NewAsset->Height = Decoded->Height;
+    NewAsset->Quality = Decoded->Quality;
+    FMemory::Memcpy(NewAsset->ChannelQuality, Decoded->ChannelQuality, sizeof(NewAsset->ChannelQuality));
     NewAsset->Algorithm = EMinraDemosaicAlgorithm::Bilinear;
+    NewAsset->AssetImportData->Update(CurrentFilename);
 
-    // Read channel data sizes and WebP blobs
-    // Note: Full implementation would decode WebP here
-    // For now, we store the raw data and create a placeholder texture
-
-    int32 Offset = 14;
+    // Keep the file itself; the combined texture is decoded on first use and never saved.
+    // Editors without libwebp keep it too, for editors that have it.
+    NewAsset->CompressedData = MoveTemp(FileData);
 
-    // Read R channel
-    if (Offset + 4 > DataSize)
+    if (FMinraWebP::IsAvailable())
     {
-        Warn->Logf(ELogVerbosity::Error, TEXT("Minra Mosaique: Unexpected end of file reading R channel size."));
-        return nullptr;
+        Warn->Logf(ELogVerbosity::Log,
+            TEXT("Minra Mosaique: Imported MSQ3 v%d file. Dimensions: %dx%d, Quality: %d/%d/%d, %d bytes stored."),
+            Version, NewAsset->Width, NewAsset->Height,
+            NewAsset->ChannelQuality[0], NewAsset->ChannelQuality[1], NewAsset->ChannelQuality[2],
+            NewAsset->CompressedData.Num());
     }
-    uint32 RSize = ReadUInt32(Buffer + Offset);
-    Offset += 4 + RSize;
-
-    // Read G channel
-    if (Offset + 4 > DataSize)
+    else
     {
-        Warn->Logf(ELogVerbosity::Error, TEXT("Minra Mosaique: Unexpected end of file reading G channel size."));
-        return nullptr;
-    }
-    uint32 GSize = ReadUInt32(Buffer + Offset);
-    Offset += 4 + GSize;
+        // Show a placeholder until an editor with libwebp decodes the file
+        NewAsset->CombinedTexture = CreatePlaceholderTexture(NewAsset->Width, NewAsset->Height);
 
-    // Read B channel
-    if (Offset + 4 > DataSize)
-    {
-        Warn->Logf(ELogVerbosity::Error, TEXT("Minra Mosaique: Unexpected end of file reading B channel size."));
-        return nullptr;
+        Warn->Logf(ELogVerbosity::Log,
+            TEXT("Minra Mosaique: Imported MSQ3 file. Dimensions: %dx%d, Quality: %d. WebP decoding requires external library."),
+            NewAsset->Width, NewAsset->Height, NewAsset->Quality);
     }
-    uint32 BSize = ReadUInt32(Buffer + Offset);
-
-    // Create a placeholder combined texture
-    // In a full implementation, you would decode the WebP channels and combine them
-    NewAsset->CombinedTexture = CreatePlaceholderTexture(NewAsset->Width, NewAsset->Height);
-
-    Warn->Logf(ELogVerbosity::Log,
-        TEXT("Minra Mosaique: Imported MSQ3 file. Dimensions: %dx%d, Quality: %d. WebP decoding requires external library."),
-        Width, Height, Quality);
 
     return NewAsset;
 }
@@ -186,22 +175,124 @@ UClass* UMSSQ3Factory::ResolveSupportedClass()
 bool UMSSQ3Factory::CanReimport(UObject* Obj, TArray<FString>& OutFilenames)
 {
     UMSQ3Asset* Asset = Cast<UMSQ3Asset>(Obj);
-    if (Asset)
+    if (Asset && Asset->AssetImportData)
     {
-        // Would need to store source file path in the asset
-        return false;
+        Asset->AssetImportData->ExtractFilenames(OutFilenames);
+        return true;
     }
     return false;
 }
 
 void UMSSQ3Factory::SetReimportPaths(UObject* Obj, const TArray<FString>& NewReimportPaths)
 {
-    // Store new reimport paths
+    UMSQ3Asset* Asset = Cast<UMSQ3Asset>(Obj);
+    if (Asset && Asset->AssetImportData && ensure(NewReimportPaths.Num() == 1))
+    {
+        Asset->AssetImportData->UpdateFilenameOnly(NewReimportPaths[0]);
+    }
 }
 
 EReimportResult::Type UMSSQ3Factory::Reimport(UObject* Obj)
 {
-    return EReimportResult::Failed;
+    UMSQ3Asset* Asset = Cast<UMSQ3Asset>(Obj);
+    if (!Asset || !Asset->AssetImportData)
+    {
+        return EReimportResult::Failed;
+    }
+
+    const FString Filename = Asset->AssetImportData->GetFirstFilename();
+    if (Filename.IsEmpty() || IFileManager::Get().FileSize(*Filename) == INDEX_NONE)
+    {
+        UE_LOG(LogTemp, Error, TEXT("Minra Mosaique: Cannot reimport %s, source file %s not found."), *Asset->GetName(), *Filename);
+        return EReimportResult::Failed;
+    }
+
+    // Same file as last time: nothing to do
+    FMD5Hash FileHash = FMD5Hash::HashFile(*Filename);
+    const TArray<FAssetImportInfo::FSourceFile>& SourceFiles = Asset->AssetImportData->GetSourceData().SourceFiles;
+    if (Asset->CompressedData.Num() > 0 && SourceFiles.Num() > 0 && FileHash.IsValid() && SourceFiles[0].FileHash == FileHash)
+    {
+        UE_LOG(LogTemp, Log, TEXT("Minra Mosaique: %s is unchanged, skipped reimport."), *Filename);
+        return EReimportResult::Succeeded;
+    }
+
+    TArray<uint8> FileData;
+    TSharedPtr<FMinraMSQ3Decoder::FMQ3Data> Decoded;
+    if (FFileHelper::LoadFileToArray(FileData, *Filename))
+    {
+        Decoded = FMinraMSQ3Decoder::Decode(FileData);
+    }
+
+    if (!Decoded.IsValid())
+    {
+        UE_LOG(LogTemp, Error, TEXT("Minra Mosaique: Failed to read MSQ3 header or channel data of %s."), *Filename);
+        return EReimportResult::Failed;
+    }
+
+    // As on import, corrupt channels fail before the asset is touched
+    if (FMinraWebP::IsAvailable())
+    {
+        TArray<FColor> CombinedPixels;
+        if (!FMinraMSQ3Decoder::DecodeCombinedPixels(*Decoded, CombinedPixels))
+        {
+            UE_LOG(LogTemp, Error, TEXT("Minra Mosaique: Failed to decode MSQ3 WebP channels of %s; %s is unchanged."), *Filename, *Asset->GetName());
+            return EReimportResult::Failed;
+        }
+    }
+
+    // Compare channel payloads with the stored file; only those that differ need decoding again
+    bool bChanged[3] = { true, true, true };
+    TSharedPtr<FMinraMSQ3Decoder::FMQ3Data> Previous = Asset->CompressedData.Num() > 0 ? FMinraMSQ3Decoder::Decode(Asset->CompressedData) : nullptr;
+    if (Previous.IsValid() && Previous->Width == Decoded->Width && Previous->Height == Decoded->Height && Previous->Version == Decoded->Version)
+    {
+        bChanged[0] = Previous->ChannelR != Decoded->ChannelR;
+        bChanged[1] = Previous->ChannelG != Decoded->ChannelG;
+        bChanged[2] = Previous->ChannelB != Decoded->ChannelB;
+    }
+
+    Asset->Modify();
+    Asset->Width = Decoded->Width;
+    Asset->Height = Decoded->Height;
+    Asset->Quality = Decoded->Quality;
+    FMemory::Memcpy(Asset->ChannelQuality, Decoded->ChannelQuality, sizeof(Asset->ChannelQuality));
+    Asset->CompressedData = MoveTemp(FileData);
+    Asset->AssetImportData->Update(Filename, &FileHash);
+
+    // Older imports switch to lazy decoding. Without libwebp the placeholder follows the new size.
+    if (FMinraWebP::IsAvailable())
+    {
+        Asset->CombinedTexture = nullptr;
+    }
+    else
+    {
+        Asset->CombinedTexture = CreatePlaceholderTexture(Asset->Width, Asset->Height);
+    }
+    Asset->ReleaseDecodedData();
+    Asset->MarkPackageDirty();
+
+    if ((bChanged[0] || bChanged[1] || bChanged[2]) && FMinraWebP::IsAvailable())
+    {
+        bool bRebaked = true;
+        if (Asset->HasBakedTextures() && !FMinraBakeUtility::RebakeMSQ3Channels(Asset, bChanged))
+        {
+            UE_LOG(LogTemp, Error, TEXT("Minra Mosaique: Failed to rebake the baked textures of %s; they still hold the previous images."), *Filename);
+            bRebaked = false;
+        }
+        if (Asset->HasBakedTextureArray() && !FMinraBakeUtility::RebakeMSQ3Array(Asset))
+        {
+            UE_LOG(LogTemp, Error, TEXT("Minra Mosaique: Failed to rebake the texture array of %s; it still holds the previous images."), *Filename);
+            bRebaked = false;
+        }
+
+        if (!bRebaked)
+        {
+            return EReimportResult::Failed;
+        }
+    }
+
+    UE_LOG(LogTemp, Log, TEXT("Minra Mosaique: Reimported %s, channels changed: %d/%d/%d."),
+        *Filename, bChanged[0], bChanged[1], bChanged[2]);
+    return EReimportResult::Succeeded;
 }
 
 #undef LOCTEXT_NAMESPACE
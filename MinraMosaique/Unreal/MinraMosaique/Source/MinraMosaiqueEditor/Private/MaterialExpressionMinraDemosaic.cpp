@@ -1,14 +1,33 @@
 // Copyright Minra. All Rights Reserved.
 
 #include "MaterialExpressionMinraDemosaic.h"
+#include "MinraDemosaicCPU.h"
 #include "MaterialCompiler.h"
+#include "Materials/MaterialExpressionCustom.h"
 #include "Materials/MaterialExpressionTextureBase.h"
 
+namespace MinraDemosaicExpression
+{
+    // Virtual path registered by FMinraMosaiqueModule::StartupModule
+    const TCHAR* INCLUDE_PATH = TEXT("/Plugin/MinraMosaique/MinraDemosaic.ush");
+    const TCHAR* ALGORITHM_DEFINE = TEXT("MINRA_DEMOSAIC_ALGORITHM");
+    const TCHAR* PATTERN_DEFINE = TEXT("MINRA_CFA_PATTERN");
+
+    // The CPU-only algorithms are hidden from the details panel; values set from code
+    // compile as MHC, the best algorithm with a shader
+    EMinraDemosaicAlgorithm GetShaderAlgorithm(EMinraDemosaicAlgorithm Algorithm)
+    {
+        return FMinraDemosaicCPU::IsCPUOnly(Algorithm) ? EMinraDemosaicAlgorithm::MalvarHeCutler : Algorithm;
+    }
+}
+
 #define LOCTEXT_NAMESPACE "MaterialExpressionMinraDemosaic"
 
 UMaterialExpressionMinraDemosaic::UMaterialExpressionMinraDemosaic(const FObjectInitializer& ObjectInitializer)
     : Super(ObjectInitializer)
     , Algorithm(EMinraDemosaicAlgorithm::Bilinear)
+    , CFAPattern(EMinraCFAPattern::RGGB)
+    , DemosaicCustom(nullptr)
 {
     // Set up the expression
     bShowOutputNameOnPin = true;
@@ -52,71 +71,108 @@ int32 UMaterialExpressionMinraDemosaic::Compile(class FMaterialCompiler* Compile
     // Get texture size for calculations
     int32 TextureSizeIndex = Compiler->TextureProperty(TextureCodeIndex, TMPP_Size);
 
-    // Calculate pixel position
-    int32 PixelPos = Compiler->Mul(CoordinatesIndex, TextureSizeIndex);
-
-    // Determine which channel to process based on output index
-    int32 ChannelIndex = Compiler->Constant(static_cast<float>(OutputIndex));
-
-    // The actual demosaicing is done in the shader
-    // For now, we generate custom HLSL code
-
-    FString CustomCode;
-    if (Algorithm == EMinraDemosaicAlgorithm::MalvarHeCutler)
-    {
-        CustomCode = GenerateMHCCode();
-    }
-    else
+    if (OutputIndex < 0 || OutputIndex > 2)
     {
-        CustomCode = GenerateBilinearCode();
+        return Compiler->Constant3(1.0f, 0.0f, 1.0f);
     }
 
-    // Use custom expression with the generated code
-    // This is a simplified implementation - full implementation would use Custom node
+    // All three outputs compile the same custom expression with the same inputs, so the
+    // translator shares one function and one call: output 0 is its return value (Image1),
+    // outputs 1 and 2 its Image2/Image3 out parameters.
+    TArray<int32> CompiledInputs;
+    CompiledInputs.Add(TextureCodeIndex);
+    CompiledInputs.Add(CoordinatesIndex);
+    CompiledInputs.Add(TextureSizeIndex);
 
-    // For this version, we output the channel directly as a placeholder
-    // A complete implementation would invoke the shader include
+    return Compiler->CustomExpression(GetDemosaicCustom(), OutputIndex, CompiledInputs);
+}
 
-    // Sample the texture
-    int32 SampleIndex = Compiler->TextureSample(TextureCodeIndex, CoordinatesIndex);
+UMaterialExpressionCustom* UMaterialExpressionMinraDemosaic::GetDemosaicCustom()
+{
+    using namespace MinraDemosaicExpression;
 
-    // Extract the appropriate channel based on output index
-    // This is simplified - real demosaicing requires the full algorithm
-    switch (OutputIndex)
+    if (!DemosaicCustom)
     {
-        case 0: // Image 1 - based on R channel CFA
-            return Compiler->ComponentMask(SampleIndex, true, false, false, false);
-        case 1: // Image 2 - based on G channel CFA
-            return Compiler->ComponentMask(SampleIndex, false, true, false, false);
-        case 2: // Image 3 - based on B channel CFA
-            return Compiler->ComponentMask(SampleIndex, false, false, true, false);
-        default:
-            return Compiler->Constant3(1.0f, 0.0f, 1.0f);
+        DemosaicCustom = NewObject<UMaterialExpressionCustom>(this, NAME_None, RF_Transient);
+        DemosaicCustom->Description = TEXT("MinraDemosaic");
+        DemosaicCustom->OutputType = CMOT_Float3;
+        DemosaicCustom->Code = GenerateDemosaicCode();
+        DemosaicCustom->IncludeFilePaths.Add(INCLUDE_PATH);
+
+        // Input order matches CompiledInputs in Compile(). A texture input named Tex
+        // also provides TexSampler to the function.
+        DemosaicCustom->Inputs.Empty();
+        for (const TCHAR* InputName : { TEXT("Tex"), TEXT("UV"), TEXT("TexSize") })
+        {
+            FCustomInput& Input = DemosaicCustom->Inputs.AddDefaulted_GetRef();
+            Input.InputName = InputName;
+        }
+
+        for (const TCHAR* OutputName : { TEXT("Image2"), TEXT("Image3") })
+        {
+            FCustomOutput& Output = DemosaicCustom->AdditionalOutputs.AddDefaulted_GetRef();
+            Output.OutputName = OutputName;
+            Output.OutputType = CMOT_Float3;
+        }
     }
-}
 
-FString UMaterialExpressionMinraDemosaic::GenerateBilinearCode() const
-{
-    // Generate HLSL code for bilinear demosaicing
-    // This would be used with a Custom expression node
-    return TEXT(R"(
-        // Bilinear demosaicing implementation
-        // See BilinearDemosaic.usf for full implementation
-    )");
+    // Algorithm and pattern are editable, so the defines are refreshed on every compile.
+    // Each combination compiles to its own straight-line shader.
+    DemosaicCustom->AdditionalDefines.Reset();
+
+    FCustomDefine& AlgorithmDefine = DemosaicCustom->AdditionalDefines.AddDefaulted_GetRef();
+    AlgorithmDefine.DefineName = ALGORITHM_DEFINE;
+    AlgorithmDefine.DefineValue = FString::FromInt(static_cast<int32>(GetShaderAlgorithm(Algorithm)));
+
+    FCustomDefine& PatternDefine = DemosaicCustom->AdditionalDefines.AddDefaulted_GetRef();
+    PatternDefine.DefineName = PATTERN_DEFINE;
+    PatternDefine.DefineValue = FString::FromInt(static_cast<int32>(CFAPattern));
+
+    return DemosaicCustom;
 }
 
-FString UMaterialExpressionMinraDemosaic::GenerateMHCCode() const
+FString UMaterialExpressionMinraDemosaic::GenerateDemosaicCode() const
 {
-    // Generate HLSL code for MHC demosaicing
-    return TEXT(R"(
-        // Malvar-He-Cutler demosaicing implementation
-        // See MHCDemosaic.usf for full implementation
-    )");
+    // MINRA_DEMOSAIC_ALGORITHM and MINRA_CFA_PATTERN are defined around this function, so only
+    // one call survives preprocessing and its phase argument is a constant
+    return TEXT(R"(float3 Image1;
+#if MINRA_DEMOSAIC_ALGORITHM == MINRA_DEMOSAIC_MHC
+MinraDemosaic_MHC(Tex, TexSampler, UV, TexSize, MINRA_CFA_PHASE(MINRA_CFA_PATTERN), Image1, Image2, Image3);
+#elif MINRA_DEMOSAIC_ALGORITHM == MINRA_DEMOSAIC_SUPERPIXEL
+MinraDemosaic_Superpixel(Tex, TexSampler, UV, TexSize, MINRA_CFA_PHASE(MINRA_CFA_PATTERN), Image1, Image2, Image3);
+#elif MINRA_DEMOSAIC_ALGORITHM == MINRA_DEMOSAIC_NEAREST
+MinraDemosaic_Nearest(Tex, TexSampler, UV, TexSize, MINRA_CFA_PHASE(MINRA_CFA_PATTERN), Image1, Image2, Image3);
+#else
+MinraDemosaic_Bilinear(Tex, TexSampler, UV, TexSize, MINRA_CFA_PHASE(MINRA_CFA_PATTERN), Image1, Image2, Image3);
+#endif
+return Image1;)");
 }
 
 void UMaterialExpressionMinraDemosaic::GetCaption(TArray<FString>& OutCaptions) const
 {
-    FString AlgorithmName = (Algorithm == EMinraDemosaicAlgorithm::MalvarHeCutler) ? TEXT("MHC") : TEXT("Bilinear");
+    FString AlgorithmName;
+    switch (MinraDemosaicExpression::GetShaderAlgorithm(Algorithm))
+    {
+        case EMinraDemosaicAlgorithm::MalvarHeCutler:
+            AlgorithmName = TEXT("MHC");
+            break;
+        case EMinraDemosaicAlgorithm::Superpixel:
+            AlgorithmName = TEXT("Superpixel");
+            break;
+        case EMinraDemosaicAlgorithm::NearestNeighbor:
+            AlgorithmName = TEXT("Nearest");
+            break;
+        default:
+            AlgorithmName = TEXT("Bilinear");
+            break;
+    }
+
+    // RGGB is the MSQ3 default, so only other layouts are shown
+    if (CFAPattern != EMinraCFAPattern::RGGB)
+    {
+        AlgorithmName += TEXT(", ") + StaticEnum<EMinraCFAPattern>()->GetNameStringByValue(static_cast<int64>(CFAPattern));
+    }
+
     OutCaptions.Add(FString::Printf(TEXT("Minra Mosaique (%s)"), *AlgorithmName));
 }
 
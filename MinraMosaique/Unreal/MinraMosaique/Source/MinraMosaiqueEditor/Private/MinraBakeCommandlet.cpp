@@ -0,0 +1,983 @@
+// Copyright Minra. All Rights Reserved.
+
+#include "MinraBakeCommandlet.h"
+#include "MinraBakeUtility.h"
+#include "MinraBakeScheduler.h"
+#include "MinraDemosaicCPU.h"
+#include "MinraDemosaicTexture.h"
+#include "MSQ3Asset.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "Dom/JsonObject.h"
+#include "Engine/Texture2D.h"
+#include "Engine/Texture2DArray.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformMemory.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+#include "IImageWrapperModule.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+#include "Modules/ModuleManager.h"
+#include "Serialization/JsonSerializer.h"
+#include "Tasks/Task.h"
+#include "UObject/Package.h"
+#include "UObject/StrongObjectPtr.h"
+
+namespace MinraBakeCommandlet
+{
+    /** Finished assets per journal flush; an interrupted run re-bakes at most this many */
+    constexpr int32 JOURNAL_BATCH = 16;
+
+    struct FBakeJob
+    {
+        FString ObjectPath;
+        FString Name;
+        FString OutputPath;
+
+        // Set on the game thread when the asset is loaded
+        TStrongObjectPtr<UObject> Asset;
+        EMinraDemosaicAlgorithm Algorithm = EMinraDemosaicAlgorithm::Bilinear;
+        EMinraCFAPattern Pattern = EMinraCFAPattern::RGGB;
+        bool bTextureArray = false;
+        int32 Width = 0;
+        int32 Height = 0;
+        int64 EstimatedBytes = 0;
+        bool bLowMemory = false;
+        int64 BytesIn = 0;
+
+        // Combined pixels; read on the game thread for textures, decoded by the task for MSQ3 data
+        TArray<FColor> SourcePixels;
+        UE::Tasks::TTask<void> Task;
+
+        // Set by the task
+        FMinraBakeUtility::FBakeImages Images;
+        bool bDemosaiced = false;
+        double BakeSeconds = 0.0;
+
+        // Set on the game thread once the task is done
+        bool bSucceeded = false;
+        double SaveSeconds = 0.0;
+        int64 BytesOut = 0;
+        int64 HeldBytes = 0;
+        TArray<FString> OutputFiles;
+        TArray<TWeakObjectPtr<UObject>> SavedObjects;
+    };
+
+    /**
+     * Loads the asset and reads its settings and size, enough to estimate the bake's footprint.
+     */
+    bool LoadJob(FBakeJob& Job, bool bForceArray, bool bGenerateMipmaps, const FMinraBakeScheduler& Scheduler)
+    {
+        UObject* Asset = LoadObject<UObject>(nullptr, *Job.ObjectPath);
+
+        if (UMSQ3Asset* MSQ3 = Cast<UMSQ3Asset>(Asset))
+        {
+            if (!MSQ3->IsValid())
+            {
+                return false;
+            }
+
+            // MSQ3 files are always RGGB
+            Job.Algorithm = MSQ3->Algorithm;
+            Job.Pattern = EMinraCFAPattern::RGGB;
+            Job.bTextureArray = bForceArray || MSQ3->HasBakedTextureArray();
+            Job.Width = MSQ3->Width;
+            Job.Height = MSQ3->Height;
+            Job.BytesIn = MSQ3->CompressedData.Num();
+        }
+        else if (UMinraDemosaicTexture* Texture = Cast<UMinraDemosaicTexture>(Asset))
+        {
+            if (!Texture->IsValid())
+            {
+                return false;
+            }
+
+            Job.Algorithm = Texture->Algorithm;
+            Job.Pattern = Texture->CFAPattern;
+            Job.bTextureArray = bForceArray || Texture->HasBakedTextureArray();
+            Job.Width = Texture->CombinedTexture->Source.GetSizeX();
+            Job.Height = Texture->CombinedTexture->Source.GetSizeY();
+        }
+        else
+        {
+            return false;
+        }
+
+        Job.Asset.Reset(Asset);
+        Job.bLowMemory = Scheduler.ShouldUseLowMemory(Job.Width, Job.Height, Job.Algorithm, bGenerateMipmaps);
+        Job.EstimatedBytes = FMinraBakeScheduler::EstimatePeakBytes(Job.Width, Job.Height, Job.Algorithm, bGenerateMipmaps, Job.bLowMemory);
+        return true;
+    }
+
+    /**
+     * Demosaics on a worker: decodes MSQ3 data, then demosaic and mip chains. Everything after
+     * the game-thread read runs here, so assets overlap each other as well as their own rows.
+     */
+    void RunJob(FBakeJob& Job, bool bGenerateMipmaps)
+    {
+        const double StartTime = FPlatformTime::Seconds();
+
+        if (Job.SourcePixels.Num() == 0)
+        {
+            const UMSQ3Asset* MSQ3 = CastChecked<UMSQ3Asset>(Job.Asset.Get());
+            if (!MSQ3->DecodeCombinedPixels(Job.SourcePixels) || Job.SourcePixels.Num() != Job.Width * Job.Height)
+            {
+                Job.BakeSeconds = FPlatformTime::Seconds() - StartTime;
+                return;
+            }
+        }
+
+        Job.bDemosaiced = FMinraBakeUtility::DemosaicPixels(
+            Job.SourcePixels, Job.Width, Job.Height, Job.Algorithm, Job.Pattern, bGenerateMipmaps, Job.Name, Job.Images, Job.bLowMemory);
+
+        // Mip 0 and mip 1 are done with the combined pixels
+        Job.SourcePixels.Empty();
+
+        if (Job.bDemosaiced)
+        {
+            // Chains build here too, so the save on the game thread never waits for them
+            Job.Images.Finish();
+        }
+        Job.BakeSeconds = FPlatformTime::Seconds() - StartTime;
+    }
+
+    /**
+     * Reads what the task cannot (texture source data) and starts the task.
+     */
+    bool LaunchJob(FBakeJob& Job, bool bGenerateMipmaps)
+    {
+        UMSQ3Asset* MSQ3 = Cast<UMSQ3Asset>(Job.Asset.Get());
+        UTexture2D* CombinedTexture = MSQ3 ? MSQ3->CombinedTexture : CastChecked<UMinraDemosaicTexture>(Job.Asset.Get())->CombinedTexture;
+
+        // Demosaic textures, and MSQ3 assets imported before CompressedData existed
+        if (!MSQ3 || MSQ3->CompressedData.Num() == 0)
+        {
+            if (!FMinraDemosaicCPU::ReadTexturePixels(CombinedTexture, Job.SourcePixels, Job.Width, Job.Height))
+            {
+                return false;
+            }
+            Job.BytesIn = Job.SourcePixels.Num() * sizeof(FColor);
+        }
+
+        Job.Task = UE::Tasks::Launch(UE_SOURCE_LOCATION, [&Job, bGenerateMipmaps]()
+        {
+            RunJob(Job, bGenerateMipmaps);
+        });
+        return true;
+    }
+
+    /**
+     * Writes the outputs, assigns them to the asset and saves both. Game thread only.
+     */
+    void SaveJob(FBakeJob& Job, bool bGenerateMipmaps)
+    {
+        const double StartTime = FPlatformTime::Seconds();
+        UObject* Asset = Job.Asset.Get();
+        UMSQ3Asset* MSQ3 = Cast<UMSQ3Asset>(Asset);
+        UMinraDemosaicTexture* Texture = Cast<UMinraDemosaicTexture>(Asset);
+
+        bool bAssigned = false;
+        if (!Job.bDemosaiced)
+        {
+            UE_LOG(LogTemp, Error, TEXT("Minra Mosaique: Failed to demosaic %s."), *Job.ObjectPath);
+        }
+        else if (Job.bTextureArray)
+        {
+            if (UTexture2DArray* ImageArray = FMinraBakeUtility::SaveBakedTextureArray(Job.Images, Job.OutputPath, Job.Name))
+            {
+                if (MSQ3)
+                {
+                    MSQ3->Modify();
+                    MSQ3->BakedImageArray = ImageArray;
+                    MSQ3->BakedAlgorithm = Job.Algorithm;
+                    MSQ3->bBakedMipmaps = bGenerateMipmaps;
+                    MSQ3->bBakeRecorded = true;
+                }
+                else
+                {
+                    Texture->SetBakedTextureArray(ImageArray);
+                }
+
+                Job.SavedObjects.Add(ImageArray);
+                bAssigned = true;
+            }
+        }
+        else
+        {
+            UTexture2D* Textures[3];
+            if (FMinraBakeUtility::SaveBakedTextures(Job.Images, Job.OutputPath, Job.Name, Textures))
+            {
+                if (MSQ3)
+                {
+                    MSQ3->Modify();
+                    MSQ3->BakedImage1 = Textures[0];
+                    MSQ3->BakedImage2 = Textures[1];
+                    MSQ3->BakedImage3 = Textures[2];
+                    MSQ3->BakedAlgorithm = Job.Algorithm;
+                    MSQ3->bBakedMipmaps = bGenerateMipmaps;
+                    MSQ3->bBakeRecorded = true;
+                }
+                else
+                {
+                    Texture->SetBakedTextures(Textures[0], Textures[1], Textures[2]);
+                }
+
+                for (UTexture2D* Output : Textures)
+                {
+                    Job.SavedObjects.Add(Output);
+                }
+                bAssigned = true;
+            }
+        }
+
+        for (const TWeakObjectPtr<UObject>& Saved : Job.SavedObjects)
+        {
+            Job.OutputFiles.Add(FPackageName::LongPackageNameToFilename(Saved->GetOutermost()->GetName(), FPackageName::GetAssetPackageExtension()));
+        }
+
+        Job.bSucceeded = bAssigned && FMinraBakeUtility::SaveAssetPackage(Asset);
+        if (bAssigned)
+        {
+            Job.SavedObjects.Add(Asset);
+        }
+
+        // The textures keep a copy of the chains, and their packages another until the writes finish
+        for (TArray<TArray<FColor>>& Mips : Job.Images.Mips)
+        {
+            for (const TArray<FColor>& Mip : Mips)
+            {
+                Job.HeldBytes += bAssigned ? Mip.Num() * sizeof(FColor) * 2 : 0;
+            }
+            Mips.Empty();
+        }
+
+        Job.SaveSeconds = FPlatformTime::Seconds() - StartTime;
+    }
+
+    /**
+     * Waits for the async package writes of finished assets, then journals them and lets
+     * garbage collection release them with their pixel data.
+     */
+    void FlushJournal(TArray<FBakeJob*>& Written, const FString& JournalPath, FMinraBakeScheduler& Scheduler)
+    {
+        UPackage::WaitForAsyncFileWrites();
+
+        FString Lines;
+        for (FBakeJob* Job : Written)
+        {
+            for (const FString& File : Job->OutputFiles)
+            {
+                Job->BytesOut += FMath::Max<int64>(IFileManager::Get().FileSize(*File), 0);
+            }
+
+            if (Job->bSucceeded)
+            {
+                Lines += Job->ObjectPath + LINE_TERMINATOR;
+            }
+
+            // On disk now; nothing else needs them in memory
+            for (const TWeakObjectPtr<UObject>& Saved : Job->SavedObjects)
+            {
+                if (Saved.IsValid())
+                {
+                    Saved->ClearFlags(RF_Standalone);
+                }
+            }
+            Job->SavedObjects.Empty();
+            Job->Asset.Reset();
+        }
+
+        if (!Lines.IsEmpty() &&
+            !FFileHelper::SaveStringToFile(Lines, *JournalPath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM, &IFileManager::Get(), FILEWRITE_Append))
+        {
+            UE_LOG(LogTemp, Warning, TEXT("Minra Mosaique: Failed to write %s."), *JournalPath);
+        }
+
+        CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+
+        for (FBakeJob* Job : Written)
+        {
+            Scheduler.ReleaseHeld(Job->HeldBytes);
+            Job->HeldBytes = 0;
+        }
+        Written.Reset();
+    }
+
+    /** Files of the coordinator and its worker processes */
+    FString GetShardDir()
+    {
+        return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("MinraMosaique"), TEXT("Shards"));
+    }
+
+    void SaveJson(const TSharedRef<FJsonObject>& Object, const FString& FilePath)
+    {
+        FString Json;
+        TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Json);
+        FJsonSerializer::Serialize(Object, Writer);
+
+        if (!FFileHelper::SaveStringToFile(Json, *FilePath))
+        {
+            UE_LOG(LogTemp, Warning, TEXT("Minra Mosaique: Failed to write %s."), *FilePath);
+        }
+    }
+
+    /** Summary entry of an asset an earlier run already baked */
+    TSharedRef<FJsonValueObject> MakeSkippedResult(const FString& ObjectPath)
+    {
+        TSharedRef<FJsonObject> Entry = MakeShared<FJsonObject>();
+        Entry->SetStringField(TEXT("Asset"), ObjectPath);
+        Entry->SetBoolField(TEXT("Succeeded"), true);
+        Entry->SetBoolField(TEXT("Skipped"), true);
+        return MakeShared<FJsonValueObject>(Entry);
+    }
+
+    /**
+     * Writes the per-asset and total figures as JSON; resumed assets are listed as skipped.
+     */
+    void WriteSummary(
+        const TArray<TUniquePtr<FBakeJob>>& Jobs,
+        const TArray<FString>& Resumed,
+        double ElapsedSeconds,
+        const FMinraBakeScheduler& Scheduler,
+        const FString& SummaryPath)
+    {
+        TArray<TSharedPtr<FJsonValue>> AssetValues;
+        int32 NumFailed = 0;
+        int64 TotalBytesIn = 0;
+        int64 TotalBytesOut = 0;
+        double TotalMegapixels = 0.0;
+
+        for (const TUniquePtr<FBakeJob>& Job : Jobs)
+        {
+            const double Seconds = Job->BakeSeconds + Job->SaveSeconds;
+            const double Megapixels = static_cast<double>(Job->Width) * Job->Height / 1.0e6;
+
+            TSharedRef<FJsonObject> Entry = MakeShared<FJsonObject>();
+            Entry->SetStringField(TEXT("Asset"), Job->ObjectPath);
+            Entry->SetBoolField(TEXT("Succeeded"), Job->bSucceeded);
+            Entry->SetBoolField(TEXT("Skipped"), false);
+            Entry->SetBoolField(TEXT("Cached"), Job->Images.bFromCache);
+            Entry->SetBoolField(TEXT("LowMemory"), Job->bLowMemory);
+            Entry->SetNumberField(TEXT("EstimatedBytes"), static_cast<double>(Job->EstimatedBytes));
+            Entry->SetStringField(TEXT("Algorithm"), StaticEnum<EMinraDemosaicAlgorithm>()->GetNameStringByValue(static_cast<int64>(Job->Algorithm)));
+            Entry->SetNumberField(TEXT("Width"), Job->Width);
+            Entry->SetNumberField(TEXT("Height"), Job->Height);
+            Entry->SetNumberField(TEXT("Seconds"), Seconds);
+            Entry->SetNumberField(TEXT("BakeSeconds"), Job->BakeSeconds);
+            Entry->SetNumberField(TEXT("SaveSeconds"), Job->SaveSeconds);
+            Entry->SetNumberField(TEXT("MPixPerSecond"), Seconds > 0.0 ? Megapixels / Seconds : 0.0);
+            Entry->SetNumberField(TEXT("BytesIn"), static_cast<double>(Job->BytesIn));
+            Entry->SetNumberField(TEXT("BytesOut"), static_cast<double>(Job->BytesOut));
+            AssetValues.Add(MakeShared<FJsonValueObject>(Entry));
+
+            NumFailed += Job->bSucceeded ? 0 : 1;
+            TotalBytesIn += Job->BytesIn;
+            TotalBytesOut += Job->BytesOut;
+            TotalMegapixels += Job->bSucceeded ? Megapixels : 0.0;
+        }
+
+        for (const FString& ObjectPath : Resumed)
+        {
+            AssetValues.Add(MakeSkippedResult(ObjectPath));
+        }
+
+        TSharedRef<FJsonObject> Summary = MakeShared<FJsonObject>();
+        Summary->SetNumberField(TEXT("Assets"), Jobs.Num());
+        Summary->SetNumberField(TEXT("Failed"), NumFailed);
+        Summary->SetNumberField(TEXT("Resumed"), Resumed.Num());
+        Summary->SetNumberField(TEXT("Seconds"), ElapsedSeconds);
+        Summary->SetNumberField(TEXT("MPixPerSecond"), ElapsedSeconds > 0.0 ? TotalMegapixels / ElapsedSeconds : 0.0);
+        Summary->SetNumberField(TEXT("BytesIn"), static_cast<double>(TotalBytesIn));
+        Summary->SetNumberField(TEXT("BytesOut"), static_cast<double>(TotalBytesOut));
+        Summary->SetNumberField(TEXT("MemoryBudgetBytes"), static_cast<double>(Scheduler.GetBudgetBytes()));
+        Summary->SetNumberField(TEXT("PeakEstimatedBytes"), static_cast<double>(Scheduler.GetPeakBytes()));
+        Summary->SetNumberField(TEXT("PeakUsedPhysicalBytes"), static_cast<double>(FPlatformMemory::GetStats().PeakUsedPhysical));
+        Summary->SetArrayField(TEXT("AssetResults"), AssetValues);
+
+        SaveJson(Summary, SummaryPath);
+    }
+
+    /**
+     * Folds the journals of worker processes into the main journal, so -Resume skips what
+     * they finished even if the coordinator was interrupted; without bKeep they are discarded.
+     */
+    void MergeShardJournals(const FString& JournalPath, bool bKeep)
+    {
+        TArray<FString> ShardJournals;
+        IFileManager::Get().FindFiles(ShardJournals, *FPaths::Combine(GetShardDir(), TEXT("*.journal")), true, false);
+
+        for (const FString& File : ShardJournals)
+        {
+            const FString ShardJournal = FPaths::Combine(GetShardDir(), File);
+
+            FString Lines;
+            if (bKeep && FFileHelper::LoadFileToString(Lines, *ShardJournal) && !Lines.IsEmpty())
+            {
+                FFileHelper::SaveStringToFile(Lines, *JournalPath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM, &IFileManager::Get(), FILEWRITE_Append);
+            }
+
+            IFileManager::Get().Delete(*ShardJournal, false, false, true);
+        }
+    }
+
+    struct FShard
+    {
+        int32 Index = 0;
+        TArray<FString> ObjectPaths;
+
+        /** Bytes of the asset packages and their dependencies, a proxy for bake time */
+        int64 Weight = 0;
+
+        FString ListPath;
+        FString JournalPath;
+        FString SummaryPath;
+        FString LogPath;
+
+        FProcHandle Process;
+        int32 Attempts = 0;
+        int32 ExitCode = -1;
+        double StartTime = 0.0;
+        double Seconds = 0.0;
+
+        /** Per-asset results of all attempts; a retry lists what earlier attempts baked as skipped */
+        TMap<FString, TSharedPtr<FJsonValue>> AssetResults;
+        int64 PeakBytes = 0;
+        int64 PeakUsedPhysical = 0;
+    };
+
+    /**
+     * Folds the summary of a shard's finished attempt into the shard and deletes it, so the
+     * next attempt cannot leave a stale file behind. Results of earlier attempts are kept.
+     */
+    void CollectShardSummary(FShard& Shard)
+    {
+        FString Json;
+        TSharedPtr<FJsonObject> ShardSummary;
+        if (FFileHelper::LoadFileToString(Json, *Shard.SummaryPath) &&
+            FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(Json), ShardSummary) && ShardSummary.IsValid())
+        {
+            // Attempts run one after another, so the shard peaks in one of them
+            Shard.PeakBytes = FMath::Max(Shard.PeakBytes, static_cast<int64>(ShardSummary->GetNumberField(TEXT("PeakEstimatedBytes"))));
+            Shard.PeakUsedPhysical = FMath::Max(Shard.PeakUsedPhysical, static_cast<int64>(ShardSummary->GetNumberField(TEXT("PeakUsedPhysicalBytes"))));
+
+            for (const TSharedPtr<FJsonValue>& Value : ShardSummary->GetArrayField(TEXT("AssetResults")))
+            {
+                const TSharedPtr<FJsonObject>& Entry = Value->AsObject();
+                const FString ObjectPath = Entry->GetStringField(TEXT("Asset"));
+
+                if (!Entry->GetBoolField(TEXT("Skipped")) || !Shard.AssetResults.Contains(ObjectPath))
+                {
+                    Shard.AssetResults.Add(ObjectPath, Value);
+                }
+            }
+        }
+
+        IFileManager::Get().Delete(*Shard.SummaryPath, false, false, true);
+    }
+
+    /**
+     * Starts the worker process of a shard; retries resume from its journal.
+     */
+    bool LaunchShard(FShard& Shard, const FString& WorkerParams, int32 CoresPerWorker)
+    {
+        if (Shard.Attempts == 0)
+        {
+            IFileManager::Get().Delete(*Shard.JournalPath, false, false, true);
+        }
+
+        const FString Args = FString::Printf(
+            TEXT("\"%s\" -run=MinraBake -AssetList=\"%s\" -Journal=\"%s\" -Summary=\"%s\" -abslog=\"%s\" %s -corelimit=%d%s -unattended -nopause -nosplash -nullrhi"),
+            *FPaths::ConvertRelativePathToFull(FPaths::GetProjectFilePath()),
+            *Shard.ListPath,
+            *Shard.JournalPath,
+            *Shard.SummaryPath,
+            *Shard.LogPath,
+            *WorkerParams,
+            CoresPerWorker,
+            Shard.Attempts > 0 ? TEXT(" -Resume") : TEXT(""));
+
+        ++Shard.Attempts;
+        Shard.StartTime = FPlatformTime::Seconds();
+        Shard.Process = FPlatformProcess::CreateProc(FPlatformProcess::ExecutablePath(), *Args, false, true, true, nullptr, 0, nullptr, nullptr);
+
+        if (!Shard.Process.IsValid())
+        {
+            UE_LOG(LogTemp, Error, TEXT("Minra Mosaique: Failed to start the worker process of shard %d."), Shard.Index);
+            return false;
+        }
+
+        UE_LOG(LogTemp, Display, TEXT("Minra Mosaique: Shard %d started (%d assets, attempt %d, log %s)."),
+            Shard.Index, Shard.ObjectPaths.Num(), Shard.Attempts, *Shard.LogPath);
+        return true;
+    }
+
+    /**
+     * Bakes the jobs in NumWorkers local worker processes, each with its own address space
+     * and a share of the cores: splits them into shards of about equal weight, runs one
+     * MinraBake process per shard, retries failed shards and merges their journals and summaries.
+     */
+    int32 RunShards(
+        const TArray<TUniquePtr<FBakeJob>>& Jobs,
+        int32 NumWorkers,
+        int32 NumRetries,
+        const FString& WorkerParams,
+        const TArray<FString>& Resumed,
+        int64 BudgetBytes,
+        const FString& JournalPath,
+        const FString& SummaryPath)
+    {
+        IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+        NumWorkers = FMath::Min(NumWorkers, Jobs.Num());
+        const int32 CoresPerWorker = FMath::Max(FPlatformMisc::NumberOfCoresIncludingHyperthreads() / NumWorkers, 1);
+
+        // Weigh each asset by the size on disk of its package and what it references
+        // (the combined texture of a demosaic texture), then place the heaviest first,
+        // each on the lightest shard so far
+        TArray<TPair<int64, FString>> Weighted;
+        for (const TUniquePtr<FBakeJob>& Job : Jobs)
+        {
+            const FName PackageName(*FPackageName::ObjectPathToPackageName(Job->ObjectPath));
+
+            TArray<FName> Packages;
+            AssetRegistry.GetDependencies(PackageName, Packages, UE::AssetRegistry::EDependencyCategory::Package, UE::AssetRegistry::EDependencyQuery::Hard);
+            Packages.Add(PackageName);
+
+            int64 Weight = 1;
+            for (const FName& Package : Packages)
+            {
+                FString Filename;
+                if (FPackageName::DoesPackageExist(Package.ToString(), &Filename))
+                {
+                    Weight += FMath::Max<int64>(IFileManager::Get().FileSize(*Filename), 0);
+                }
+            }
+
+            Weighted.Emplace(Weight, Job->ObjectPath);
+        }
+
+        Weighted.Sort([](const TPair<int64, FString>& A, const TPair<int64, FString>& B) { return A.Key > B.Key; });
+
+        TArray<FShard> Shards;
+        Shards.SetNum(NumWorkers);
+        for (const TPair<int64, FString>& Entry : Weighted)
+        {
+            FShard* Lightest = &Shards[0];
+            for (FShard& Shard : Shards)
+            {
+                Lightest = Shard.Weight < Lightest->Weight ? &Shard : Lightest;
+            }
+
+            Lightest->ObjectPaths.Add(Entry.Value);
+            Lightest->Weight += Entry.Key;
+        }
+
+        const FString ShardDir = GetShardDir();
+        IFileManager::Get().MakeDirectory(*ShardDir, true);
+
+        const double StartTime = FPlatformTime::Seconds();
+        int32 NumRunning = 0;
+
+        for (int32 Index = 0; Index < Shards.Num(); ++Index)
+        {
+            FShard& Shard = Shards[Index];
+            Shard.Index = Index;
+            Shard.ListPath = FPaths::Combine(ShardDir, FString::Printf(TEXT("Shard%d.txt"), Index));
+            Shard.JournalPath = FPaths::Combine(ShardDir, FString::Printf(TEXT("Shard%d.journal"), Index));
+            Shard.SummaryPath = FPaths::Combine(ShardDir, FString::Printf(TEXT("Shard%d.json"), Index));
+            Shard.LogPath = FPaths::Combine(ShardDir, FString::Printf(TEXT("Shard%d.log"), Index));
+
+            FFileHelper::SaveStringToFile(FString::Join(Shard.ObjectPaths, LINE_TERMINATOR), *Shard.ListPath);
+            IFileManager::Get().Delete(*Shard.SummaryPath, false, false, true);
+
+            NumRunning += LaunchShard(Shard, WorkerParams, CoresPerWorker) ? 1 : 0;
+        }
+
+        UE_LOG(LogTemp, Display, TEXT("Minra Mosaique: %d worker processes with %d cores each."), NumRunning, CoresPerWorker);
+
+        // Wait for the workers, restarting failed shards where they stopped
+        while (NumRunning > 0)
+        {
+            FPlatformProcess::Sleep(0.1f);
+
+            for (FShard& Shard : Shards)
+            {
+                if (!Shard.Process.IsValid() || FPlatformProcess::IsProcRunning(Shard.Process))
+                {
+                    continue;
+                }
+
+                FPlatformProcess::GetProcReturnCode(Shard.Process, &Shard.ExitCode);
+                FPlatformProcess::CloseProc(Shard.Process);
+                Shard.Seconds += FPlatformTime::Seconds() - Shard.StartTime;
+                --NumRunning;
+
+                CollectShardSummary(Shard);
+
+                if (Shard.ExitCode == 0)
+                {
+                    UE_LOG(LogTemp, Display, TEXT("Minra Mosaique: Shard %d finished in %.2f s."), Shard.Index, Shard.Seconds);
+                }
+                else if (Shard.Attempts <= NumRetries)
+                {
+                    UE_LOG(LogTemp, Warning, TEXT("Minra Mosaique: Shard %d exited with code %d, retrying."), Shard.Index, Shard.ExitCode);
+                    NumRunning += LaunchShard(Shard, WorkerParams, CoresPerWorker) ? 1 : 0;
+                }
+                else
+                {
+                    UE_LOG(LogTemp, Error, TEXT("Minra Mosaique: Shard %d failed with code %d after %d attempts; see %s."),
+                        Shard.Index, Shard.ExitCode, Shard.Attempts, *Shard.LogPath);
+                }
+            }
+        }
+
+        const double ElapsedSeconds = FPlatformTime::Seconds() - StartTime;
+        MergeShardJournals(JournalPath, true);
+
+        // Merge the results of every attempt of every shard
+        TArray<TSharedPtr<FJsonValue>> AssetResults;
+        TArray<TSharedPtr<FJsonValue>> ShardValues;
+        int32 NumSucceeded = 0;
+        int64 TotalBytesIn = 0;
+        int64 TotalBytesOut = 0;
+        int64 PeakBytes = 0;
+        int64 PeakUsedPhysical = 0;
+        double TotalMegapixels = 0.0;
+        double WorkerSeconds = 0.0;
+
+        for (const FShard& Shard : Shards)
+        {
+            // Shards peak at different times; the sums bound the machine's peak
+            PeakBytes += Shard.PeakBytes;
+            PeakUsedPhysical += Shard.PeakUsedPhysical;
+
+            for (const TPair<FString, TSharedPtr<FJsonValue>>& Result : Shard.AssetResults)
+            {
+                const TSharedPtr<FJsonObject>& Entry = Result.Value->AsObject();
+
+                // Skipped entries were baked by an earlier attempt, possibly one that crashed before its summary
+                if (Entry->GetBoolField(TEXT("Succeeded")))
+                {
+                    ++NumSucceeded;
+                }
+
+                if (!Entry->GetBoolField(TEXT("Skipped")))
+                {
+                    TotalBytesIn += static_cast<int64>(Entry->GetNumberField(TEXT("BytesIn")));
+                    TotalBytesOut += static_cast<int64>(Entry->GetNumberField(TEXT("BytesOut")));
+
+                    if (Entry->GetBoolField(TEXT("Succeeded")))
+                    {
+                        TotalMegapixels += Entry->GetNumberField(TEXT("Width")) * Entry->GetNumberField(TEXT("Height")) / 1.0e6;
+                    }
+                }
+
+                AssetResults.Add(Result.Value);
+            }
+
+            TSharedRef<FJsonObject> ShardValue = MakeShared<FJsonObject>();
+            ShardValue->SetNumberField(TEXT("Shard"), Shard.Index);
+            ShardValue->SetNumberField(TEXT("Assets"), Shard.ObjectPaths.Num());
+            ShardValue->SetNumberField(TEXT("Attempts"), Shard.Attempts);
+            ShardValue->SetNumberField(TEXT("ExitCode"), Shard.ExitCode);
+            ShardValue->SetNumberField(TEXT("Seconds"), Shard.Seconds);
+            ShardValues.Add(MakeShared<FJsonValueObject>(ShardValue));
+
+            WorkerSeconds += Shard.Seconds;
+        }
+
+        // Assets of shards that never wrote a summary count as failed
+        const int32 NumFailed = Jobs.Num() - NumSucceeded;
+
+        for (const FString& ObjectPath : Resumed)
+        {
+            AssetResults.Add(MakeSkippedResult(ObjectPath));
+        }
+
+        TSharedRef<FJsonObject> Summary = MakeShared<FJsonObject>();
+        Summary->SetNumberField(TEXT("Assets"), Jobs.Num());
+        Summary->SetNumberField(TEXT("Failed"), NumFailed);
+        Summary->SetNumberField(TEXT("Resumed"), Resumed.Num());
+        Summary->SetNumberField(TEXT("Seconds"), ElapsedSeconds);
+        Summary->SetNumberField(TEXT("WorkerSeconds"), WorkerSeconds);
+        Summary->SetNumberField(TEXT("MPixPerSecond"), ElapsedSeconds > 0.0 ? TotalMegapixels / ElapsedSeconds : 0.0);
+        Summary->SetNumberField(TEXT("BytesIn"), static_cast<double>(TotalBytesIn));
+        Summary->SetNumberField(TEXT("BytesOut"), static_cast<double>(TotalBytesOut));
+        Summary->SetNumberField(TEXT("MemoryBudgetBytes"), static_cast<double>(BudgetBytes));
+        Summary->SetNumberField(TEXT("PeakEstimatedBytes"), static_cast<double>(PeakBytes));
+        Summary->SetNumberField(TEXT("PeakUsedPhysicalBytes"), static_cast<double>(PeakUsedPhysical));
+        Summary->SetNumberField(TEXT("Workers"), Shards.Num());
+        Summary->SetArrayField(TEXT("Shards"), ShardValues);
+        Summary->SetArrayField(TEXT("AssetResults"), AssetResults);
+        SaveJson(Summary, SummaryPath);
+
+        UE_LOG(LogTemp, Display, TEXT("Minra Mosaique: Baked %d/%d assets in %d processes in %.2f s (%.2f s of worker time), peak %lld MB estimated, %lld MB used. Summary: %s"),
+            Jobs.Num() - NumFailed, Jobs.Num(), Shards.Num(), ElapsedSeconds, WorkerSeconds, PeakBytes / (1024 * 1024), PeakUsedPhysical / (1024 * 1024), *SummaryPath);
+
+        return NumFailed == 0 ? 0 : 1;
+    }
+}
+
+UMinraBakeCommandlet::UMinraBakeCommandlet()
+{
+    IsClient = false;
+    IsServer = false;
+    IsEditor = true;
+    LogToConsole = true;
+}
+
+int32 UMinraBakeCommandlet::Main(const FString& Params)
+{
+    using namespace MinraBakeCommandlet;
+
+    FString ContentPath;
+    FString AssetListPath;
+    const bool bShard = FParse::Value(*Params, TEXT("AssetList="), AssetListPath);
+    if (!bShard && !FParse::Value(*Params, TEXT("Path="), ContentPath))
+    {
+        UE_LOG(LogTemp, Error, TEXT("Minra Mosaique: Usage: -run=MinraBake -Path=/Game/<Dir> [-Output=/Game/<Dir>] [-TextureArray] [-NoMips] [-MemoryBudgetMB=<MB>] [-Journal=<File>] [-Resume] [-Summary=<File>] [-LowMemoryMB=<MB>] [-Workers=<N>] [-Retries=2]"));
+        return 1;
+    }
+
+    FString OutputPath;
+    FParse::Value(*Params, TEXT("Output="), OutputPath);
+
+    const bool bForceArray = FParse::Param(*Params, TEXT("TextureArray"));
+    const bool bGenerateMipmaps = !FParse::Param(*Params, TEXT("NoMips"));
+    const bool bResume = FParse::Param(*Params, TEXT("Resume"));
+
+    int64 BudgetMB = static_cast<int64>(FPlatformMemory::GetStats().AvailablePhysical / 2 / (1024 * 1024));
+    FParse::Value(*Params, TEXT("MemoryBudgetMB="), BudgetMB);
+    const int64 BudgetBytes = FMath::Max<int64>(BudgetMB, 1) * 1024 * 1024;
+
+    // Bakes that would take over a quarter of the budget stream in low-memory mode
+    int64 LowMemoryMB = FMath::Max<int64>(BudgetBytes / 4 / (1024 * 1024), 1);
+    const bool bLowMemoryGiven = FParse::Value(*Params, TEXT("LowMemoryMB="), LowMemoryMB);
+
+    FString JournalPath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("MinraMosaique"), TEXT("BakeJournal.txt"));
+    FParse::Value(*Params, TEXT("Journal="), JournalPath);
+
+    FString SummaryPath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("MinraMosaique"), TEXT("BakeSummary.json"));
+    FParse::Value(*Params, TEXT("Summary="), SummaryPath);
+
+    int32 NumWorkers = 1;
+    FParse::Value(*Params, TEXT("Workers="), NumWorkers);
+    NumWorkers = bShard ? 1 : FMath::Max(NumWorkers, 1);
+
+    int32 NumRetries = 2;
+    FParse::Value(*Params, TEXT("Retries="), NumRetries);
+
+    // Gather assets; a shard gets its list from the coordinator
+    TArray<FString> ObjectPaths;
+    if (bShard)
+    {
+        FFileHelper::LoadFileToStringArray(ObjectPaths, *AssetListPath);
+        ContentPath = AssetListPath;
+    }
+    else
+    {
+        IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+        AssetRegistry.SearchAllAssets(true);
+
+        FARFilter Filter;
+        Filter.PackagePaths.Add(*ContentPath);
+        Filter.bRecursivePaths = true;
+        Filter.ClassPaths.Add(UMinraDemosaicTexture::StaticClass()->GetClassPathName());
+        Filter.ClassPaths.Add(UMSQ3Asset::StaticClass()->GetClassPathName());
+
+        TArray<FAssetData> Assets;
+        AssetRegistry.GetAssets(Filter, Assets);
+
+        for (const FAssetData& AssetData : Assets)
+        {
+            ObjectPaths.Add(AssetData.GetObjectPathString());
+        }
+    }
+
+    // Assets journaled by an interrupted run are done, including those of its shards
+    TSet<FString> Journaled;
+    if (NumWorkers > 1)
+    {
+        MergeShardJournals(JournalPath, bResume);
+    }
+
+    if (bResume)
+    {
+        TArray<FString> Lines;
+        FFileHelper::LoadFileToStringArray(Lines, *JournalPath);
+        Journaled.Append(Lines);
+    }
+    else
+    {
+        IFileManager::Get().Delete(*JournalPath, false, false, true);
+    }
+
+    TArray<TUniquePtr<FBakeJob>> Jobs;
+    TArray<FString> Resumed;
+
+    for (const FString& ObjectPath : ObjectPaths)
+    {
+        if (ObjectPath.IsEmpty())
+        {
+            continue;
+        }
+
+        if (Journaled.Contains(ObjectPath))
+        {
+            Resumed.Add(ObjectPath);
+            continue;
+        }
+
+        TUniquePtr<FBakeJob> Job = MakeUnique<FBakeJob>();
+        Job->ObjectPath = ObjectPath;
+        Job->Name = FPackageName::ObjectPathToObjectName(ObjectPath);
+        Job->OutputPath = OutputPath.IsEmpty() ? FPackageName::GetLongPackagePath(FPackageName::ObjectPathToPackageName(ObjectPath)) : OutputPath;
+        Jobs.Add(MoveTemp(Job));
+    }
+
+    UE_LOG(LogTemp, Display, TEXT("Minra Mosaique: Baking %d assets from %s (%d already baked, memory budget %lld MB)."),
+        Jobs.Num(), *ContentPath, Resumed.Num(), BudgetBytes / (1024 * 1024));
+
+    FMinraBakeScheduler Scheduler(BudgetBytes, LowMemoryMB * 1024 * 1024);
+
+    if (Jobs.Num() == 0)
+    {
+        WriteSummary(Jobs, Resumed, 0.0, Scheduler, SummaryPath);
+        return 0;
+    }
+
+    if (NumWorkers > 1)
+    {
+        // Shards inherit the output settings; each gets its share of the budget and the cores
+        FString WorkerParams = FString::Printf(TEXT("-MemoryBudgetMB=%lld"), FMath::Max<int64>(BudgetBytes / NumWorkers / (1024 * 1024), 1));
+        if (!OutputPath.IsEmpty())
+        {
+            WorkerParams += FString::Printf(TEXT(" -Output=\"%s\""), *OutputPath);
+        }
+        if (bForceArray)
+        {
+            WorkerParams += TEXT(" -TextureArray");
+        }
+        if (!bGenerateMipmaps)
+        {
+            WorkerParams += TEXT(" -NoMips");
+        }
+        if (bLowMemoryGiven)
+        {
+            WorkerParams += FString::Printf(TEXT(" -LowMemoryMB=%lld"), LowMemoryMB);
+        }
+
+        return RunShards(Jobs, NumWorkers, NumRetries, WorkerParams, Resumed, BudgetBytes, JournalPath, SummaryPath);
+    }
+
+    // Worker threads cannot load modules (Auto selection dumps)
+    FModuleManager::LoadModuleChecked<IImageWrapperModule>(FName("ImageWrapper"));
+
+    // More bakes than workers would only hold memory while they queue
+    const int32 MaxInFlight = FMath::Max(FTaskGraphInterface::Get().GetNumWorkerThreads(), 1);
+
+    TArray<FBakeJob*> InFlight;
+    TArray<FBakeJob*> Written;
+    int32 NextJob = 0;
+
+    const double StartTime = FPlatformTime::Seconds();
+
+    while (NextJob < Jobs.Num() || InFlight.Num() > 0)
+    {
+        // Admit assets while their estimated footprint fits the budget
+        while (NextJob < Jobs.Num() && InFlight.Num() < MaxInFlight)
+        {
+            FBakeJob& Job = *Jobs[NextJob];
+            if (!Job.Asset.IsValid() && !LoadJob(Job, bForceArray, bGenerateMipmaps, Scheduler))
+            {
+                UE_LOG(LogTemp, Error, TEXT("Minra Mosaique: %s has no combined data to bake."), *Job.ObjectPath);
+                ++NextJob;
+                continue;
+            }
+
+            // Back-pressure: the next asset waits until enough of the budget is released
+            if (!Scheduler.TryAdmit(Job.EstimatedBytes))
+            {
+                // Outputs waiting for the journal would hold it back; free them early
+                if (Written.Num() > 0 && Scheduler.IsBlockedByHeld(Job.EstimatedBytes))
+                {
+                    FlushJournal(Written, JournalPath, Scheduler);
+                    continue;
+                }
+                break;
+            }
+
+            ++NextJob;
+            if (!LaunchJob(Job, bGenerateMipmaps))
+            {
+                UE_LOG(LogTemp, Error, TEXT("Minra Mosaique: Failed to read the combined texture of %s."), *Job.ObjectPath);
+                Scheduler.Release(Job.EstimatedBytes);
+                Job.Asset.Reset();
+                continue;
+            }
+
+            InFlight.Add(&Job);
+        }
+
+        // Save finished assets; the writes go out asynchronously while the others bake
+        bool bAnyFinished = false;
+        for (int32 Index = 0; Index < InFlight.Num(); ++Index)
+        {
+            FBakeJob& Job = *InFlight[Index];
+            if (!Job.Task.IsCompleted())
+            {
+                continue;
+            }
+
+            InFlight.RemoveAt(Index--);
+            bAnyFinished = true;
+
+            SaveJob(Job, bGenerateMipmaps);
+            Written.Add(&Job);
+
+            // The bake's working set is gone, but its outputs stay in memory until the
+            // journal flush writes and frees them
+            Scheduler.Hold(Job.HeldBytes);
+            Scheduler.Release(Job.EstimatedBytes);
+
+            if (Job.bSucceeded)
+            {
+                UE_LOG(LogTemp, Log, TEXT("Minra Mosaique: Baked %s (%dx%d) in %.2f s%s%s."), *Job.ObjectPath, Job.Width, Job.Height,
+                    Job.BakeSeconds + Job.SaveSeconds, Job.Images.bFromCache ? TEXT(", from the derived-data cache") : TEXT(""),
+                    Job.bLowMemory ? TEXT(", low-memory mode") : TEXT(""));
+            }
+        }
+
+        if (Written.Num() >= JOURNAL_BATCH)
+        {
+            FlushJournal(Written, JournalPath, Scheduler);
+        }
+        else if (!bAnyFinished)
+        {
+            FPlatformProcess::Sleep(0.005f);
+        }
+    }
+
+    FlushJournal(Written, JournalPath, Scheduler);
+
+    const double ElapsedSeconds = FPlatformTime::Seconds() - StartTime;
+    WriteSummary(Jobs, Resumed, ElapsedSeconds, Scheduler, SummaryPath);
+
+    int32 NumFailed = 0;
+    for (const TUniquePtr<FBakeJob>& Job : Jobs)
+    {
+        NumFailed += Job->bSucceeded ? 0 : 1;
+    }
+
+    int32 NumLowMemory = 0;
+    for (const TUniquePtr<FBakeJob>& Job : Jobs)
+    {
+        NumLowMemory += Job->bLowMemory ? 1 : 0;
+    }
+
+    UE_LOG(LogTemp, Display, TEXT("Minra Mosaique: Baked %d/%d assets (%d in low-memory mode) in %.2f s, peak %lld MB estimated of a %lld MB budget, %lld MB used by the process. Summary: %s"),
+        Jobs.Num() - NumFailed, Jobs.Num(), NumLowMemory, ElapsedSeconds, Scheduler.GetPeakBytes() / (1024 * 1024),
+        BudgetBytes / (1024 * 1024), static_cast<int64>(FPlatformMemory::GetStats().PeakUsedPhysical / (1024 * 1024)), *SummaryPath);
+
+    return NumFailed == 0 ? 0 : 1;
+}
@@ -0,0 +1,117 @@
+// Copyright Minra. All Rights Reserved.
+
+#include "MinraBakeScheduler.h"
+#include "MinraBakeUtility.h"
+#include "MinraDemosaicCPU.h"
+#include "Misc/ScopeLock.h"
+#include "Async/TaskGraphInterfaces.h"
+
+FMinraBakeScheduler::FMinraBakeScheduler(int64 InBudgetBytes, int64 InLowMemoryBytes)
+    : BudgetBytes(FMath::Max<int64>(InBudgetBytes, 1))
+    , LowMemoryBytes(FMath::Max<int64>(InLowMemoryBytes, 1))
+{
+}
+
+int64 FMinraBakeScheduler::EstimatePeakBytes(
+    int32 Width,
+    int32 Height,
+    EMinraDemosaicAlgorithm Algorithm,
+    bool bGenerateMipmaps,
+    bool bLowMemory)
+{
+    const FIntPoint OutputSize = FMinraDemosaicCPU::GetOutputSize(Width, Height, Algorithm);
+    const int64 SourceBytes = static_cast<int64>(Width) * Height * sizeof(FColor);
+    const int64 ImageBytes = static_cast<int64>(OutputSize.X) * OutputSize.Y * sizeof(FColor);
+
+    // Green, red and blue planes at output size
+    const bool bColourDifference = Algorithm == EMinraDemosaicAlgorithm::AGCRD ||
+        Algorithm == EMinraDemosaicAlgorithm::FrequencyAware ||
+        Algorithm == EMinraDemosaicAlgorithm::SmoothHue;
+    const int64 PlaneBytes = bColourDifference ? ImageBytes * 3 : 0;
+
+    const int64 ChainBytes = bGenerateMipmaps ? ImageBytes * 3 * 4 / 3 : ImageBytes * 3;
+
+    // Superpixel images of every CFA, a quarter of the combined size each
+    const int64 QuadBytes = bGenerateMipmaps && Algorithm != EMinraDemosaicAlgorithm::Superpixel ? SourceBytes * 3 / 4 : 0;
+
+    // AHD tile buffers, one set per worker plus the calling thread, whatever the image size
+    const int64 ScratchBytes = Algorithm == EMinraDemosaicAlgorithm::AHD ?
+        FMinraDemosaicCPU::GetAHDScratchBytes() * (FTaskGraphInterface::Get().GetNumWorkerThreads() + 1) : 0;
+
+    if (bLowMemory)
+    {
+        // One band of combined rows, its images and planes at a time, then the chains
+        const int64 BandBytes = static_cast<int64>(FMinraBakeUtility::LOW_MEMORY_BAND_ROWS + 2 * FMinraBakeUtility::LOW_MEMORY_APRON_ROWS) * Width * sizeof(FColor);
+        return SourceBytes + ChainBytes + QuadBytes + BandBytes * (bColourDifference ? 7 : 4) + ScratchBytes;
+    }
+
+    const int64 DemosaicBytes = SourceBytes + ImageBytes * 3 + FMath::Max(PlaneBytes, QuadBytes) + ScratchBytes;
+    const int64 MipBytes = SourceBytes + ChainBytes + QuadBytes;
+    const int64 CacheBytes = ChainBytes * 2;
+    return FMath::Max3(DemosaicBytes, MipBytes, CacheBytes);
+}
+
+bool FMinraBakeScheduler::ShouldUseLowMemory(int32 Width, int32 Height, EMinraDemosaicAlgorithm Algorithm, bool bGenerateMipmaps) const
+{
+    return EstimatePeakBytes(Width, Height, Algorithm, bGenerateMipmaps, false) > LowMemoryBytes;
+}
+
+bool FMinraBakeScheduler::TryAdmit(int64 Bytes)
+{
+    FScopeLock ScopeLock(&Lock);
+
+    if ((NumInFlight > 0 || HeldBytes > 0) && InFlightBytes + Bytes > BudgetBytes)
+    {
+        return false;
+    }
+
+    ++NumInFlight;
+    InFlightBytes += Bytes;
+    PeakBytes = FMath::Max(PeakBytes, InFlightBytes);
+    return true;
+}
+
+void FMinraBakeScheduler::Release(int64 Bytes)
+{
+    FScopeLock ScopeLock(&Lock);
+
+    check(NumInFlight > 0);
+    --NumInFlight;
+    InFlightBytes -= Bytes;
+}
+
+void FMinraBakeScheduler::Hold(int64 Bytes)
+{
+    FScopeLock ScopeLock(&Lock);
+
+    HeldBytes += Bytes;
+    InFlightBytes += Bytes;
+    PeakBytes = FMath::Max(PeakBytes, InFlightBytes);
+}
+
+void FMinraBakeScheduler::ReleaseHeld(int64 Bytes)
+{
+    FScopeLock ScopeLock(&Lock);
+
+    check(HeldBytes >= Bytes);
+    HeldBytes -= Bytes;
+    InFlightBytes -= Bytes;
+}
+
+bool FMinraBakeScheduler::IsBlockedByHeld(int64 Bytes) const
+{
+    FScopeLock ScopeLock(&Lock);
+    return HeldBytes > 0 && (NumInFlight == 0 || InFlightBytes - HeldBytes + Bytes <= BudgetBytes);
+}
+
+int64 FMinraBakeScheduler::GetInFlightBytes() const
+{
+    FScopeLock ScopeLock(&Lock);
+    return InFlightBytes;
+}
+
+int64 FMinraBakeScheduler::GetPeakBytes() const
+{
+    FScopeLock ScopeLock(&Lock);
+    return PeakBytes;
+}
@@ -1,20 +1,39 @@
 // Copyright Minra. All Rights Reserved.
 
 #include "MinraBakeUtility.h"
+#include "MinraDemosaicCPU.h"
+#include "MinraMosaicCPU.h"
+#include "MinraQualityMetrics.h"
+#include "MinraBakeDDC.h"
+#include "MinraBakeScheduler.h"
+#include "MSQ3Decoder.h"
+#include "MinraSIMD.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
 #include "Engine/Texture2D.h"
+#include "Engine/Texture2DArray.h"
 #include "Misc/FileHelper.h"
 #include "ImageUtils.h"
 #include "IImageWrapper.h"
 #include "IImageWrapperModule.h"
 #include "Modules/ModuleManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/Paths.h"
 #include "AssetRegistry/AssetRegistryModule.h"
 #include "UObject/Package.h"
 #include "UObject/SavePackage.h"
 
+static TAutoConsoleVariable<int32> CVarMinraDumpAutoSelection(
+    TEXT("r.MinraMosaique.DumpAutoSelection"),
+    0,
+    TEXT("1: bakes with the Auto algorithm also write their Bilinear/MHC tile map to Saved/MinraMosaique/<Name>_AutoSelection.png (white = MHC)."),
+    ECVF_Default);
+
 bool FMinraBakeUtility::BakeTextures(
     UMinraDemosaicTexture* Source,
     const FString& OutputPath,
-    bool bGenerateMipmaps)
+    bool bGenerateMipmaps,
+    bool bTextureArray)
 {
     if (!Source || !Source->IsValid())
     {
@@ -22,12 +41,32 @@ bool FMinraBakeUtility::BakeTextures(
         return false;
     }
 
+    if (bTextureArray)
+    {
+        UTexture2DArray* ImageArray = BakeTextureArrayFromCombined(
+            Source->CombinedTexture,
+            Source->Algorithm,
+            OutputPath,
+            Source->GetName(),
+            bGenerateMipmaps,
+            Source->CFAPattern);
+
+        if (!ImageArray)
+        {
+            return false;
+        }
+
+        Source->SetBakedTextureArray(ImageArray);
+        return true;
+    }
+
     return BakeTexturesFromCombined(
         Source->CombinedTexture,
         Source->Algorithm,
         OutputPath,
         Source->GetName(),
-        bGenerateMipmaps);
+        bGenerateMipmaps,
+        Source->CFAPattern);
 }
 
 bool FMinraBakeUtility::BakeTexturesFromCombined(
@@ -35,7 +74,138 @@ bool FMinraBakeUtility::BakeTexturesFromCombined(
     EMinraDemosaicAlgorithm Algorithm,
     const FString& OutputPath,
     const FString& BaseFilename,
-    bool bGenerateMipmaps)
+    bool bGenerateMipmaps,
+    EMinraCFAPattern Pattern,
+    UTexture2D* const References[3])
+{
+    FBakeImages Images;
+    if (!DemosaicForBake(CombinedTexture, Algorithm, BaseFilename, bGenerateMipmaps, Pattern, References, Images))
+    {
+        return false;
+    }
+
+    UTexture2D* Textures[3];
+    const bool bSaved = SaveBakedTextures(Images, OutputPath, BaseFilename, Textures);
+    UPackage::WaitForAsyncFileWrites();
+
+    if (bSaved)
+    {
+        UE_LOG(LogTemp, Log, TEXT("Minra Mosaique: Successfully baked 3 textures to %s"), *OutputPath);
+    }
+    return bSaved;
+}
+
+bool FMinraBakeUtility::SaveBakedTextures(
+    FBakeImages& Images,
+    const FString& OutputPath,
+    const FString& BaseFilename,
+    UTexture2D* (&OutTextures)[3])
+{
+    bool bSaved = true;
+
+    // Image N is written and serialized while the chains of the later images are still
+    // building; package files go to disk in the background
+    for (int32 Channel = 0; Channel < 3; ++Channel)
+    {
+        OutTextures[Channel] = nullptr;
+
+        // Create the output texture
+        FString TextureName = FString::Printf(TEXT("%s_Image%d"), *BaseFilename, Channel + 1);
+        FString PackagePath = FString::Printf(TEXT("%s/%s"), *OutputPath, *TextureName);
+
+        UPackage* Package = CreatePackage(*PackagePath);
+        if (!Package)
+        {
+            UE_LOG(LogTemp, Error, TEXT("Minra Mosaique: Failed to create package for %s."), *TextureName);
+            bSaved = false;
+            continue;
+        }
+
+        UTexture2D* OutputTexture = NewObject<UTexture2D>(Package, *TextureName, RF_Public | RF_Standalone);
+        if (!OutputTexture)
+        {
+            UE_LOG(LogTemp, Error, TEXT("Minra Mosaique: Failed to create texture %s."), *TextureName);
+            bSaved = false;
+            continue;
+        }
+
+        Images.Wait(Channel);
+        WriteMips(OutputTexture, Images.Size, Images.Mips[Channel]);
+        bSaved &= SaveAssetPackage(OutputTexture);
+
+        // Register with asset registry
+        FAssetRegistryModule::AssetCreated(OutputTexture);
+        OutTextures[Channel] = OutputTexture;
+    }
+
+    Images.Finish();
+    return bSaved;
+}
+
+UTexture2DArray* FMinraBakeUtility::BakeTextureArrayFromCombined(
+    UTexture2D* CombinedTexture,
+    EMinraDemosaicAlgorithm Algorithm,
+    const FString& OutputPath,
+    const FString& BaseFilename,
+    bool bGenerateMipmaps,
+    EMinraCFAPattern Pattern,
+    UTexture2D* const References[3])
+{
+    FBakeImages Images;
+    if (!DemosaicForBake(CombinedTexture, Algorithm, BaseFilename, bGenerateMipmaps, Pattern, References, Images))
+    {
+        return nullptr;
+    }
+
+    UTexture2DArray* ImageArray = SaveBakedTextureArray(Images, OutputPath, BaseFilename);
+    UPackage::WaitForAsyncFileWrites();
+    return ImageArray;
+}
+
+UTexture2DArray* FMinraBakeUtility::SaveBakedTextureArray(
+    FBakeImages& Images,
+    const FString& OutputPath,
+    const FString& BaseFilename)
+{
+    const FString ArrayName = FString::Printf(TEXT("%s_Images"), *BaseFilename);
+    const FString PackagePath = FString::Printf(TEXT("%s/%s"), *OutputPath, *ArrayName);
+
+    UPackage* Package = CreatePackage(*PackagePath);
+    if (!Package)
+    {
+        UE_LOG(LogTemp, Error, TEXT("Minra Mosaique: Failed to create package for %s."), *ArrayName);
+        return nullptr;
+    }
+
+    UTexture2DArray* ImageArray = NewObject<UTexture2DArray>(Package, *ArrayName, RF_Public | RF_Standalone);
+    if (!ImageArray)
+    {
+        UE_LOG(LogTemp, Error, TEXT("Minra Mosaique: Failed to create texture array %s."), *ArrayName);
+        return nullptr;
+    }
+
+    // Every slice goes into one source buffer, so wait for all three chains
+    Images.Finish();
+    WriteArrayMips(ImageArray, Images.Size, Images.Mips);
+
+    if (!SaveAssetPackage(ImageArray))
+    {
+        return nullptr;
+    }
+    FAssetRegistryModule::AssetCreated(ImageArray);
+
+    UE_LOG(LogTemp, Log, TEXT("Minra Mosaique: Successfully baked a 3-slice texture array to %s"), *PackagePath);
+    return ImageArray;
+}
+
+bool FMinraBakeUtility::DemosaicForBake(
+    UTexture2D* CombinedTexture,
+    EMinraDemosaicAlgorithm Algorithm,
+    const FString& BaseFilename,
+    bool bGenerateMipmaps,
+    EMinraCFAPattern Pattern,
+    UTexture2D* const References[3],
+    FBakeImages& OutImages)
 {
     if (!CombinedTexture)
     {
@@ -43,8 +213,16 @@ bool FMinraBakeUtility::BakeTexturesFromCombined(
         return false;
     }
 
-    int32 Width = CombinedTexture->GetSizeX();
-    int32 Height = CombinedTexture->GetSizeY();
+    // Read source pixels
+    TArray<FColor> SourcePixels;
+    int32 Width = 0;
+    int32 Height = 0;
+
+    if (!FMinraDemosaicCPU::ReadTexturePixels(CombinedTexture, SourcePixels, Width, Height))
+    {
+        UE_LOG(LogTemp, Error, TEXT("Minra Mosaique: Failed to read combined texture pixels (expected BGRA8)."));
+        return false;
+    }
 
     if (Width <= 0 || Height <= 0)
     {
@@ -52,254 +230,683 @@ bool FMinraBakeUtility::BakeTexturesFromCombined(
         return false;
     }
 
-    // Read source pixels
-    TArray<FColor> SourcePixels;
-    SourcePixels.SetNum(Width * Height);
+    // A bake that would take more than half the free memory runs in low-memory mode
+    const int64 AvailableBytes = static_cast<int64>(FPlatformMemory::GetStats().AvailablePhysical);
+    const bool bLowMemory = FMinraBakeScheduler::EstimatePeakBytes(Width, Height, Algorithm, bGenerateMipmaps, false) > AvailableBytes / 2;
+    if (bLowMemory)
+    {
+        UE_LOG(LogTemp, Log, TEXT("Minra Mosaique: Baking %s in low-memory mode."), *BaseFilename);
+    }
 
-    // Lock texture for reading
-    FTexture2DMipMap& Mip = CombinedTexture->GetPlatformData()->Mips[0];
-    const void* Data = Mip.BulkData.LockReadOnly();
+    if (!DemosaicPixels(SourcePixels, Width, Height, Algorithm, Pattern, bGenerateMipmaps, BaseFilename, OutImages, bLowMemory))
+    {
+        return false;
+    }
 
-    if (!Data)
+    if (References)
+    {
+        // Before the chain builds start appending to the mip arrays
+        ReportQuality(OutImages.Mips, OutImages.Size, References, BaseFilename);
+    }
+
+    OutImages.BuildMipChains(true);
+    return true;
+}
+
+bool FMinraBakeUtility::DemosaicPixels(
+    const TArray<FColor>& SourcePixels,
+    int32 Width,
+    int32 Height,
+    EMinraDemosaicAlgorithm Algorithm,
+    EMinraCFAPattern Pattern,
+    bool bGenerateMipmaps,
+    const FString& BaseFilename,
+    FBakeImages& OutImages,
+    bool bLowMemory)
+{
+    // Mip chain per image, mip 0 first; fetched from the derived-data cache when this exact bake was done before
+    const FString CacheKey = FMinraBakeDDC::BuildKey(SourcePixels, Width, Height, Algorithm, Pattern, bGenerateMipmaps ? TEXT("BGRA8Mips") : TEXT("BGRA8"));
+    if (FMinraBakeDDC::Get(CacheKey, OutImages.Size, OutImages.Mips))
+    {
+        UE_LOG(LogTemp, Log, TEXT("Minra Mosaique: %s found in the derived-data cache."), *BaseFilename);
+        OutImages.bFromCache = true;
+        return true;
+    }
+
+    // A superpixel demosaic is a half-resolution reconstruction straight from the CFA,
+    // so it doubles as mip 1 of a full-resolution bake
+    const bool bQuadMip = bGenerateMipmaps && Algorithm != EMinraDemosaicAlgorithm::Superpixel;
+
+    // Demosaic all three images in one pass, with the same kernels as the shaders
+    TArray<FColor> Images[3];
+    TArray<uint8> Selection;
+    FIntPoint Tiles(0, 0);
+    if (bLowMemory)
+    {
+        if (!DemosaicInBands(SourcePixels, Width, Height, Algorithm, Pattern, Images, bQuadMip ? &OutImages.Quads : nullptr))
+        {
+            return false;
+        }
+
+        // Bands choose per band; the report needs the whole-image map, which is the same
+        if (Algorithm == EMinraDemosaicAlgorithm::Auto)
+        {
+            FMinraDemosaicCPU::ComputeAutoSelection(SourcePixels, Width, Height, Selection, Tiles);
+        }
+    }
+    else
+    {
+        const bool bDemosaiced = Algorithm == EMinraDemosaicAlgorithm::Auto
+            ? FMinraDemosaicCPU::DemosaicAutoWithSelection(SourcePixels, Width, Height, Pattern, Selection, Tiles, Images[0], Images[1], Images[2])
+            : FMinraDemosaicCPU::Demosaic(SourcePixels, Width, Height, Algorithm, Pattern, Images[0], Images[1], Images[2]);
+
+        if (!bDemosaiced || (bQuadMip && !FMinraDemosaicCPU::Demosaic(SourcePixels, Width, Height, EMinraDemosaicAlgorithm::Superpixel, Pattern,
+            OutImages.Quads[0], OutImages.Quads[1], OutImages.Quads[2])))
+        {
+            return false;
+        }
+    }
+
+    if (Selection.Num() > 0)
+    {
+        ReportAutoSelection(Selection, Tiles, Width, Height, BaseFilename);
+    }
+
+    OutImages.Size = FMinraDemosaicCPU::GetOutputSize(Width, Height, Algorithm);
+    OutImages.CacheKey = bLowMemory ? FString() : CacheKey;
+
+    for (int32 Channel = 0; Channel < 3; ++Channel)
+    {
+        OutImages.Mips[Channel].Add(MoveTemp(Images[Channel]));
+    }
+
+    OutImages.bQuadMip = bQuadMip;
+    OutImages.bMipsPending = bGenerateMipmaps;
+
+    return true;
+}
+
+bool FMinraBakeUtility::DemosaicInBands(
+    const TArray<FColor>& SourcePixels,
+    int32 Width,
+    int32 Height,
+    EMinraDemosaicAlgorithm Algorithm,
+    EMinraCFAPattern Pattern,
+    TArray<FColor> (&OutImages)[3],
+    TArray<FColor> (*OutQuads)[3])
+{
+    static_assert(LOW_MEMORY_BAND_ROWS % FMinraDemosaicCPU::AUTO_TILE_SIZE == 0 && LOW_MEMORY_APRON_ROWS % FMinraDemosaicCPU::AUTO_TILE_SIZE == 0,
+        "Bands must keep the Bayer phase and the Auto tile grid");
+
+    if (SourcePixels.Num() != Width * Height)
     {
-        UE_LOG(LogTemp, Error, TEXT("Minra Mosaique: Failed to lock texture for reading."));
         return false;
     }
 
-    FMemory::Memcpy(SourcePixels.GetData(), Data, Width * Height * sizeof(FColor));
-    Mip.BulkData.Unlock();
+    const FIntPoint OutputSize = FMinraDemosaicCPU::GetOutputSize(Width, Height, Algorithm);
+    const FIntPoint QuadSize = FMinraDemosaicCPU::GetOutputSize(Width, Height, EMinraDemosaicAlgorithm::Superpixel);
 
-    // Process each channel
     for (int32 Channel = 0; Channel < 3; ++Channel)
     {
-        UE_LOG(LogTemp, Log, TEXT("Minra Mosaique: Processing Image %d..."), Channel + 1);
+        OutImages[Channel].SetNumUninitialized(OutputSize.X * OutputSize.Y);
+        if (OutQuads)
+        {
+            (*OutQuads)[Channel].SetNumUninitialized(QuadSize.X * QuadSize.Y);
+        }
+    }
+
+    TArray<FColor> Band;
+    TArray<FColor> BandImages[3];
 
-        // Create output texture
-        TArray<FColor> OutputPixels;
-        OutputPixels.SetNum(Width * Height);
+    // Keep a band's own rows of its outputs, dropping the aprons; Superpixel rows are
+    // combined row pairs, and bands start on even rows
+    auto KeepBandRows = [&BandImages](TArray<FColor> (&Outputs)[3], int32 OutputWidth, int32 RowScale, int32 Y0, int32 Y1, int32 BandY0)
+    {
+        const int32 OutY0 = Y0 / RowScale;
+        const int32 OutY1 = FMath::DivideAndRoundUp(Y1, RowScale);
+        const int32 SkipRows = (Y0 - BandY0) / RowScale;
 
-        for (int32 Y = 0; Y < Height; ++Y)
+        for (int32 Channel = 0; Channel < 3; ++Channel)
         {
-            for (int32 X = 0; X < Width; ++X)
-            {
-                FColor Demosaiced;
+            FMemory::Memcpy(
+                &Outputs[Channel][OutY0 * OutputWidth],
+                &BandImages[Channel][SkipRows * OutputWidth],
+                (OutY1 - OutY0) * OutputWidth * sizeof(FColor));
+        }
+    };
 
-                if (Algorithm == EMinraDemosaicAlgorithm::MalvarHeCutler)
-                {
-                    Demosaiced = DemosaicPixelMHC(SourcePixels, Width, Height, X, Y, Channel);
-                }
-                else
-                {
-                    Demosaiced = DemosaicPixelBilinear(SourcePixels, Width, Height, X, Y, Channel);
-                }
+    // Bands run one after another; each is row-parallel inside
+    for (int32 Y0 = 0; Y0 < Height; Y0 += LOW_MEMORY_BAND_ROWS)
+    {
+        const int32 Y1 = FMath::Min(Y0 + LOW_MEMORY_BAND_ROWS, Height);
+        const int32 BandY0 = FMath::Max(Y0 - LOW_MEMORY_APRON_ROWS, 0);
+        const int32 BandY1 = FMath::Min(Y1 + LOW_MEMORY_APRON_ROWS, Height);
+
+        Band.SetNumUninitialized(Width * (BandY1 - BandY0));
+        FMemory::Memcpy(Band.GetData(), &SourcePixels[BandY0 * Width], Band.Num() * sizeof(FColor));
+
+        if (!FMinraDemosaicCPU::Demosaic(Band, Width, BandY1 - BandY0, Algorithm, Pattern, BandImages[0], BandImages[1], BandImages[2]))
+        {
+            return false;
+        }
+        KeepBandRows(OutImages, OutputSize.X, Algorithm == EMinraDemosaicAlgorithm::Superpixel ? 2 : 1, Y0, Y1, BandY0);
 
-                OutputPixels[Y * Width + X] = Demosaiced;
+        // Each quad depends only on its own 2x2 block, so the band's quads are the whole image's
+        if (OutQuads)
+        {
+            if (!FMinraDemosaicCPU::Demosaic(Band, Width, BandY1 - BandY0, EMinraDemosaicAlgorithm::Superpixel, Pattern, BandImages[0], BandImages[1], BandImages[2]))
+            {
+                return false;
             }
+            KeepBandRows(*OutQuads, QuadSize.X, 2, Y0, Y1, BandY0);
         }
+    }
 
-        // Create the output texture
-        FString TextureName = FString::Printf(TEXT("%s_Image%d"), *BaseFilename, Channel + 1);
-        FString PackagePath = FString::Printf(TEXT("%s/%s"), *OutputPath, *TextureName);
+    return true;
+}
 
-        UPackage* Package = CreatePackage(*PackagePath);
-        if (!Package)
+FMinraBakeUtility::FBakeImages::~FBakeImages()
+{
+    // The chain builds write into this object
+    for (int32 Channel = 0; Channel < 3; ++Channel)
+    {
+        Wait(Channel);
+    }
+}
+
+void FMinraBakeUtility::FBakeImages::BuildMipChains(bool bAsync)
+{
+    if (!bMipsPending)
+    {
+        return;
+    }
+    bMipsPending = false;
+
+    // The chains are independent
+    if (bAsync)
+    {
+        for (int32 Channel = 0; Channel < 3; ++Channel)
         {
-            UE_LOG(LogTemp, Error, TEXT("Minra Mosaique: Failed to create package for %s."), *TextureName);
-            continue;
+            MipTasks[Channel] = Async(EAsyncExecution::ThreadPool, [this, Channel]()
+            {
+                BuildMipChain(Mips[Channel], Size, bQuadMip ? &Quads[Channel] : nullptr);
+            });
+        }
+    }
+    else
+    {
+        ParallelFor(3, [this](int32 Channel)
+        {
+            BuildMipChain(Mips[Channel], Size, bQuadMip ? &Quads[Channel] : nullptr);
+        });
+    }
+}
+
+void FMinraBakeUtility::FBakeImages::Wait(int32 Channel)
+{
+    if (MipTasks[Channel].IsValid())
+    {
+        MipTasks[Channel].Wait();
+        MipTasks[Channel].Reset();
+    }
+}
+
+void FMinraBakeUtility::FBakeImages::Finish()
+{
+    BuildMipChains(false);
+    for (int32 Channel = 0; Channel < 3; ++Channel)
+    {
+        Wait(Channel);
+        Quads[Channel].Empty();
+    }
+
+    if (!CacheKey.IsEmpty())
+    {
+        FMinraBakeDDC::Put(CacheKey, Size, Mips);
+        CacheKey.Empty();
+    }
+}
+
+bool FMinraBakeUtility::RebakeMSQ3Channels(UMSQ3Asset* Asset, const bool bChanged[3])
+{
+    if (!Asset || !Asset->HasBakedTextures())
+    {
+        return false;
+    }
+
+    TSharedPtr<FMinraMSQ3Decoder::FMQ3Data> Decoded = FMinraMSQ3Decoder::Decode(Asset->CompressedData);
+    if (!Decoded.IsValid())
+    {
+        UE_LOG(LogTemp, Error, TEXT("Minra Mosaique: %s has no readable MSQ3 data to bake."), *Asset->GetName());
+        return false;
+    }
+
+    // Unchanged images are kept only if they were baked the way this rebake would bake them
+    const FTexturePlatformData* PlatformData = Asset->BakedImage1->GetPlatformData();
+    const bool bMipmaps = Asset->bBakeRecorded ? Asset->bBakedMipmaps : PlatformData && PlatformData->Mips.Num() > 1;
+    bool bRebake[3] = { bChanged[0], bChanged[1], bChanged[2] };
+    if (!Asset->bBakeRecorded || Asset->BakedAlgorithm != Asset->Algorithm)
+    {
+        UE_LOG(LogTemp, Log, TEXT("Minra Mosaique: Last bake of %s does not match its algorithm, rebaking all images."), *Asset->GetName());
+        bRebake[0] = bRebake[1] = bRebake[2] = true;
+    }
+
+    // Each image is reconstructed from its own CFA only, so channels that did not change
+    // are neither decoded nor written and their lanes stay zero. Auto picks its kernel per
+    // tile from the gradients of all three lanes, so it decodes every channel and only
+    // skips the writes.
+    const bool bDecodeAll = Asset->Algorithm == EMinraDemosaicAlgorithm::Auto;
+    const TArray<uint8>* Payloads[3] = { &Decoded->ChannelR, &Decoded->ChannelG, &Decoded->ChannelB };
+    TArray<uint8> CFAs[3];
+    bool bDecoded[3] = { true, true, true };
+
+    ParallelFor(3, [&](int32 Channel)
+    {
+        if (bRebake[Channel] || bDecodeAll)
+        {
+            bDecoded[Channel] = FMinraMSQ3Decoder::DecodeChannel(*Payloads[Channel], Decoded->Version, Decoded->Width, Decoded->Height, CFAs[Channel]);
         }
+    });
 
-        UTexture2D* OutputTexture = NewObject<UTexture2D>(Package, *TextureName, RF_Public | RF_Standalone);
-        if (!OutputTexture)
+    if (!bDecoded[0] || !bDecoded[1] || !bDecoded[2])
+    {
+        UE_LOG(LogTemp, Error, TEXT("Minra Mosaique: Failed to decode the channels of %s."), *Asset->GetName());
+        return false;
+    }
+
+    const int32 NumPixels = Decoded->Width * Decoded->Height;
+    TArray<uint8> Unchanged;
+    const uint8* Planes[3];
+    for (int32 Channel = 0; Channel < 3; ++Channel)
+    {
+        if (CFAs[Channel].Num() == 0 && Unchanged.Num() == 0)
+        {
+            Unchanged.SetNumZeroed(NumPixels);
+        }
+        Planes[Channel] = CFAs[Channel].Num() > 0 ? CFAs[Channel].GetData() : Unchanged.GetData();
+    }
+
+    TArray<FColor> Combined;
+    Combined.SetNumUninitialized(NumPixels);
+    MinraSIMD::PackBGRA(Planes[0], Planes[1], Planes[2], Combined.GetData(), NumPixels);
+
+    TArray<FColor> Images[3];
+    if (!FMinraDemosaicCPU::Demosaic(Combined, Decoded->Width, Decoded->Height, Asset->Algorithm, EMinraCFAPattern::RGGB, Images[0], Images[1], Images[2]))
+    {
+        return false;
+    }
+
+    const FIntPoint OutputSize = FMinraDemosaicCPU::GetOutputSize(Decoded->Width, Decoded->Height, Asset->Algorithm);
+    UTexture2D* const Targets[3] = { Asset->BakedImage1, Asset->BakedImage2, Asset->BakedImage3 };
+
+    bool bWithMips[3];
+    for (int32 Channel = 0; Channel < 3; ++Channel)
+    {
+        bWithMips[Channel] = bRebake[Channel] && bMipmaps;
+    }
+
+    TArray<FColor> Quads[3];
+    const bool bQuadMip = (bWithMips[0] || bWithMips[1] || bWithMips[2]) && Asset->Algorithm != EMinraDemosaicAlgorithm::Superpixel &&
+        FMinraDemosaicCPU::Demosaic(Combined, Decoded->Width, Decoded->Height, EMinraDemosaicAlgorithm::Superpixel, EMinraCFAPattern::RGGB, Quads[0], Quads[1], Quads[2]);
+
+    // Chains build on workers while earlier images are written and serialized
+    TArray<TArray<FColor>> Mips[3];
+    TFuture<void> MipTasks[3];
+    for (int32 Channel = 0; Channel < 3; ++Channel)
+    {
+        if (bRebake[Channel])
+        {
+            Mips[Channel].Add(MoveTemp(Images[Channel]));
+        }
+        if (bWithMips[Channel])
+        {
+            MipTasks[Channel] = Async(EAsyncExecution::ThreadPool, [&Mips, &Quads, &OutputSize, Channel, bQuadMip]()
+            {
+                BuildMipChain(Mips[Channel], OutputSize, bQuadMip ? &Quads[Channel] : nullptr);
+            });
+        }
+    }
+
+    for (int32 Channel = 0; Channel < 3; ++Channel)
+    {
+        if (!bRebake[Channel])
         {
-            UE_LOG(LogTemp, Error, TEXT("Minra Mosaique: Failed to create texture %s."), *TextureName);
             continue;
         }
 
-        // Initialize the texture
-        OutputTexture->GetPlatformData() = new FTexturePlatformData();
-        OutputTexture->GetPlatformData()->SizeX = Width;
-        OutputTexture->GetPlatformData()->SizeY = Height;
-        OutputTexture->GetPlatformData()->PixelFormat = PF_B8G8R8A8;
+        if (MipTasks[Channel].IsValid())
+        {
+            MipTasks[Channel].Wait();
+        }
+
+        Targets[Channel]->Modify();
+        WriteMips(Targets[Channel], OutputSize, Mips[Channel]);
+        SaveAssetPackage(Targets[Channel]);
+    }
+
+    Asset->Modify();
+    Asset->BakedAlgorithm = Asset->Algorithm;
+    Asset->bBakedMipmaps = bMipmaps;
+    Asset->bBakeRecorded = true;
+
+    UPackage::WaitForAsyncFileWrites();
+
+    UE_LOG(LogTemp, Log, TEXT("Minra Mosaique: Rebaked %s, images%s%s%s."), *Asset->GetName(),
+        bRebake[0] ? TEXT(" 1") : TEXT(""), bRebake[1] ? TEXT(" 2") : TEXT(""), bRebake[2] ? TEXT(" 3") : TEXT(""));
+    return true;
+}
+
+bool FMinraBakeUtility::RebakeMSQ3Array(UMSQ3Asset* Asset)
+{
+    if (!Asset || !Asset->HasBakedTextureArray())
+    {
+        return false;
+    }
+
+    TArray<FColor> SourcePixels;
+    if (!Asset->DecodeCombinedPixels(SourcePixels) || SourcePixels.Num() != Asset->Width * Asset->Height)
+    {
+        UE_LOG(LogTemp, Error, TEXT("Minra Mosaique: %s has no readable MSQ3 data to bake."), *Asset->GetName());
+        return false;
+    }
+
+    UTexture2DArray* ImageArray = Asset->BakedImageArray;
+    const bool bMipmaps = Asset->bBakeRecorded ? Asset->bBakedMipmaps : ImageArray->Source.GetNumMips() > 1;
+
+    // MSQ3 files are always RGGB
+    FBakeImages Images;
+    if (!DemosaicPixels(SourcePixels, Asset->Width, Asset->Height, Asset->Algorithm, EMinraCFAPattern::RGGB, bMipmaps, Asset->GetName(), Images))
+    {
+        return false;
+    }
+    SourcePixels.Empty();
+    Images.Finish();
+
+    ImageArray->Modify();
+    WriteArrayMips(ImageArray, Images.Size, Images.Mips);
+    const bool bSaved = SaveAssetPackage(ImageArray);
+
+    Asset->Modify();
+    Asset->BakedAlgorithm = Asset->Algorithm;
+    Asset->bBakedMipmaps = bMipmaps;
+    Asset->bBakeRecorded = true;
+
+    UPackage::WaitForAsyncFileWrites();
+
+    UE_LOG(LogTemp, Log, TEXT("Minra Mosaique: Rebaked the texture array of %s."), *Asset->GetName());
+    return bSaved;
+}
+
+void FMinraBakeUtility::WriteMips(UTexture2D* Texture, FIntPoint Size, const TArray<TArray<FColor>>& Mips)
+{
+    // Uncompressed BGRA8 platform data, mip 0 first
+    Texture->ReleaseResource();
+    delete Texture->GetPlatformData();
+    Texture->GetPlatformData() = new FTexturePlatformData();
+    Texture->GetPlatformData()->SizeX = Size.X;
+    Texture->GetPlatformData()->SizeY = Size.Y;
+    Texture->GetPlatformData()->PixelFormat = PF_B8G8R8A8;
+
+    for (int32 MipIndex = 0; MipIndex < Mips.Num(); ++MipIndex)
+    {
+        const TArray<FColor>& MipPixels = Mips[MipIndex];
 
-        // Create mip
         FTexture2DMipMap* OutputMip = new FTexture2DMipMap();
-        OutputTexture->GetPlatformData()->Mips.Add(OutputMip);
-        OutputMip->SizeX = Width;
-        OutputMip->SizeY = Height;
+        Texture->GetPlatformData()->Mips.Add(OutputMip);
+        OutputMip->SizeX = FMath::Max(Size.X >> MipIndex, 1);
+        OutputMip->SizeY = FMath::Max(Size.Y >> MipIndex, 1);
 
         // Allocate and copy data
         OutputMip->BulkData.Lock(LOCK_READ_WRITE);
-        void* OutputData = OutputMip->BulkData.Realloc(Width * Height * sizeof(FColor));
-        FMemory::Memcpy(OutputData, OutputPixels.GetData(), Width * Height * sizeof(FColor));
+        void* OutputData = OutputMip->BulkData.Realloc(MipPixels.Num() * sizeof(FColor));
+        FMemory::Memcpy(OutputData, MipPixels.GetData(), MipPixels.Num() * sizeof(FColor));
         OutputMip->BulkData.Unlock();
+    }
 
-        OutputTexture->UpdateResource();
-
-        // Save the package
-        FString PackageFilename = FPackageName::LongPackageNameToFilename(PackagePath, FPackageName::GetAssetPackageExtension());
+    Texture->UpdateResource();
+}
 
-        FSavePackageArgs SaveArgs;
-        SaveArgs.TopLevelFlags = RF_Public | RF_Standalone;
-        UPackage::SavePackage(Package, OutputTexture, *PackageFilename, SaveArgs);
+void FMinraBakeUtility::WriteArrayMips(UTexture2DArray* ImageArray, FIntPoint Size, const TArray<TArray<FColor>> (&Mips)[3])
+{
+    // Source layout is mip by mip, each mip holding slices 0..2 back to back
+    const int32 NumMips = Mips[0].Num();
+    TArray64<uint8> SourceData;
+    for (int32 MipIndex = 0; MipIndex < NumMips; ++MipIndex)
+    {
+        for (int32 Slice = 0; Slice < 3; ++Slice)
+        {
+            const TArray<FColor>& MipPixels = Mips[Slice][MipIndex];
+            SourceData.Append(reinterpret_cast<const uint8*>(MipPixels.GetData()), MipPixels.Num() * sizeof(FColor));
+        }
+    }
 
-        // Register with asset registry
-        FAssetRegistryModule::AssetCreated(OutputTexture);
+    // Same uncompressed BGRA8 data and mips as the separate-texture bake
+    ImageArray->Source.Init(Size.X, Size.Y, 3, NumMips, TSF_BGRA8, SourceData.GetData());
+    ImageArray->CompressionSettings = TC_VectorDisplacementmap;
+    ImageArray->MipGenSettings = NumMips > 1 ? TMGS_LeaveExistingMips : TMGS_NoMipmaps;
+    ImageArray->PostEditChange();
+}
 
-        UE_LOG(LogTemp, Log, TEXT("Minra Mosaique: Saved %s"), *PackageFilename);
+bool FMinraBakeUtility::SaveAssetPackage(UObject* Asset)
+{
+    UPackage* Package = Asset->GetOutermost();
+    const FString PackageFilename = FPackageName::LongPackageNameToFilename(Package->GetName(), FPackageName::GetAssetPackageExtension());
+
+    // Serialize now and hand the file write to the async writer, so the next image's
+    // serialization overlaps this one's disk IO
+    FSavePackageArgs SaveArgs;
+    SaveArgs.TopLevelFlags = RF_Public | RF_Standalone;
+    SaveArgs.SaveFlags = SAVE_Async;
+    if (!UPackage::SavePackage(Package, Asset, *PackageFilename, SaveArgs))
+    {
+        UE_LOG(LogTemp, Error, TEXT("Minra Mosaique: Failed to save %s"), *PackageFilename);
+        return false;
     }
 
-    UE_LOG(LogTemp, Log, TEXT("Minra Mosaique: Successfully baked 3 textures to %s"), *OutputPath);
+    UE_LOG(LogTemp, Log, TEXT("Minra Mosaique: Saved %s"), *PackageFilename);
     return true;
 }
 
-FColor FMinraBakeUtility::DemosaicPixelBilinear(
-    const TArray<FColor>& Pixels,
-    int32 Width,
-    int32 Height,
-    int32 X,
-    int32 Y,
-    int32 Channel)
+UTexture2D* FMinraBakeUtility::CreateCombinedTexture(
+    UTexture2D* const Images[3],
+    const FString& OutputPath,
+    const FString& AssetName,
+    EMinraCFAPattern Pattern,
+    bool bPrefilter)
 {
-    bool EvenRow = (Y & 1) == 0;
-    bool EvenCol = (X & 1) == 0;
+    TArray<FColor> Pixels[3];
+    int32 Widths[3] = { 0, 0, 0 };
+    int32 Heights[3] = { 0, 0, 0 };
 
-    auto GetChannel = [&Pixels, Width, Height, Channel](int32 PX, int32 PY) -> float
+    for (int32 Index = 0; Index < 3; ++Index)
     {
-        PX = FMath::Clamp(PX, 0, Width - 1);
-        PY = FMath::Clamp(PY, 0, Height - 1);
-        const FColor& C = Pixels[PY * Width + PX];
-        switch (Channel)
+        if (!FMinraDemosaicCPU::ReadTexturePixels(Images[Index], Pixels[Index], Widths[Index], Heights[Index]))
         {
-            case 0: return C.R / 255.0f;
-            case 1: return C.G / 255.0f;
-            default: return C.B / 255.0f;
+            UE_LOG(LogTemp, Error, TEXT("Minra Mosaique: Failed to read source texture for Image %d (expected BGRA8)."), Index + 1);
+            return nullptr;
         }
-    };
-
-    float Center = GetChannel(X, Y);
-    float Top = GetChannel(X, Y - 1);
-    float Bottom = GetChannel(X, Y + 1);
-    float Left = GetChannel(X - 1, Y);
-    float Right = GetChannel(X + 1, Y);
-    float TopLeft = GetChannel(X - 1, Y - 1);
-    float TopRight = GetChannel(X + 1, Y - 1);
-    float BottomLeft = GetChannel(X - 1, Y + 1);
-    float BottomRight = GetChannel(X + 1, Y + 1);
-
-    float R, G, B;
+    }
 
-    if (EvenRow && EvenCol)
+    if (Widths[1] != Widths[0] || Widths[2] != Widths[0] || Heights[1] != Heights[0] || Heights[2] != Heights[0])
     {
-        R = Center;
-        G = (Top + Bottom + Left + Right) * 0.25f;
-        B = (TopLeft + TopRight + BottomLeft + BottomRight) * 0.25f;
+        UE_LOG(LogTemp, Error, TEXT("Minra Mosaique: Source textures must have identical dimensions."));
+        return nullptr;
     }
-    else if (EvenRow && !EvenCol)
+
+    TArray<FColor> Combined;
+    if (!FMinraMosaicCPU::Mosaic(Pixels[0], Pixels[1], Pixels[2], Widths[0], Heights[0], Pattern, bPrefilter, Combined))
     {
-        R = (Left + Right) * 0.5f;
-        G = Center;
-        B = (Top + Bottom) * 0.5f;
+        return nullptr;
     }
-    else if (!EvenRow && EvenCol)
+
+    const FString PackagePath = FString::Printf(TEXT("%s/%s"), *OutputPath, *AssetName);
+    UPackage* Package = CreatePackage(*PackagePath);
+    if (!Package)
     {
-        R = (Top + Bottom) * 0.5f;
-        G = Center;
-        B = (Left + Right) * 0.5f;
+        UE_LOG(LogTemp, Error, TEXT("Minra Mosaique: Failed to create package for %s."), *AssetName);
+        return nullptr;
     }
-    else
+
+    UTexture2D* Texture = NewObject<UTexture2D>(Package, *AssetName, RF_Public | RF_Standalone);
+    if (!Texture)
     {
-        R = (TopLeft + TopRight + BottomLeft + BottomRight) * 0.25f;
-        G = (Top + Bottom + Left + Right) * 0.25f;
-        B = Center;
+        UE_LOG(LogTemp, Error, TEXT("Minra Mosaique: Failed to create texture %s."), *AssetName);
+        return nullptr;
     }
 
-    return FColor(
-        FMath::Clamp(FMath::RoundToInt(R * 255.0f), 0, 255),
-        FMath::Clamp(FMath::RoundToInt(G * 255.0f), 0, 255),
-        FMath::Clamp(FMath::RoundToInt(B * 255.0f), 0, 255),
-        255);
+    // CFA data must stay point-sampled and uncompressed; mips would mix Bayer sites
+    Texture->Source.Init(Widths[0], Heights[0], 1, 1, TSF_BGRA8, reinterpret_cast<const uint8*>(Combined.GetData()));
+    Texture->CompressionSettings = TC_VectorDisplacementmap;
+    Texture->MipGenSettings = TMGS_NoMipmaps;
+    Texture->Filter = TF_Nearest;
+    Texture->SRGB = false;
+    Texture->PostEditChange();
+
+    FString PackageFilename = FPackageName::LongPackageNameToFilename(PackagePath, FPackageName::GetAssetPackageExtension());
+
+    FSavePackageArgs SaveArgs;
+    SaveArgs.TopLevelFlags = RF_Public | RF_Standalone;
+    UPackage::SavePackage(Package, Texture, *PackageFilename, SaveArgs);
+
+    FAssetRegistryModule::AssetCreated(Texture);
+
+    UE_LOG(LogTemp, Log, TEXT("Minra Mosaique: Saved combined texture %s (%dx%d%s)"),
+        *PackageFilename, Widths[0], Heights[0], bPrefilter ? TEXT(", prefiltered") : TEXT(""));
+    return Texture;
 }
 
-FColor FMinraBakeUtility::DemosaicPixelMHC(
-    const TArray<FColor>& Pixels,
-    int32 Width,
-    int32 Height,
-    int32 X,
-    int32 Y,
-    int32 Channel)
+void FMinraBakeUtility::BuildMipChain(
+    TArray<TArray<FColor>>& Mips,
+    FIntPoint Size,
+    const TArray<FColor>* QuadMip)
 {
-    bool EvenRow = (Y & 1) == 0;
-    bool EvenCol = (X & 1) == 0;
+    check(Mips.Num() == 1);
+
+    int32 Width = Size.X;
+    int32 Height = Size.Y;
 
-    auto Mirror = [](int32 P, int32 Size) -> int32
+    while (Width > 1 || Height > 1)
     {
-        if (P < 0) return -P;
-        if (P >= Size) return 2 * Size - P - 2;
-        return P;
-    };
+        const int32 MipWidth = FMath::Max(Width >> 1, 1);
+        const int32 MipHeight = FMath::Max(Height >> 1, 1);
+
+        const TArray<FColor>& Previous = Mips.Last();
+        TArray<FColor> Mip;
+        Mip.SetNumUninitialized(MipWidth * MipHeight);
 
-    auto GetChannel = [&Pixels, Width, Height, Channel, &Mirror](int32 PX, int32 PY) -> float
+        if (QuadMip && Mips.Num() == 1)
+        {
+            // Superpixel output is ceil(W/2) wide; crop to the mip size, which rounds down
+            const int32 QuadWidth = (Width + 1) / 2;
+            for (int32 Y = 0; Y < MipHeight; ++Y)
+            {
+                FMemory::Memcpy(&Mip[Y * MipWidth], &(*QuadMip)[Y * QuadWidth], MipWidth * sizeof(FColor));
+            }
+        }
+        else
+        {
+            // 2x2 box filter, repeating the last row/column of odd sizes
+            for (int32 Y = 0; Y < MipHeight; ++Y)
+            {
+                const FColor* Row0 = &Previous[(Y * 2) * Width];
+                const FColor* Row1 = &Previous[FMath::Min(Y * 2 + 1, Height - 1) * Width];
+
+                for (int32 X = 0; X < MipWidth; ++X)
+                {
+                    const int32 X0 = X * 2;
+                    const int32 X1 = FMath::Min(X0 + 1, Width - 1);
+
+                    Mip[Y * MipWidth + X] = FColor(
+                        static_cast<uint8>((Row0[X0].R + Row0[X1].R + Row1[X0].R + Row1[X1].R + 2) / 4),
+                        static_cast<uint8>((Row0[X0].G + Row0[X1].G + Row1[X0].G + Row1[X1].G + 2) / 4),
+                        static_cast<uint8>((Row0[X0].B + Row0[X1].B + Row1[X0].B + Row1[X1].B + 2) / 4),
+                        255);
+                }
+            }
+        }
+
+        Mips.Add(MoveTemp(Mip));
+        Width = MipWidth;
+        Height = MipHeight;
+    }
+}
+
+void FMinraBakeUtility::ReportQuality(
+    const TArray<TArray<FColor>> (&Mips)[3],
+    FIntPoint Size,
+    UTexture2D* const References[3],
+    const FString& BaseFilename)
+{
+    // One image at a time; each metric is already parallel over rows
+    for (int32 Channel = 0; Channel < 3; ++Channel)
     {
-        PX = Mirror(PX, Width);
-        PY = Mirror(PY, Height);
-        PX = FMath::Clamp(PX, 0, Width - 1);
-        PY = FMath::Clamp(PY, 0, Height - 1);
-        const FColor& C = Pixels[PY * Width + PX];
-        switch (Channel)
+        if (!References[Channel])
         {
-            case 0: return C.R / 255.0f;
-            case 1: return C.G / 255.0f;
-            default: return C.B / 255.0f;
+            continue;
         }
-    };
 
-    // Sample 5x5 neighborhood
-    float C = GetChannel(X, Y);
-    float N = GetChannel(X, Y - 1);
-    float S = GetChannel(X, Y + 1);
-    float W = GetChannel(X - 1, Y);
-    float E = GetChannel(X + 1, Y);
-    float NW = GetChannel(X - 1, Y - 1);
-    float NE = GetChannel(X + 1, Y - 1);
-    float SW = GetChannel(X - 1, Y + 1);
-    float SE = GetChannel(X + 1, Y + 1);
-    float N2 = GetChannel(X, Y - 2);
-    float S2 = GetChannel(X, Y + 2);
-    float W2 = GetChannel(X - 2, Y);
-    float E2 = GetChannel(X + 2, Y);
+        TArray<FColor> ReferencePixels;
+        int32 ReferenceWidth = 0;
+        int32 ReferenceHeight = 0;
 
-    float R, G, B;
+        if (!FMinraDemosaicCPU::ReadTexturePixels(References[Channel], ReferencePixels, ReferenceWidth, ReferenceHeight) ||
+            ReferenceWidth != Size.X || ReferenceHeight != Size.Y)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("Minra Mosaique: Reference %s is unreadable or not %dx%d, skipping quality report."),
+                *References[Channel]->GetName(), Size.X, Size.Y);
+            continue;
+        }
 
-    if (EvenRow && EvenCol)
+        FMinraQualityReport Report;
+        if (FMinraQualityMetrics::Compute(ReferencePixels, Mips[Channel][0], Size.X, Size.Y, Report))
+        {
+            UE_LOG(LogTemp, Log, TEXT("Minra Mosaique: %s_Image%d PSNR %.2f dB, SSIM %.4f, Delta E %.3f"),
+                *BaseFilename, Channel + 1, Report.PSNR, Report.SSIM, Report.DeltaE);
+        }
+    }
+}
+
+void FMinraBakeUtility::ReportAutoSelection(
+    const TArray<uint8>& Selection,
+    FIntPoint Tiles,
+    int32 Width,
+    int32 Height,
+    const FString& BaseFilename)
+{
+    int32 MHCTiles = 0;
+    for (const uint8 bMHC : Selection)
+    {
+        MHCTiles += bMHC;
+    }
+
+    UE_LOG(LogTemp, Log, TEXT("Minra Mosaique: %s Auto used MHC on %d of %d tiles."), *BaseFilename, MHCTiles, Selection.Num());
+
+    if (CVarMinraDumpAutoSelection.GetValueOnAnyThread() == 0)
     {
-        R = C;
-        G = (4.0f * C + 2.0f * (N + S + W + E) - (N2 + S2 + W2 + E2)) / 8.0f;
-        B = (6.0f * C + 2.0f * (NW + NE + SW + SE) - 1.5f * (N2 + S2 + W2 + E2)) / 8.0f;
+        return;
     }
-    else if (EvenRow && !EvenCol)
+
+    // One texel per source texel, so the map overlays the combined texture
+    TArray<FColor> Map;
+    Map.SetNumUninitialized(Width * Height);
+    for (int32 Y = 0; Y < Height; ++Y)
     {
-        G = C;
-        R = (4.0f * C + 2.0f * (W + E) - 0.5f * (N2 + S2 + W2 + E2)) / 8.0f;
-        B = (4.0f * C + 2.0f * (N + S) - 0.5f * (N2 + S2 + W2 + E2)) / 8.0f;
+        const uint8* TileRow = Selection.GetData() + (Y / FMinraDemosaicCPU::AUTO_TILE_SIZE) * Tiles.X;
+        for (int32 X = 0; X < Width; ++X)
+        {
+            Map[Y * Width + X] = TileRow[X / FMinraDemosaicCPU::AUTO_TILE_SIZE] ? FColor::White : FColor::Black;
+        }
     }
-    else if (!EvenRow && EvenCol)
+
+    const FString FilePath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("MinraMosaique"), BaseFilename + TEXT("_AutoSelection.png"));
+    if (SavePixelsToPNG(Map, Width, Height, FilePath))
     {
-        G = C;
-        R = (4.0f * C + 2.0f * (N + S) - 0.5f * (N2 + S2 + W2 + E2)) / 8.0f;
-        B = (4.0f * C + 2.0f * (W + E) - 0.5f * (N2 + S2 + W2 + E2)) / 8.0f;
+        UE_LOG(LogTemp, Log, TEXT("Minra Mosaique: Saved %s"), *FilePath);
     }
     else
     {
-        B = C;
-        G = (4.0f * C + 2.0f * (N + S + W + E) - (N2 + S2 + W2 + E2)) / 8.0f;
-        R = (6.0f * C + 2.0f * (NW + NE + SW + SE) - 1.5f * (N2 + S2 + W2 + E2)) / 8.0f;
+        UE_LOG(LogTemp, Warning, TEXT("Minra Mosaique: Failed to save %s"), *FilePath);
     }
-
-    return FColor(
-        FMath::Clamp(FMath::RoundToInt(R * 255.0f), 0, 255),
-        FMath::Clamp(FMath::RoundToInt(G * 255.0f), 0, 255),
-        FMath::Clamp(FMath::RoundToInt(B * 255.0f), 0, 255),
-        255);
 }
 
 bool FMinraBakeUtility::SaveTextureToPNG(UTexture2D* Texture, const FString& FilePath)
@@ -327,6 +934,15 @@ bool FMinraBakeUtility::SaveTextureToPNG(UTexture2D* Texture, const FString& Fil
     FMemory::Memcpy(Pixels.GetData(), Data, Width * Height * sizeof(FColor));
     Mip.BulkData.Unlock();
 
+    return SavePixelsToPNG(Pixels, Width, Height, FilePath);
+}
+
+bool FMinraBakeUtility::SavePixelsToPNG(
+    const TArray<FColor>& Pixels,
+    int32 Width,
+    int32 Height,
+    const FString& FilePath)
+{
     // Compress to PNG
     IImageWrapperModule& ImageWrapperModule = FModuleManager::LoadModuleChecked<IImageWrapperModule>(FName("ImageWrapper"));
     TSharedPtr<IImageWrapper> ImageWrapper = ImageWrapperModule.CreateImageWrapper(EImageFormat::PNG);
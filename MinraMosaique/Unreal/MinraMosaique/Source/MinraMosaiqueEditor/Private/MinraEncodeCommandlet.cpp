@@ -0,0 +1,275 @@
+// Copyright Minra. All Rights Reserved.
+
+#include "MinraEncodeCommandlet.h"
+#include "MSQ3Encoder.h"
+#include "MSQ3Decoder.h"
+#include "MinraDemosaicCPU.h"
+#include "MinraQualityMetrics.h"
+#include "Async/ParallelFor.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformTime.h"
+#include "IImageWrapperModule.h"
+#include "Misc/Paths.h"
+#include "Modules/ModuleManager.h"
+
+namespace MinraEncodeCommandlet
+{
+    const TCHAR* IMAGE1_SUFFIX = TEXT("_Image1");
+
+    struct FEncodeJob
+    {
+        FString ImagePaths[3];
+        FString OutputPath;
+        bool bSucceeded = false;
+        int64 OutputSize = 0;
+
+        // Round-trip quality per image, filled with -Metrics
+        bool bMeasured = false;
+        FMinraQualityReport Quality[3];
+    };
+
+    /**
+     * Decodes the written file, demosaics it and compares each image with its source.
+     */
+    bool MeasureRoundTrip(FEncodeJob& Job, EMinraDemosaicAlgorithm Algorithm)
+    {
+        TSharedPtr<FMinraMSQ3Decoder::FMQ3Data> Data = FMinraMSQ3Decoder::DecodeFromFile(Job.OutputPath);
+        TArray<FColor> Combined;
+        if (!Data.IsValid() || !FMinraMSQ3Decoder::DecodeCombinedPixels(*Data, Combined))
+        {
+            return false;
+        }
+
+        TArray<FColor> Images[3];
+        if (!FMinraDemosaicCPU::Demosaic(Combined, Data->Width, Data->Height, Algorithm, EMinraCFAPattern::RGGB, Images[0], Images[1], Images[2]))
+        {
+            return false;
+        }
+
+        for (int32 Index = 0; Index < 3; ++Index)
+        {
+            TArray<FColor> Source;
+            int32 Width = 0;
+            int32 Height = 0;
+
+            if (!FMinraMSQ3Encoder::LoadImageFile(Job.ImagePaths[Index], Source, Width, Height) ||
+                !FMinraQualityMetrics::Compute(Source, Images[Index], Width, Height, Job.Quality[Index]))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    /**
+     * Finds the sibling file for Image2/Image3, preferring the extension Image1 uses.
+     */
+    FString FindSibling(const FString& Directory, const FString& BaseName, int32 ImageIndex, const FString& PreferredExtension)
+    {
+        const FString Stem = FString::Printf(TEXT("%s_Image%d"), *BaseName, ImageIndex);
+
+        FString Preferred = FPaths::Combine(Directory, Stem + TEXT(".") + PreferredExtension);
+        if (FPaths::FileExists(Preferred))
+        {
+            return Preferred;
+        }
+
+        TArray<FString> Candidates;
+        IFileManager::Get().FindFiles(Candidates, *FPaths::Combine(Directory, Stem + TEXT(".*")), true, false);
+        return Candidates.Num() > 0 ? FPaths::Combine(Directory, Candidates[0]) : FString();
+    }
+}
+
+UMinraEncodeCommandlet::UMinraEncodeCommandlet()
+{
+    IsClient = false;
+    IsServer = false;
+    IsEditor = true;
+    LogToConsole = true;
+}
+
+int32 UMinraEncodeCommandlet::Main(const FString& Params)
+{
+    using namespace MinraEncodeCommandlet;
+
+    FString InputDir;
+    if (!FParse::Value(*Params, TEXT("Input="), InputDir))
+    {
+        UE_LOG(LogTemp, Error, TEXT("Minra Mosaique: Usage: -run=MinraEncode -Input=<Dir> [-Output=<Dir>] [-Quality=90] [-PlanePacked] [-Recursive] [-Overwrite] [-TargetPSNR=<dB> | -TargetSSIM=<0-1> | -TargetSize=<Bytes>] [-Metrics] [-Algorithm=MalvarHeCutler]"));
+        return 1;
+    }
+
+    FString OutputDir = InputDir;
+    FParse::Value(*Params, TEXT("Output="), OutputDir);
+
+    int32 Quality = 90;
+    FParse::Value(*Params, TEXT("Quality="), Quality);
+    Quality = FMath::Clamp(Quality, 0, 100);
+
+    FMinraMSQ3EncodeSettings Settings;
+    Settings.Quality = static_cast<uint8>(Quality);
+    Settings.bPlanePacked = FParse::Param(*Params, TEXT("PlanePacked"));
+
+    const bool bRecursive = FParse::Param(*Params, TEXT("Recursive"));
+    const bool bOverwrite = FParse::Param(*Params, TEXT("Overwrite"));
+
+    const bool bMetrics = FParse::Param(*Params, TEXT("Metrics"));
+    EMinraDemosaicAlgorithm MetricsAlgorithm = EMinraDemosaicAlgorithm::MalvarHeCutler;
+
+    FString AlgorithmName;
+    if (FParse::Value(*Params, TEXT("Algorithm="), AlgorithmName))
+    {
+        const int64 Value = StaticEnum<EMinraDemosaicAlgorithm>()->GetValueByNameString(AlgorithmName);
+        if (Value == INDEX_NONE || Value == static_cast<int64>(EMinraDemosaicAlgorithm::Superpixel))
+        {
+            UE_LOG(LogTemp, Error, TEXT("Minra Mosaique: -Algorithm=%s is not a full-resolution demosaic algorithm."), *AlgorithmName);
+            return 1;
+        }
+        MetricsAlgorithm = static_cast<EMinraDemosaicAlgorithm>(Value);
+    }
+
+    // Per-channel quality search; the targets are measured after the same algorithm as -Metrics
+    Settings.MetricAlgorithm = MetricsAlgorithm;
+
+    if (FParse::Value(*Params, TEXT("TargetPSNR="), Settings.TargetValue))
+    {
+        Settings.Target = EMinraMSQ3QualityTarget::PSNR;
+    }
+    else if (FParse::Value(*Params, TEXT("TargetSSIM="), Settings.TargetValue))
+    {
+        Settings.Target = EMinraMSQ3QualityTarget::SSIM;
+    }
+    else if (FParse::Value(*Params, TEXT("TargetSize="), Settings.TargetValue))
+    {
+        Settings.Target = EMinraMSQ3QualityTarget::Bytes;
+    }
+
+    InputDir = FPaths::ConvertRelativePathToFull(InputDir);
+    OutputDir = FPaths::ConvertRelativePathToFull(OutputDir);
+
+    // Gather triplets
+    TArray<FString> Image1Files;
+    const FString Pattern = FString::Printf(TEXT("*%s.*"), IMAGE1_SUFFIX);
+
+    if (bRecursive)
+    {
+        IFileManager::Get().FindFilesRecursive(Image1Files, *InputDir, *Pattern, true, false);
+    }
+    else
+    {
+        IFileManager::Get().FindFiles(Image1Files, *FPaths::Combine(InputDir, Pattern), true, false);
+        for (FString& File : Image1Files)
+        {
+            File = FPaths::Combine(InputDir, File);
+        }
+    }
+
+    TArray<FEncodeJob> Jobs;
+    int32 NumSkipped = 0;
+
+    for (const FString& Image1Path : Image1Files)
+    {
+        const FString Directory = FPaths::GetPath(Image1Path);
+        const FString Extension = FPaths::GetExtension(Image1Path);
+        const FString BaseName = FPaths::GetBaseFilename(Image1Path).LeftChop(FCString::Strlen(IMAGE1_SUFFIX));
+
+        FEncodeJob Job;
+        Job.ImagePaths[0] = Image1Path;
+        Job.ImagePaths[1] = FindSibling(Directory, BaseName, 2, Extension);
+        Job.ImagePaths[2] = FindSibling(Directory, BaseName, 3, Extension);
+
+        if (Job.ImagePaths[1].IsEmpty() || Job.ImagePaths[2].IsEmpty())
+        {
+            UE_LOG(LogTemp, Warning, TEXT("Minra Mosaique: Incomplete triplet for %s, skipping."), *Image1Path);
+            ++NumSkipped;
+            continue;
+        }
+
+        FString RelativeDir = Directory;
+        FPaths::MakePathRelativeTo(RelativeDir, *(InputDir / TEXT("")));
+        Job.OutputPath = FPaths::Combine(OutputDir, RelativeDir, BaseName + TEXT(".msq3"));
+
+        if (!bOverwrite && FPaths::FileExists(Job.OutputPath))
+        {
+            ++NumSkipped;
+            continue;
+        }
+
+        // Directory creation stays on the game thread
+        IFileManager::Get().MakeDirectory(*FPaths::GetPath(Job.OutputPath), true);
+        Jobs.Add(MoveTemp(Job));
+    }
+
+    static const TCHAR* const TargetNames[] = { TEXT("quality"), TEXT("PSNR target"), TEXT("SSIM target"), TEXT("size target") };
+    const double QualityValue = Settings.Target == EMinraMSQ3QualityTarget::Fixed ? Quality : Settings.TargetValue;
+
+    UE_LOG(LogTemp, Display, TEXT("Minra Mosaique: Encoding %d MSQ3 v%d files from %s (%s %g, %d skipped)."),
+        Jobs.Num(), Settings.bPlanePacked ? 2 : 1, *InputDir, TargetNames[static_cast<int32>(Settings.Target)], QualityValue, NumSkipped);
+
+    if (Jobs.Num() == 0)
+    {
+        return 0;
+    }
+
+    // Worker threads cannot load modules
+    FModuleManager::LoadModuleChecked<IImageWrapperModule>(FName("ImageWrapper"));
+
+    const double StartTime = FPlatformTime::Seconds();
+
+    // One task per file; each file further encodes its three channels in parallel
+    ParallelFor(Jobs.Num(), [&Jobs, &Settings, bMetrics, MetricsAlgorithm](int32 Index)
+    {
+        FEncodeJob& Job = Jobs[Index];
+        Job.bSucceeded = FMinraMSQ3Encoder::EncodeFiles(
+            Job.ImagePaths[0],
+            Job.ImagePaths[1],
+            Job.ImagePaths[2],
+            Job.OutputPath,
+            Settings);
+
+        if (Job.bSucceeded)
+        {
+            Job.OutputSize = IFileManager::Get().FileSize(*Job.OutputPath);
+            Job.bMeasured = bMetrics && MeasureRoundTrip(Job, MetricsAlgorithm);
+        }
+    });
+
+    const double ElapsedSeconds = FPlatformTime::Seconds() - StartTime;
+
+    int32 NumFailed = 0;
+    int64 TotalBytes = 0;
+
+    for (const FEncodeJob& Job : Jobs)
+    {
+        if (Job.bSucceeded)
+        {
+            UE_LOG(LogTemp, Log, TEXT("Minra Mosaique: Wrote %s (%lld bytes)"), *Job.OutputPath, Job.OutputSize);
+            TotalBytes += Job.OutputSize;
+
+            if (Job.bMeasured)
+            {
+                for (int32 Image = 0; Image < 3; ++Image)
+                {
+                    const FMinraQualityReport& Quality = Job.Quality[Image];
+                    UE_LOG(LogTemp, Display, TEXT("Minra Mosaique:   Image%d PSNR %.2f dB, SSIM %.4f, Delta E %.3f"),
+                        Image + 1, Quality.PSNR, Quality.SSIM, Quality.DeltaE);
+                }
+            }
+            else if (bMetrics)
+            {
+                UE_LOG(LogTemp, Warning, TEXT("Minra Mosaique:   Could not measure round-trip quality of %s."), *Job.OutputPath);
+            }
+        }
+        else
+        {
+            UE_LOG(LogTemp, Error, TEXT("Minra Mosaique: Failed to encode %s"), *Job.ImagePaths[0]);
+            ++NumFailed;
+        }
+    }
+
+    UE_LOG(LogTemp, Display, TEXT("Minra Mosaique: Encoded %d/%d files, %lld bytes total, in %.2f s."),
+        Jobs.Num() - NumFailed, Jobs.Num(), TotalBytes, ElapsedSeconds);
+
+    return NumFailed == 0 ? 0 : 1;
+}
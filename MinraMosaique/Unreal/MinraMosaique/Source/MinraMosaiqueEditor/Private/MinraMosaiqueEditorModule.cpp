@@ -1,8 +1,13 @@
 // Copyright Minra. All Rights Reserved.
 
 #include "MinraMosaiqueEditorModule.h"
+#include "MinraBakeUtility.h"
 #include "AssetToolsModule.h"
+#include "ContentBrowserMenuContexts.h"
+#include "Engine/Texture2D.h"
 #include "IAssetTools.h"
+#include "Misc/PackageName.h"
+#include "ToolMenus.h"
 
 #define LOCTEXT_NAMESPACE "FMinraMosaiqueEditorModule"
 
@@ -13,6 +18,8 @@ void FMinraMosaiqueEditorModule::StartupModule()
     UE_LOG(LogTemp, Log, TEXT("Minra Mosaique: Editor module loaded."));
 
     RegisterAssetTypes();
+
+    UToolMenus::RegisterStartupCallback(FSimpleMulticastDelegate::FDelegate::CreateRaw(this, &FMinraMosaiqueEditorModule::RegisterMenus));
 }
 
 void FMinraMosaiqueEditorModule::ShutdownModule()
@@ -22,6 +29,9 @@ void FMinraMosaiqueEditorModule::ShutdownModule()
     UE_LOG(LogTemp, Log, TEXT("Minra Mosaique: Editor module unloaded."));
 
     UnregisterAssetTypes();
+
+    UToolMenus::UnRegisterStartupCallback(this);
+    UToolMenus::UnregisterOwner(this);
 }
 
 void FMinraMosaiqueEditorModule::RegisterAssetTypes()
@@ -38,6 +48,72 @@ void FMinraMosaiqueEditorModule::UnregisterAssetTypes()
     // Cleanup asset type registrations
 }
 
+void FMinraMosaiqueEditorModule::RegisterMenus()
+{
+    FToolMenuOwnerScoped OwnerScoped(this);
+
+    UToolMenu* Menu = UToolMenus::Get()->ExtendMenu("ContentBrowser.AssetContextMenu.Texture2D");
+    FToolMenuSection& Section = Menu->FindOrAddSection("GetAssetActions");
+
+    Section.AddDynamicEntry("MinraCreateCombined", FNewToolMenuSectionDelegate::CreateLambda([](FToolMenuSection& InSection)
+    {
+        const UContentBrowserAssetContextMenuContext* Context = InSection.FindContext<UContentBrowserAssetContextMenuContext>();
+        if (!Context || Context->SelectedAssets.Num() != 3)
+        {
+            return;
+        }
+
+        const TArray<UTexture2D*> Textures = Context->LoadSelectedObjects<UTexture2D>();
+        if (Textures.Num() != 3)
+        {
+            return;
+        }
+
+        InSection.AddMenuEntry(
+            "MinraCreateCombined",
+            LOCTEXT("CreateCombinedLabel", "Create Combined CFA Texture"),
+            LOCTEXT("CreateCombinedTooltip", "Mosaic the three textures (in name order: Image 1, 2, 3) into one combined Bayer CFA texture."),
+            FSlateIcon(),
+            FUIAction(FExecuteAction::CreateStatic(&FMinraMosaiqueEditorModule::CreateCombinedFromSelection, Textures, false)));
+
+        InSection.AddMenuEntry(
+            "MinraCreateCombinedPrefiltered",
+            LOCTEXT("CreateCombinedPrefilteredLabel", "Create Combined CFA Texture (Anti-Aliased)"),
+            LOCTEXT("CreateCombinedPrefilteredTooltip", "Mosaic the three textures into a combined Bayer CFA texture, low-pass filtering each one first to reduce moire and false colour on fine detail."),
+            FSlateIcon(),
+            FUIAction(FExecuteAction::CreateStatic(&FMinraMosaiqueEditorModule::CreateCombinedFromSelection, Textures, true)));
+    }));
+}
+
+void FMinraMosaiqueEditorModule::CreateCombinedFromSelection(TArray<UTexture2D*> Textures, bool bPrefilter)
+{
+    Textures.Sort([](const UTexture2D& A, const UTexture2D& B)
+    {
+        return A.GetName() < B.GetName();
+    });
+
+    // Foo_Image1/2/3 -> Foo_Combined
+    FString BaseName = Textures[0]->GetName();
+    for (const UTexture2D* Texture : Textures)
+    {
+        const FString& Name = Texture->GetName();
+        int32 Length = 0;
+        while (Length < BaseName.Len() && Length < Name.Len() && BaseName[Length] == Name[Length])
+        {
+            ++Length;
+        }
+        BaseName.LeftInline(Length);
+    }
+    BaseName.RemoveFromEnd(TEXT("Image"));
+    BaseName.RemoveFromEnd(TEXT("_"));
+
+    const FString AssetName = BaseName.IsEmpty() ? FString(TEXT("Combined")) : BaseName + TEXT("_Combined");
+    const FString OutputPath = FPackageName::GetLongPackagePath(Textures[0]->GetOutermost()->GetName());
+
+    UTexture2D* const Images[3] = { Textures[0], Textures[1], Textures[2] };
+    FMinraBakeUtility::CreateCombinedTexture(Images, OutputPath, AssetName, EMinraCFAPattern::RGGB, bPrefilter);
+}
+
 #undef LOCTEXT_NAMESPACE
 
 IMPLEMENT_MODULE(FMinraMosaiqueEditorModule, MinraMosaiqueEditor)
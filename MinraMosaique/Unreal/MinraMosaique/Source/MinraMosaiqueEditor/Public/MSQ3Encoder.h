@@ -0,0 +1,179 @@
+// Copyright Minra. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MSQ3Asset.h"
+
+class UTexture2D;
+
+/**
+ * How FMinraMSQ3Encoder picks the WebP quality of each channel.
+ */
+enum class EMinraMSQ3QualityTarget : uint8
+{
+    /** Every channel at FMinraMSQ3EncodeSettings::Quality */
+    Fixed,
+
+    /** Lowest quality whose demosaiced image reaches TargetValue dB PSNR against its source */
+    PSNR,
+
+    /** Lowest quality whose demosaiced image reaches TargetValue SSIM against its source */
+    SSIM,
+
+    /** Highest quality that keeps the file within TargetValue bytes, split evenly between channels */
+    Bytes
+};
+
+/**
+ * Settings for FMinraMSQ3Encoder.
+ */
+struct FMinraMSQ3EncodeSettings
+{
+    /** WebP quality (0-100), stored in the header. Used when Target is Fixed. */
+    uint8 Quality = 90;
+
+    /**
+     * Search each channel's quality for this target instead of using Quality.
+     * The chosen qualities are recorded in the header.
+     */
+    EMinraMSQ3QualityTarget Target = EMinraMSQ3QualityTarget::Fixed;
+
+    /** PSNR in dB, SSIM in [0, 1], or file size in bytes, depending on Target */
+    double TargetValue = 0.0;
+
+    /**
+     * Algorithm the PSNR and SSIM targets are measured after (RGGB, CPU kernels).
+     * Superpixel, whose output is half size, is measured as Bilinear.
+     */
+    EMinraDemosaicAlgorithm MetricAlgorithm = EMinraDemosaicAlgorithm::Bilinear;
+
+    /**
+     * Write version 2: each CFA stored as four quarter-resolution sub-planes (R, G1, G2, B)
+     * instead of one interleaved plane. Smaller and faster to decode for colourful images,
+     * larger for grayscale ones (whose CFA has no checkerboard to begin with).
+     */
+    bool bPlanePacked = false;
+};
+
+/**
+ * MSQ3 Encoder
+ * Mosaics 3 source images into RGGB Bayer CFAs and writes them as an MSQ3 file.
+ * The output uses the same layout FMinraMSQ3Decoder reads and the browser tool writes:
+ * 14-byte header followed by R, G, B channel records, each [size:u32 LE][WebP blob].
+ * Plane-packed (version 2) files write four sub-plane records per channel instead.
+ *
+ * With a quality target, each channel's quality is found by a k-ary bisection over 0-100:
+ * every round encodes (and, for PSNR/SSIM, decodes, demosaics and measures) several
+ * qualities of all three channels in parallel.
+ */
+class MINRAMOSAIQUEEDITOR_API FMinraMSQ3Encoder
+{
+public:
+    /**
+     * Encode three images of identical size into MSQ3 bytes.
+     *
+     * @param Image1 Source for the R channel CFA
+     * @param Image2 Source for the G channel CFA
+     * @param Image3 Source for the B channel CFA
+     * @param Width Width of all three images
+     * @param Height Height of all three images
+     * @param Settings Compression settings
+     * @param OutData Receives the MSQ3 file contents
+     * @return True if encoding was successful
+     */
+    static bool EncodeImages(
+        const TArray<FColor>& Image1,
+        const TArray<FColor>& Image2,
+        const TArray<FColor>& Image3,
+        int32 Width,
+        int32 Height,
+        const FMinraMSQ3EncodeSettings& Settings,
+        TArray<uint8>& OutData);
+
+    /**
+     * Encode three source textures into MSQ3 bytes. Editor-only: reads texture source data.
+     *
+     * @return True if encoding was successful
+     */
+    static bool EncodeTextures(
+        UTexture2D* Image1,
+        UTexture2D* Image2,
+        UTexture2D* Image3,
+        const FMinraMSQ3EncodeSettings& Settings,
+        TArray<uint8>& OutData);
+
+    /**
+     * Encode three image files (any format supported by ImageWrapper) into an MSQ3 file.
+     *
+     * @return True if the output file was written
+     */
+    static bool EncodeFiles(
+        const FString& Image1Path,
+        const FString& Image2Path,
+        const FString& Image3Path,
+        const FString& OutputPath,
+        const FMinraMSQ3EncodeSettings& Settings);
+
+    /**
+     * Load an image file as BGRA8 pixels.
+     */
+    static bool LoadImageFile(
+        const FString& FilePath,
+        TArray<FColor>& OutPixels,
+        int32& OutWidth,
+        int32& OutHeight);
+
+    /**
+     * Copy one channel of a combined image (from FMinraMosaicCPU::Mosaic) into a single-channel CFA.
+     *
+     * @param Combined Combined pixels, CFA 1/2/3 in R/G/B
+     * @param Channel 0, 1 or 2 for CFA 1, 2 or 3
+     * @param OutCFA Receives one byte per pixel
+     */
+    static void ExtractCFA(
+        const TArray<FColor>& Combined,
+        int32 Channel,
+        TArray<uint8>& OutCFA);
+
+    /**
+     * Split a CFA into its four quarter-resolution sub-planes (R, G1, G2, B),
+     * each ceil(W/2) x ceil(H/2) with edge replication for odd dimensions.
+     */
+    static void SplitSubPlanes(
+        const TArray<uint8>& CFA,
+        int32 Width,
+        int32 Height,
+        TArray<uint8> OutSubPlanes[4]);
+
+private:
+    /**
+     * Find each channel's quality for Settings.Target.
+     *
+     * @param Sources The three source images, for measuring
+     * @param Planes Planes to compress, PlanesPerChannel per channel
+     * @param OutChannelQuality Receives the chosen quality of each channel
+     * @param OutRecords Receives the records compressed at those qualities
+     * @return True if every trial encode succeeded
+     */
+    static bool SearchChannelQuality(
+        const TArray<FColor>* const Sources[3],
+        const TArray<TArray<uint8>>& Planes,
+        int32 Width,
+        int32 Height,
+        const FMinraMSQ3EncodeSettings& Settings,
+        uint8 OutChannelQuality[3],
+        TArray<TArray<uint8>>& OutRecords);
+
+    /**
+     * Write header and [size][blob] records (3 for v1, 12 for v2).
+     * Channel qualities are only written when they differ.
+     */
+    static void WriteMSQ3(
+        uint8 Version,
+        int32 Width,
+        int32 Height,
+        const uint8 ChannelQuality[3],
+        const TArray<TArray<uint8>>& Records,
+        TArray<uint8>& OutData);
+};
@@ -30,6 +30,6 @@ class UMSSQ3Factory : public UFactory, public FReimportHandler
     //~ End FReimportHandler Interface
 
 private:
-    /** Creates a placeholder texture for MSQ3 files (WebP decoding not implemented) */
+    /** Creates a placeholder texture for MSQ3 files when libwebp is not available */
     static UTexture2D* CreatePlaceholderTexture(int32 Width, int32 Height);
 };
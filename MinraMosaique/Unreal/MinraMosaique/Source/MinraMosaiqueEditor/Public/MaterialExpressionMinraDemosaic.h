@@ -7,9 +7,13 @@
 #include "MSQ3Asset.h"
 #include "MaterialExpressionMinraDemosaic.generated.h"
 
+class UMaterialExpressionCustom;
+
 /**
  * Custom material expression for Minra Mosaique demosaicing.
  * Decodes a combined Bayer CFA texture into 3 separate output images.
+ * Compiles to one custom function that includes the plugin shaders (MinraDemosaic.ush)
+ * and returns all three images, so the texel neighbourhood is fetched once per pixel.
  */
 UCLASS(collapsecategories, hidecategories = Object, MinimalAPI)
 class UMaterialExpressionMinraDemosaic : public UMaterialExpression
@@ -25,9 +29,13 @@ class UMaterialExpressionMinraDemosaic : public UMaterialExpression
     FExpressionInput Coordinates;
 
     /** Demosaicing algorithm to use. */
-    UPROPERTY(EditAnywhere, Category = "Minra Mosaique", meta = (ToolTip = "Demosaicing algorithm. Bilinear is faster, MHC provides better quality."))
+    UPROPERTY(EditAnywhere, Category = "Minra Mosaique", meta = (InvalidEnumValues = "AGCRD,FrequencyAware,SmoothHue,AHD,Auto", ToolTip = "Demosaicing algorithm. Bilinear is faster, MHC provides better quality. Superpixel is cheapest and resolves one colour per 2x2 texels, for small or distant surfaces. Nearest Neighbor repeats that colour at full resolution, for previews and low-end platforms."))
     EMinraDemosaicAlgorithm Algorithm;
 
+    /** Bayer layout of the combined texture. */
+    UPROPERTY(EditAnywhere, Category = "Minra Mosaique", meta = (ToolTip = "Bayer layout of the combined texture. MSQ3 imports are always RGGB."))
+    EMinraCFAPattern CFAPattern;
+
     //~ Begin UMaterialExpression Interface
     virtual int32 Compile(class FMaterialCompiler* Compiler, int32 OutputIndex) override;
     virtual void GetCaption(TArray<FString>& OutCaptions) const override;
@@ -51,12 +59,16 @@ protected:
     /** Cached outputs array */
     TArray<FExpressionOutput> Outputs;
 
+    /** Custom expression wrapping the shared demosaic include. Built on demand, never saved. */
+    UPROPERTY(Transient)
+    UMaterialExpressionCustom* DemosaicCustom;
+
     /** Initialize outputs */
     void InitializeOutputs();
 
-    /** Generate HLSL code for bilinear demosaicing */
-    FString GenerateBilinearCode() const;
+    /** Create DemosaicCustom if needed and update its algorithm and pattern defines */
+    UMaterialExpressionCustom* GetDemosaicCustom();
 
-    /** Generate HLSL code for MHC demosaicing */
-    FString GenerateMHCCode() const;
+    /** Generate the custom function body calling the selected demosaic entry point */
+    FString GenerateDemosaicCode() const;
 };
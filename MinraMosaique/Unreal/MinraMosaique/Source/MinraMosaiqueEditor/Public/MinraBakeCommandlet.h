@@ -0,0 +1,48 @@
+// Copyright Minra. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "MinraBakeCommandlet.generated.h"
+
+/**
+ * Headless batch bake for content pipelines.
+ * Bakes every UMinraDemosaicTexture and UMSQ3Asset under a content path, with each asset's
+ * own algorithm and pattern, and assigns the outputs to it.
+ *
+ * Assets bake concurrently as tasks on the engine's work-stealing task scheduler, and the
+ * row- and tile-parallel demosaic kernels of each asset share the same workers, so idle
+ * threads pick up rows of whichever asset still has work. New assets are admitted only
+ * while the estimated peak footprint of the bakes in flight stays under -MemoryBudgetMB
+ * (default half the available physical memory; see FMinraBakeScheduler); a single asset
+ * over the budget bakes alone. Assets estimated over -LowMemoryMB (default a quarter of the
+ * budget) bake in low-memory mode. The estimated and the process's peak are reported.
+ *
+ * Finished assets are appended to a journal once their packages are on disk; -Resume skips
+ * the assets in it, so an interrupted run continues where it stopped. -Summary gets a JSON
+ * report with the time, MPix/s and bytes in/out of each asset.
+ *
+ * -Workers=N splits the assets into N shards of about equal size on disk and bakes each in
+ * its own local editor process (-AssetList=<File>) with 1/N of the cores and of the budget,
+ * so package and UObject overhead scales with the processes. The coordinator retries failed
+ * shards from their journals up to -Retries times and merges their journals and summaries.
+ *
+ * Usage:
+ *   UnrealEditor-Cmd <Project> -run=MinraBake -Path=/Game/<Dir> [-Output=/Game/<Dir>]
+ *                    [-TextureArray] [-NoMips] [-MemoryBudgetMB=<MB>]
+ *                    [-Journal=<File>] [-Resume] [-Summary=<File>]
+ *                    [-LowMemoryMB=<MB>] [-Workers=<N>] [-Retries=2]
+ */
+UCLASS()
+class UMinraBakeCommandlet : public UCommandlet
+{
+    GENERATED_BODY()
+
+public:
+    UMinraBakeCommandlet();
+
+    //~ Begin UCommandlet Interface
+    virtual int32 Main(const FString& Params) override;
+    //~ End UCommandlet Interface
+};
@@ -0,0 +1,79 @@
+// Copyright Minra. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MSQ3Asset.h"
+#include "HAL/CriticalSection.h"
+
+/**
+ * Memory admission for concurrent bakes.
+ * Estimates each bake's peak footprint from its size, algorithm and options, and admits
+ * bakes only while the estimates of those in flight fit the budget, so producers hold back
+ * new work until running bakes release theirs. Bakes whose normal footprint is too large a
+ * share of the budget run in low-memory mode (see FMinraBakeUtility::DemosaicPixels).
+ * Thread-safe.
+ */
+class MINRAMOSAIQUEEDITOR_API FMinraBakeScheduler
+{
+public:
+    /**
+     * @param InBudgetBytes Budget for the estimated footprint of all bakes in flight
+     * @param InLowMemoryBytes Bakes whose normal estimate exceeds this run in low-memory mode
+     */
+    FMinraBakeScheduler(int64 InBudgetBytes, int64 InLowMemoryBytes);
+
+    /**
+     * Estimated peak bytes of one bake of a Width x Height combined image: the combined
+     * pixels, the three images, the colour-difference planes of AGCRD, Frequency-Aware and
+     * Smooth Hue, the per-worker AHD tile buffers, the Superpixel mip 1, the mip chains and
+     * their derived-data cache copy, whichever of the bake's stages holds the most at once.
+     */
+    static int64 EstimatePeakBytes(
+        int32 Width,
+        int32 Height,
+        EMinraDemosaicAlgorithm Algorithm,
+        bool bGenerateMipmaps,
+        bool bLowMemory);
+
+    /** True if a bake of this size should run in low-memory mode */
+    bool ShouldUseLowMemory(int32 Width, int32 Height, EMinraDemosaicAlgorithm Algorithm, bool bGenerateMipmaps) const;
+
+    /**
+     * Admit a bake if its estimate fits next to those in flight and the held outputs. A bake
+     * over the whole budget is admitted only when nothing else is in flight or held.
+     *
+     * @return True if admitted; Release the same bytes when the bake finishes
+     */
+    bool TryAdmit(int64 Bytes);
+
+    /** Return the bytes of a finished bake to the budget */
+    void Release(int64 Bytes);
+
+    /** Charge the outputs of a finished bake, which stay in memory until they are written and freed */
+    void Hold(int64 Bytes);
+
+    /** Return held output bytes to the budget once they are freed */
+    void ReleaseHeld(int64 Bytes);
+
+    /** True if a bake that TryAdmit refused would fit once the held outputs are freed */
+    bool IsBlockedByHeld(int64 Bytes) const;
+
+    int64 GetBudgetBytes() const { return BudgetBytes; }
+
+    /** Estimated footprint of the bakes in flight and the held outputs */
+    int64 GetInFlightBytes() const;
+
+    /** Highest estimated footprint in flight so far */
+    int64 GetPeakBytes() const;
+
+private:
+    int64 BudgetBytes;
+    int64 LowMemoryBytes;
+
+    mutable FCriticalSection Lock;
+    int64 InFlightBytes = 0;
+    int32 NumInFlight = 0;
+    int64 HeldBytes = 0;
+    int64 PeakBytes = 0;
+};
@@ -4,10 +4,13 @@
 
 #include "CoreMinimal.h"
 #include "MinraDemosaicTexture.h"
+#include "Async/Future.h"
+
+class UTexture2DArray;
 
 /**
  * Utility class for baking demosaiced textures.
- * Processes combined CFA textures and outputs 3 separate texture files.
+ * Processes combined CFA textures and outputs 3 separate texture files, or one 3-slice texture array.
  */
 class MINRAMOSAIQUEEDITOR_API FMinraBakeUtility
 {
@@ -18,21 +21,29 @@ public:
      * @param Source The source texture asset to process
      * @param OutputPath The folder path to save the baked textures
      * @param bGenerateMipmaps Whether to generate mipmaps for output textures
+     * @param bTextureArray Bake one 3-slice texture array instead of three textures and assign it to the source
      * @return True if baking was successful
      */
     static bool BakeTextures(
         UMinraDemosaicTexture* Source,
         const FString& OutputPath,
-        bool bGenerateMipmaps = true);
+        bool bGenerateMipmaps = true,
+        bool bTextureArray = false);
 
     /**
      * Bake demosaiced textures from a raw combined texture.
+     * Each image is written and serialized as soon as its mip chain is ready, while the
+     * remaining chains build on worker threads; package files are written asynchronously.
      *
      * @param CombinedTexture The combined CFA texture
      * @param Algorithm The demosaicing algorithm to use
      * @param OutputPath The folder path to save the baked textures
      * @param BaseFilename The base filename for output textures
-     * @param bGenerateMipmaps Whether to generate mipmaps for output textures
+     * @param bGenerateMipmaps Whether to generate mipmaps for output textures. Mip 1 of a
+     *        full-resolution bake is the Superpixel demosaic of the combined texture.
+     * @param Pattern Bayer layout of the combined texture
+     * @param References Optional originals of Image1..3; when given, PSNR, SSIM and Delta E
+     *        of each output against its original are logged
      * @return True if baking was successful
      */
     static bool BakeTexturesFromCombined(
@@ -40,30 +51,239 @@ public:
         EMinraDemosaicAlgorithm Algorithm,
         const FString& OutputPath,
         const FString& BaseFilename,
-        bool bGenerateMipmaps = true);
+        bool bGenerateMipmaps = true,
+        EMinraCFAPattern Pattern = EMinraCFAPattern::RGGB,
+        UTexture2D* const References[3] = nullptr);
+
+    /**
+     * Bake demosaiced images from a raw combined texture into one texture array asset,
+     * <BaseFilename>_Images, with Image1..3 in slices 0..2: one package, one resource and one
+     * sampler binding for materials that read all three. Same data, mips and cache as
+     * BakeTexturesFromCombined.
+     *
+     * @return The saved texture array, or nullptr on failure
+     */
+    static UTexture2DArray* BakeTextureArrayFromCombined(
+        UTexture2D* CombinedTexture,
+        EMinraDemosaicAlgorithm Algorithm,
+        const FString& OutputPath,
+        const FString& BaseFilename,
+        bool bGenerateMipmaps = true,
+        EMinraCFAPattern Pattern = EMinraCFAPattern::RGGB,
+        UTexture2D* const References[3] = nullptr);
+
+    /**
+     * Mosaic three textures into a combined CFA texture asset (see FMinraMosaicCPU), set up
+     * for UMinraDemosaicTexture and the material node: uncompressed, no mips, nearest
+     * filtering, linear.
+     *
+     * @param Images Sources of CFA 1, 2 and 3, all the same size
+     * @param OutputPath The folder path to save the texture in
+     * @param AssetName Name of the texture asset
+     * @param Pattern Bayer layout to sample
+     * @param bPrefilter Low-pass each source before sampling to reduce aliasing
+     * @return The saved texture, or nullptr on failure
+     */
+    static UTexture2D* CreateCombinedTexture(
+        UTexture2D* const Images[3],
+        const FString& OutputPath,
+        const FString& AssetName,
+        EMinraCFAPattern Pattern = EMinraCFAPattern::RGGB,
+        bool bPrefilter = false);
+
+    /**
+     * Re-bake some of an MSQ3 asset's baked textures in place after its data changed.
+     * Only the changed channels are decoded (all three for Auto), and only their textures are
+     * rewritten and saved. All three are re-baked when the asset's Algorithm differs from the
+     * one its textures were baked with.
+     *
+     * @param Asset MSQ3 asset with all three baked textures
+     * @param bChanged Which of Image1..3 to re-bake
+     * @return True if re-baking was successful
+     */
+    static bool RebakeMSQ3Channels(UMSQ3Asset* Asset, const bool bChanged[3]);
+
+    /**
+     * Re-bake an MSQ3 asset's baked texture array in place after its data changed.
+     * Slices share one source buffer, so all three images are decoded and re-baked.
+     *
+     * @param Asset MSQ3 asset with a baked texture array
+     * @return True if re-baking was successful
+     */
+    static bool RebakeMSQ3Array(UMSQ3Asset* Asset);
+
+    /**
+     * Demosaiced images of one bake. Mip chains build on worker threads, one task per image,
+     * so an image can be written and saved while the others are still being filtered.
+     */
+    struct FBakeImages
+    {
+        FIntPoint Size = FIntPoint::ZeroValue;
+
+        /** Mip chain per image, mip 0 first */
+        TArray<TArray<FColor>> Mips[3];
+
+        /** Superpixel demosaic of each CFA, read by the chain builds as mip 1 */
+        TArray<FColor> Quads[3];
+
+        /** Chain builds; invalid once waited for, or when the chains came from the cache */
+        TFuture<void> MipTasks[3];
+
+        /** Derived-data cache key to store the chains under; empty when they came from the cache */
+        FString CacheKey;
+
+        /** The chains were found in the derived-data cache */
+        bool bFromCache = false;
+
+        /** Mip 0 is ready and the rest of the chains still has to be built */
+        bool bMipsPending = false;
+
+        /** Mip 1 of the chains is cropped from Quads */
+        bool bQuadMip = false;
+
+        ~FBakeImages();
+
+        /**
+         * Build the pending mip chains: as thread-pool tasks with bAsync, so the caller can
+         * consume them one by one with Wait, or else in parallel on the calling thread.
+         */
+        void BuildMipChains(bool bAsync);
+
+        /** Wait until the mip chain of one image is complete */
+        void Wait(int32 Channel);
+
+        /** Wait for all mip chains and store them in the derived-data cache if they were missing */
+        void Finish();
+    };
+
+    /** Combined rows demosaiced at once in low-memory mode */
+    static constexpr int32 LOW_MEMORY_BAND_ROWS = 256;
+
+    /**
+     * Extra rows above and below each band, past the reach of every algorithm's passes.
+     * Bands and aprons are multiples of the Auto tile size, so the Bayer phase and Auto's
+     * tile grid match the whole-image demosaic and so does the output.
+     */
+    static constexpr int32 LOW_MEMORY_APRON_ROWS = 32;
+
+    /**
+     * Demosaic combined pixels into mip 0 of Image1..3, or fetch their mip chains from the
+     * derived-data cache, then leave the chains to BuildMipChains. Logs the Auto selection of
+     * bakes that miss the cache.
+     * Safe on any thread, for batch bakes that run many at once.
+     *
+     * @param bLowMemory Demosaic in bands of LOW_MEMORY_BAND_ROWS, so algorithm temporaries
+     *        cover one band, and skip the derived-data cache store, which would copy every
+     *        chain. Same output either way.
+     */
+    static bool DemosaicPixels(
+        const TArray<FColor>& SourcePixels,
+        int32 Width,
+        int32 Height,
+        EMinraDemosaicAlgorithm Algorithm,
+        EMinraCFAPattern Pattern,
+        bool bGenerateMipmaps,
+        const FString& BaseFilename,
+        FBakeImages& OutImages,
+        bool bLowMemory = false);
+
+    /**
+     * Write demosaiced images to <OutputPath>/<BaseFilename>_Image1..3, saving each as soon
+     * as its mip chain is complete. Game thread only.
+     *
+     * @param OutTextures Receives the saved textures, nullptr for any that failed
+     * @return True if all three were saved
+     */
+    static bool SaveBakedTextures(
+        FBakeImages& Images,
+        const FString& OutputPath,
+        const FString& BaseFilename,
+        UTexture2D* (&OutTextures)[3]);
+
+    /**
+     * Write demosaiced images to the texture array <OutputPath>/<BaseFilename>_Images.
+     * Game thread only.
+     *
+     * @return The saved texture array, or nullptr on failure
+     */
+    static UTexture2DArray* SaveBakedTextureArray(
+        FBakeImages& Images,
+        const FString& OutputPath,
+        const FString& BaseFilename);
+
+    /**
+     * Save the package of an asset. Serialization happens here; the file write is
+     * asynchronous, so callers wait with UPackage::WaitForAsyncFileWrites before relying on it.
+     */
+    static bool SaveAssetPackage(UObject* Asset);
 
 private:
     /**
-     * Demosaic a single channel using bilinear interpolation.
+     * Read a combined texture and demosaic it into Image1..3, or fetch their mip chains from
+     * the derived-data cache (see DemosaicPixels), and log the quality with References.
+     * Mip chains not found in the cache are left building in OutImages.MipTasks.
      */
-    static FColor DemosaicPixelBilinear(
-        const TArray<FColor>& Pixels,
+    static bool DemosaicForBake(
+        UTexture2D* CombinedTexture,
+        EMinraDemosaicAlgorithm Algorithm,
+        const FString& BaseFilename,
+        bool bGenerateMipmaps,
+        EMinraCFAPattern Pattern,
+        UTexture2D* const References[3],
+        FBakeImages& OutImages);
+
+    /**
+     * Demosaic LOW_MEMORY_BAND_ROWS rows at a time, each with LOW_MEMORY_APRON_ROWS of
+     * context above and below, into whole-image outputs.
+     *
+     * @param OutQuads If set, also receives the Superpixel demosaic, band by band
+     */
+    static bool DemosaicInBands(
+        const TArray<FColor>& SourcePixels,
         int32 Width,
         int32 Height,
-        int32 X,
-        int32 Y,
-        int32 Channel);
+        EMinraDemosaicAlgorithm Algorithm,
+        EMinraCFAPattern Pattern,
+        TArray<FColor> (&OutImages)[3],
+        TArray<FColor> (*OutQuads)[3] = nullptr);
+
+    /** Replace a texture's platform data with uncompressed BGRA8 mips, mip 0 of size Size first */
+    static void WriteMips(UTexture2D* Texture, FIntPoint Size, const TArray<TArray<FColor>>& Mips);
+
+    /** Replace a texture array's source with uncompressed BGRA8 mips of slices 0-2, mip 0 of size Size first */
+    static void WriteArrayMips(UTexture2DArray* ImageArray, FIntPoint Size, const TArray<TArray<FColor>> (&Mips)[3]);
 
     /**
-     * Demosaic a single channel using Malvar-He-Cutler algorithm.
+     * Append mips down to 1x1 to a chain holding mip 0 of size Size.
+     * Mip 1 is cropped from QuadMip (a Superpixel result) when given; other levels are
+     * 2x2 box filtered from the previous one.
      */
-    static FColor DemosaicPixelMHC(
-        const TArray<FColor>& Pixels,
+    static void BuildMipChain(
+        TArray<TArray<FColor>>& Mips,
+        FIntPoint Size,
+        const TArray<FColor>* QuadMip);
+
+    /**
+     * Log how many tiles the Auto algorithm sent to MHC, and with
+     * r.MinraMosaique.DumpAutoSelection write its selection map as a PNG.
+     *
+     * @param Selection Auto's choice per tile, Tiles in size (see FMinraDemosaicCPU::ComputeAutoSelection)
+     */
+    static void ReportAutoSelection(
+        const TArray<uint8>& Selection,
+        FIntPoint Tiles,
         int32 Width,
         int32 Height,
-        int32 X,
-        int32 Y,
-        int32 Channel);
+        const FString& BaseFilename);
+
+    /**
+     * Log the quality of mip 0 of each demosaiced image against its reference texture.
+     */
+    static void ReportQuality(
+        const TArray<TArray<FColor>> (&Mips)[3],
+        FIntPoint Size,
+        UTexture2D* const References[3],
+        const FString& BaseFilename);
 
     /**
      * Save a texture to disk as PNG.
@@ -71,4 +291,13 @@ private:
     static bool SaveTextureToPNG(
         UTexture2D* Texture,
         const FString& FilePath);
+
+    /**
+     * Save BGRA8 pixels to disk as PNG.
+     */
+    static bool SavePixelsToPNG(
+        const TArray<FColor>& Pixels,
+        int32 Width,
+        int32 Height,
+        const FString& FilePath);
 };
@@ -0,0 +1,38 @@
+// Copyright Minra. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "MinraEncodeCommandlet.generated.h"
+
+/**
+ * Headless MSQ3 encoder for content pipelines.
+ * Converts every image triplet in a directory to MSQ3, using all worker threads.
+ *
+ * A triplet is three files named <Name>_Image1.<ext>, <Name>_Image2.<ext> and
+ * <Name>_Image3.<ext>, the same naming the bake utility uses for its outputs.
+ *
+ * -TargetPSNR, -TargetSSIM and -TargetSize replace -Quality with a per-channel quality
+ * search (see EMinraMSQ3QualityTarget). -Metrics decodes each written file and logs PSNR,
+ * SSIM and Delta E of every image against its source. Both demosaic with -Algorithm
+ * (default MalvarHeCutler).
+ *
+ * Usage:
+ *   UnrealEditor-Cmd <Project> -run=MinraEncode -Input=<Dir> [-Output=<Dir>]
+ *                    [-Quality=90] [-PlanePacked] [-Recursive] [-Overwrite]
+ *                    [-TargetPSNR=<dB> | -TargetSSIM=<0-1> | -TargetSize=<Bytes>]
+ *                    [-Metrics] [-Algorithm=MalvarHeCutler]
+ */
+UCLASS()
+class UMinraEncodeCommandlet : public UCommandlet
+{
+    GENERATED_BODY()
+
+public:
+    UMinraEncodeCommandlet();
+
+    //~ Begin UCommandlet Interface
+    virtual int32 Main(const FString& Params) override;
+    //~ End UCommandlet Interface
+};
@@ -43,4 +43,13 @@ private:
 
     /** Unregister custom asset types */
     void UnregisterAssetTypes();
+
+    /** Add the Minra actions to the content browser's texture context menu */
+    void RegisterMenus();
+
+    /**
+     * Mosaic the three selected textures, in name order, into a combined texture
+     * next to the first one.
+     */
+    static void CreateCombinedFromSelection(TArray<UTexture2D*> Textures, bool bPrefilter);
 };